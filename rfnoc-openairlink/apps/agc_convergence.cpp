@@ -0,0 +1,164 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+// Benchmarks how fast the shiftright AGC converges after a step change of the
+// input power. The FIR -> Shiftright path and the block telemetry are run
+// with the bit-exact model, one AGC step per telemetry window like in the
+// emulator apps.
+
+#include <rfnoc/openairlink/fir_shift_model.hpp>
+#include <rfnoc/openairlink/shiftright_agc.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace po = boost::program_options;
+using rfnoc::openairlink::fir_shift_model;
+using rfnoc::openairlink::shiftright_agc;
+using rfnoc::openairlink::shiftright_stats;
+
+/****************************************************************************
+ * Complex Gaussian input at the given power, quantized like the radio
+ ***************************************************************************/
+std::vector<uint32_t> make_input(std::mt19937& rng, const double power_dbfs, const size_t nsamps)
+{
+    const double sigma = 32767.0 * std::sqrt(std::pow(10.0, power_dbfs / 10.0) / 2.0);
+    std::normal_distribution<double> dist(0.0, sigma);
+    std::vector<uint32_t> samples(nsamps);
+    for (auto& sample : samples) {
+        const double i = std::min(std::max(std::round(dist(rng)), -32768.0), 32767.0);
+        const double q = std::min(std::max(std::round(dist(rng)), -32768.0), 32767.0);
+        sample = (static_cast<uint32_t>(static_cast<uint16_t>(static_cast<int16_t>(i))) << 16)
+                 | static_cast<uint16_t>(static_cast<int16_t>(q));
+    }
+    return samples;
+}
+
+/****************************************************************************
+ * Telemetry of one window at the FIR output, like rfnoc_block_shiftright.v
+ ***************************************************************************/
+shiftright_stats measure(const std::vector<uint32_t>& fir_out, const uint32_t count)
+{
+    shiftright_stats stats;
+    uint64_t sum = 0;
+    for (const uint32_t sample : fir_out) {
+        const int32_t i = static_cast<int16_t>(sample >> 16);
+        const int32_t q = static_cast<int16_t>(sample & 0xFFFF);
+        const uint32_t mag = static_cast<uint32_t>(std::max(std::abs(i), std::abs(q)));
+        sum += static_cast<uint64_t>(i * i) + static_cast<uint64_t>(q * q);
+        stats.peak = std::max(stats.peak, mag);
+        stats.clip_count += (mag >= 32767) ? 1 : 0;
+    }
+    stats.power = static_cast<uint32_t>(sum / fir_out.size());
+    stats.count = count;
+    return stats;
+}
+
+int main(int argc, char* argv[])
+{
+    double headroom_db, hysteresis_db, rate;
+    uint32_t window;
+    std::string taps;
+    std::vector<double> steps_db;
+
+    // setup the program options
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("headroom", po::value<double>(&headroom_db)->default_value(12.0), "AGC output peak target below full scale in dB")
+        ("hysteresis", po::value<double>(&hysteresis_db)->default_value(1.0), "AGC dead band on top of one shift step in dB")
+        ("window", po::value<uint32_t>(&window)->default_value(14), "Log2 of the telemetry window length")
+        ("rate", po::value<double>(&rate)->default_value(200e6), "Sample rate of the FIR in Hz, to convert windows to time")
+        ("taps", po::value<std::string>(&taps)->default_value("32767 24000 -16000 8000"), "Channel taps, space separated")
+        ("steps", po::value<std::vector<double>>(&steps_db)->multitoken()->default_value({6, 12, 20, 30, -6, -12, -20, -30}, "6 12 20 30 -6 -12 -20 -30"), "Input power steps in dB")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("AGC Convergence Benchmark %s") % desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<int16_t> coeffs;
+    std::istringstream iss(taps);
+    int tap;
+    while (iss >> tap) {
+        coeffs.push_back(static_cast<int16_t>(tap));
+    }
+
+    const size_t window_len = size_t(1) << window;
+    const size_t max_windows = 64;
+    std::mt19937 rng(1);
+
+    std::cout << boost::format("Window: %d samples (%.1f us)") % window_len
+                     % (window_len / rate * 1e6)
+              << std::endl;
+    std::cout << "Step [dB]  From [dBFS]  Updates  Windows  Time [us]  Shift  Out peak [dBFS]"
+              << std::endl;
+
+    for (const double step_db : steps_db) {
+        // Steps end (up) or start (down) at an input level that makes the
+        // FIR output clip with unscaled taps
+        const double from_dbfs = (step_db > 0) ? -6.0 - step_db : -6.0;
+
+        shiftright_agc agc(headroom_db, hysteresis_db);
+        agc.set_coefficients(coeffs);
+        fir_shift_model model(agc.get_coefficients(), 0);
+        uint32_t count = 0;
+
+        // Run one window per AGC step, the last one shows no change
+        auto converge = [&](const double power_dbfs, size_t& updates, size_t& windows,
+                            double& out_peak) {
+            updates = windows = 0;
+            for (; windows < max_windows; windows++) {
+                const std::vector<uint32_t> in = make_input(rng, power_dbfs, window_len);
+                std::vector<uint32_t> fir_out(window_len);
+                model.process(in.data(), fir_out.data(), window_len);
+                const shiftright_stats stats = measure(fir_out, ++count);
+                out_peak = std::ldexp(static_cast<double>(stats.peak), -static_cast<int>(agc.get_shiftright_value()));
+                if (!agc.update(stats)) {
+                    windows++;
+                    return;
+                }
+                updates++;
+                model.set_coefficients(agc.get_coefficients());
+            }
+        };
+
+        size_t updates, windows;
+        double out_peak;
+        converge(from_dbfs, updates, windows, out_peak);
+        converge(from_dbfs + step_db, updates, windows, out_peak);
+
+        std::cout << boost::format("%9.1f  %11.1f  %7d  %7d  %9.1f  %5d  %15.2f")
+                         % step_db % from_dbfs % updates % windows
+                         % (windows * window_len / rate * 1e6) % agc.get_shiftright_value()
+                         % (20.0 * std::log10(std::max(out_peak, 1.0) / 32767.0))
+                  << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
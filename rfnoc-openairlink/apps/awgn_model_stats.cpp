@@ -0,0 +1,104 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+// Runs the bit-exact AWGN block model with a zero input signal and reports the
+// statistics of the generated noise, so the noise level chosen for a given
+// dBFS/SNR setting can be checked without hardware.
+
+#include <rfnoc/openairlink/awgn_model.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace po = boost::program_options;
+using rfnoc::openairlink::awgn_model;
+
+int main(int argc, char* argv[])
+{
+    double noise_dbfs;
+    size_t num_samps;
+    uint32_t seed;
+
+    // setup the program options
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("noise-dbfs", po::value<double>(&noise_dbfs)->default_value(-30.0), "Complex noise power in dBFS")
+        ("nsamps", po::value<size_t>(&num_samps)->default_value(1000000), "Number of samples to generate")
+        ("seed", po::value<uint32_t>(&seed)->default_value(0), "Noise generator seed")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("AWGN Model Statistics %s") % desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    const uint32_t noise_scale = awgn_model::noise_scale_from_dbfs(noise_dbfs);
+    const double sigma_exp     = noise_scale / std::pow(2.0, awgn_model::SCALE_SHIFT - 16);
+    awgn_model model(seed, noise_scale);
+
+    // Skip the values of the pipeline fill after the seed load
+    int32_t noise_i, noise_q;
+    for (int k = 0; k < 3; k++) {
+        model.next_noise(noise_i, noise_q);
+    }
+
+    double sum = 0.0, sum_sq = 0.0, sum_4 = 0.0, sum_iq = 0.0;
+    size_t count_one_sigma = 0;
+    for (size_t n = 0; n < num_samps; n++) {
+        const uint32_t out = model.process(0);
+        const double i     = static_cast<int16_t>(out >> 16);
+        const double q     = static_cast<int16_t>(out & 0xFFFF);
+        for (const double x : {i, q}) {
+            sum += x;
+            sum_sq += x * x;
+            sum_4 += x * x * x * x;
+            count_one_sigma += (std::abs(x) <= sigma_exp) ? 1 : 0;
+        }
+        sum_iq += i * q;
+    }
+
+    const double count    = 2.0 * num_samps;
+    const double mean     = sum / count;
+    const double variance = sum_sq / count - mean * mean;
+    const double kurtosis = (sum_4 / count) / (variance * variance) - 3.0;
+    const double corr_iq  = (sum_iq / num_samps) / variance;
+
+    std::cout << boost::format("Noise scale register: %d") % noise_scale << std::endl;
+    std::cout << boost::format("Noise power:          %.3f dBFS (requested %.3f dBFS, quantized %.3f dBFS)")
+                     % (10.0 * std::log10(2.0 * variance / (32767.0 * 32767.0))) % noise_dbfs
+                     % awgn_model::dbfs_from_noise_scale(noise_scale)
+              << std::endl;
+    std::cout << boost::format("Mean:                 %.4f LSB") % mean << std::endl;
+    std::cout << boost::format("Sigma:                %.4f LSB (expected %.4f LSB)")
+                     % std::sqrt(variance) % sigma_exp
+              << std::endl;
+    std::cout << boost::format("P(|x| <= sigma):      %.4f (Gaussian 0.6827)")
+                     % (count_one_sigma / count)
+              << std::endl;
+    std::cout << boost::format("Excess kurtosis:      %.4f (CLT-12 -0.1000)") % kurtosis
+              << std::endl;
+    std::cout << boost::format("I/Q correlation:      %.4f") % corr_iq << std::endl;
+
+    return EXIT_SUCCESS;
+}
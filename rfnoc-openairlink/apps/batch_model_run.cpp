@@ -0,0 +1,517 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+// Runs one recorded sc16 waveform through a directory of channel scripts with
+// the bit-exact FIR -> Shiftright -> AWGN models, for regression runs without
+// hardware. Scripts have the "time, taps, shift[, snr]" format of oal_single,
+// the first step applies from the first sample and the other step times are
+// relative to it. Every script gives one sc16 output file of the same length.
+//
+// The work is split into (script x segment) tasks on a work-stealing thread
+// pool. The input is memory mapped and shared by all threads. A task rebuilds
+// the FIR delay line of fir_shift_model at its segment start from the input
+// before it, so the FIR and shift output is the same as a serial run of the
+// model. The noise generator is seeded per task
+// from --seed, the script and the segment, so the noise depends on the
+// segment length but not on the number of threads.
+
+#include <rfnoc/openairlink/awgn_model.hpp>
+#include <rfnoc/openairlink/channel_script.hpp>
+#include <rfnoc/openairlink/fir_shift_model.hpp>
+#include <uhd/exception.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+using rfnoc::openairlink::awgn_model;
+using rfnoc::openairlink::channel_step;
+using rfnoc::openairlink::fir_shift_model;
+
+/****************************************************************************
+ * Read-only memory map of a raw sc16 file, interleaved I/Q
+ ***************************************************************************/
+class mapped_sc16
+{
+public:
+    explicit mapped_sc16(const std::string& path)
+    {
+        _fd = ::open(path.c_str(), O_RDONLY);
+        if (_fd < 0) {
+            throw std::runtime_error("Could not open '" + path + "'");
+        }
+        struct stat st;
+        ::fstat(_fd, &st);
+        _size = static_cast<size_t>(st.st_size);
+        if (_size < 4) {
+            ::close(_fd);
+            throw std::runtime_error("No samples in '" + path + "'");
+        }
+        _data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, _fd, 0);
+        if (_data == MAP_FAILED) {
+            ::close(_fd);
+            throw std::runtime_error(
+                "Could not map '" + path + "': " + std::strerror(errno));
+        }
+    }
+
+    ~mapped_sc16()
+    {
+        ::munmap(_data, _size);
+        ::close(_fd);
+    }
+
+    const int16_t* data() const
+    {
+        return static_cast<const int16_t*>(_data);
+    }
+
+    size_t get_nsamps() const
+    {
+        return _size / 4;
+    }
+
+private:
+    int _fd;
+    size_t _size;
+    void* _data;
+};
+
+/****************************************************************************
+ * Thread pool for a fixed set of tasks, every worker owns a deque of tasks
+ * and steals from the others when its own runs empty. The tasks differ in
+ * cost (tap count, number of steps), stealing evens that out.
+ ***************************************************************************/
+class work_stealing_pool
+{
+public:
+    //! Runs task(worker, task index)
+    typedef std::function<void(const size_t, const size_t)> task_t;
+
+    explicit work_stealing_pool(const size_t num_workers)
+        : _queues(std::max<size_t>(num_workers, 1))
+        , _steals(_queues.size())
+        , _num_tasks(_queues.size())
+    {
+    }
+
+    /*! Run all tasks and wait for them, every worker starts with a
+     * contiguous range of tasks, taken in order
+     */
+    void run(const size_t num_tasks, const task_t& task)
+    {
+        const size_t num_workers = _queues.size();
+        for (size_t w = 0; w < num_workers; w++) {
+            for (size_t k = w * num_tasks / num_workers; k < (w + 1) * num_tasks / num_workers;
+                 k++) {
+                _queues[w].tasks.push_back(k);
+            }
+        }
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < num_workers; w++) {
+            threads.emplace_back([this, w, &task] { _work(w, task); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    size_t get_num_workers() const
+    {
+        return _queues.size();
+    }
+
+    size_t get_steals(const size_t worker) const
+    {
+        return _steals[worker];
+    }
+
+    size_t get_num_tasks(const size_t worker) const
+    {
+        return _num_tasks[worker];
+    }
+
+private:
+    struct queue_t
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void _work(const size_t worker, const task_t& task)
+    {
+        size_t idx;
+        while (_pop(worker, idx) || _steal(worker, idx)) {
+            task(worker, idx);
+            _num_tasks[worker]++;
+        }
+    }
+
+    //! Own tasks from the front, in order
+    bool _pop(const size_t worker, size_t& idx)
+    {
+        queue_t& queue = _queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        idx = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    //! Other tasks from the back, away from where their owner works
+    bool _steal(const size_t worker, size_t& idx)
+    {
+        for (size_t k = 1; k < _queues.size(); k++) {
+            queue_t& queue = _queues[(worker + k) % _queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                idx = queue.tasks.back();
+                queue.tasks.pop_back();
+                _steals[worker]++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<queue_t> _queues;
+    std::vector<size_t> _steals;
+    std::vector<size_t> _num_tasks;
+};
+
+/****************************************************************************
+ * Channel setting from a sample on, the steps of a script resolved to
+ * sample indices
+ ***************************************************************************/
+struct setting
+{
+    size_t start;
+    std::vector<int16_t> coeffs;
+    uint32_t shiftright;
+    uint32_t noise_scale;
+    //! Delay line length of the model from here, the most taps so far - 1
+    size_t hist;
+};
+
+/****************************************************************************
+ * One script and its output file
+ ***************************************************************************/
+struct scenario
+{
+    std::string name;
+    std::vector<setting> settings;
+    int out_fd = -1;
+};
+
+/****************************************************************************
+ * Output statistics of one task
+ ***************************************************************************/
+struct task_result
+{
+    double sum_pwr = 0.0;
+    uint32_t peak  = 0;
+    std::string error;
+};
+
+/****************************************************************************
+ * Steps to settings, steps after the end of the input are dropped. The noise
+ * starts off and is kept by steps without SNR, like on the device.
+ ***************************************************************************/
+scenario make_scenario(const std::string& name, const std::vector<channel_step>& steps,
+    const double rate, const double sig_pwr, const size_t nsamps)
+{
+    scenario scen;
+    scen.name            = name;
+    uint32_t noise_scale = 0;
+    for (const channel_step& step : steps) {
+        const double offset = std::round((step.time - steps.front().time) * rate);
+        if (offset < 0.0 || offset >= nsamps) {
+            continue;
+        }
+        if (!step.snr_db.empty()) {
+            noise_scale = awgn_model::noise_scale_from_dbfs(sig_pwr - step.snr_db[0]);
+        }
+        const size_t start = static_cast<size_t>(offset);
+        // A later step at the same sample replaces the earlier one
+        if (!scen.settings.empty() && scen.settings.back().start == start) {
+            scen.settings.pop_back();
+        }
+        scen.settings.push_back({start, step.coeffs, step.shiftright, noise_scale, 0});
+    }
+    size_t hist = 0;
+    for (setting& s : scen.settings) {
+        hist   = std::max(hist, s.coeffs.size() - 1);
+        s.hist = hist;
+    }
+    return scen;
+}
+
+/****************************************************************************
+ * Buffers of one worker, kept across its tasks
+ ***************************************************************************/
+struct worker_state
+{
+    awgn_model awgn;
+    std::vector<uint32_t> in;
+    std::vector<uint32_t> out;
+    std::vector<int16_t> out_iq;
+};
+
+/****************************************************************************
+ * Process one segment of one scenario and write it to its place in the file
+ ***************************************************************************/
+void run_segment(worker_state& state, const scenario& scen, const mapped_sc16& input,
+    const size_t seg_start, const size_t seg_len, const uint32_t seed, task_result& result)
+{
+    // Setting at the segment start
+    auto it = std::upper_bound(scen.settings.begin(), scen.settings.end(), seg_start,
+                  [](const size_t n, const setting& s) { return n < s.start; })
+              - 1;
+
+    const int16_t* iq   = input.data();
+    const size_t hist   = std::min(seg_start, it->hist);
+    const size_t first  = seg_start - hist;
+    const size_t nwords = hist + seg_len;
+    state.in.resize(nwords);
+    state.out.resize(nwords);
+    state.out_iq.resize(2 * seg_len);
+    for (size_t n = 0; n < nwords; n++) {
+        state.in[n] = (static_cast<uint32_t>(static_cast<uint16_t>(iq[2 * (first + n)])) << 16)
+                      | static_cast<uint16_t>(iq[2 * (first + n) + 1]);
+    }
+    // When a setting with more taps grows the delay line of the model, the
+    // new older part is zeros, see fir_shift_model. Do the same to the inputs
+    // before the segment.
+    size_t prev_hist = 0;
+    for (auto s = scen.settings.begin(); s <= it; s++) {
+        if (s->hist > prev_hist && s->start > prev_hist) {
+            const size_t zero_begin = std::max(first, s->start - std::min(s->start, s->hist));
+            const size_t zero_end   = s->start - prev_hist;
+            for (size_t k = zero_begin; k < zero_end; k++) {
+                state.in[k - first] = 0;
+            }
+        }
+        prev_hist = s->hist;
+    }
+
+    // A delay line as long as in the serial run, then filled with the inputs
+    fir_shift_model fir(std::vector<int16_t>(it->hist + 1, 0));
+    fir.set_coefficients(it->coeffs);
+    fir.set_shiftright_value(it->shiftright);
+    fir.process(state.in.data(), state.out.data(), hist);
+    state.awgn.set_seed(seed);
+    state.awgn.set_noise_scale(it->noise_scale);
+    // Skip the zeros of the pipeline fill after the seed load
+    int32_t noise_i, noise_q;
+    for (int k = 0; k < 3; k++) {
+        state.awgn.next_noise(noise_i, noise_q);
+    }
+
+    size_t n = 0;
+    while (n < seg_len) {
+        const auto next   = it + 1;
+        const size_t stop = (next == scen.settings.end())
+                                ? seg_len
+                                : std::min(seg_len, next->start - seg_start);
+        fir.process(&state.in[hist + n], &state.out[hist + n], stop - n);
+        for (size_t k = n; k < stop; k++) {
+            state.out[hist + k] = state.awgn.process(state.out[hist + k]);
+        }
+        n = stop;
+        if (n < seg_len) {
+            it = next;
+            fir.set_coefficients(it->coeffs);
+            fir.set_shiftright_value(it->shiftright);
+            state.awgn.set_noise_scale(it->noise_scale);
+        }
+    }
+
+    for (size_t k = 0; k < seg_len; k++) {
+        const uint32_t word   = state.out[hist + k];
+        const int16_t i       = static_cast<int16_t>(word >> 16);
+        const int16_t q       = static_cast<int16_t>(word & 0xFFFF);
+        state.out_iq[2 * k]     = i;
+        state.out_iq[2 * k + 1] = q;
+        result.sum_pwr += static_cast<double>(i) * i + static_cast<double>(q) * q;
+        result.peak = std::max<uint32_t>(result.peak, std::max(std::abs(i), std::abs(q)));
+    }
+
+    const char* bytes = reinterpret_cast<const char*>(state.out_iq.data());
+    size_t left       = 4 * seg_len;
+    off_t offset      = static_cast<off_t>(4 * seg_start);
+    while (left > 0) {
+        const ssize_t written = ::pwrite(scen.out_fd, bytes, left, offset);
+        if (written <= 0) {
+            result.error = std::strerror(errno);
+            return;
+        }
+        bytes += written;
+        offset += written;
+        left -= written;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string in_file, scenario_dir, out_dir;
+    double rate, sig_pwr;
+    size_t seg_len, num_threads;
+    uint32_t seed;
+
+    // setup the program options
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("in", po::value<std::string>(&in_file)->required(), "Input sc16 file, the captured waveform")
+        ("scenarios", po::value<std::string>(&scenario_dir)->required(), "Directory of channel scripts (*.csv)")
+        ("out", po::value<std::string>(&out_dir)->required(), "Output directory, one <script>.sc16 per script and summary.csv")
+        ("rate", po::value<double>(&rate)->default_value(61.44e6), "Sample rate of the input in Hz, maps the step times to samples")
+        ("sig-pwr", po::value<double>(&sig_pwr)->default_value(-12.0), "Signal power at the AWGN input in dBFS, reference for the SNR column")
+        ("segment", po::value<size_t>(&seg_len)->default_value(1 << 20), "Samples per task")
+        ("threads", po::value<size_t>(&num_threads)->default_value(std::thread::hardware_concurrency()), "Worker threads")
+        ("seed", po::value<uint32_t>(&seed)->default_value(0), "Noise generator seed")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("Batch Model Run %s") % desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+
+    if (seg_len == 0) {
+        std::cerr << "The segment length must be at least one sample" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const mapped_sc16 input(in_file);
+    const size_t nsamps = input.get_nsamps();
+
+    std::vector<fs::path> scripts;
+    for (const fs::directory_entry& entry : fs::directory_iterator(scenario_dir)) {
+        if (fs::is_regular_file(entry.path()) && entry.path().extension() == ".csv") {
+            scripts.push_back(entry.path());
+        }
+    }
+    std::sort(scripts.begin(), scripts.end());
+
+    fs::create_directories(out_dir);
+    std::vector<scenario> scenarios;
+    int ret = EXIT_SUCCESS;
+    for (const fs::path& script : scripts) {
+        std::vector<channel_step> steps;
+        try {
+            steps = rfnoc::openairlink::load_channel_script(script.string());
+        } catch (const uhd::value_error& ex) {
+            std::cerr << script.filename() << ": " << ex.what() << std::endl;
+            ret = EXIT_FAILURE;
+            continue;
+        }
+        if (steps.empty()) {
+            std::cerr << script.filename() << ": no steps before eos" << std::endl;
+            ret = EXIT_FAILURE;
+            continue;
+        }
+        scenarios.push_back(
+            make_scenario(script.stem().string(), steps, rate, sig_pwr, nsamps));
+        const std::string out_path = (fs::path(out_dir) / (script.stem().string() + ".sc16")).string();
+        scenarios.back().out_fd = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (scenarios.back().out_fd < 0) {
+            std::cerr << "Could not open '" << out_path << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Task k is segment k % num_segs of scenario k / num_segs
+    const size_t num_segs  = (nsamps + seg_len - 1) / seg_len;
+    const size_t num_tasks = scenarios.size() * num_segs;
+    std::vector<task_result> results(num_tasks);
+    work_stealing_pool pool(num_threads);
+    std::vector<worker_state> states(pool.get_num_workers());
+    std::cout << boost::format("%d scripts x %d segments of %d samples on %d threads")
+                     % scenarios.size() % num_segs % seg_len % pool.get_num_workers()
+              << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+    pool.run(num_tasks, [&](const size_t worker, const size_t task) {
+        const size_t scen_idx  = task / num_segs;
+        const size_t seg_idx   = task % num_segs;
+        const size_t seg_start = seg_idx * seg_len;
+        const uint32_t task_seed =
+            seed ^ static_cast<uint32_t>(0x9E3779B9u * (scen_idx + 1) + 0x85EBCA6Bu * seg_idx);
+        run_segment(states[worker], scenarios[scen_idx], input, seg_start,
+            std::min(seg_len, nsamps - seg_start), task_seed, results[task]);
+    });
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream summary((fs::path(out_dir) / "summary.csv").string());
+    summary << "script, steps, power_dbfs, peak" << std::endl;
+    for (size_t s = 0; s < scenarios.size(); s++) {
+        ::close(scenarios[s].out_fd);
+        double sum_pwr = 0.0;
+        uint32_t peak  = 0;
+        for (size_t k = s * num_segs; k < (s + 1) * num_segs; k++) {
+            if (!results[k].error.empty()) {
+                std::cerr << scenarios[s].name << ": " << results[k].error << std::endl;
+                ret = EXIT_FAILURE;
+            }
+            sum_pwr += results[k].sum_pwr;
+            peak = std::max(peak, results[k].peak);
+        }
+        summary << boost::format("%s, %d, %.3f, %d") % scenarios[s].name
+                       % scenarios[s].settings.size()
+                       % (10.0 * std::log10(sum_pwr / nsamps / (32767.0 * 32767.0)))
+                       % peak
+                << std::endl;
+    }
+
+    for (size_t w = 0; w < pool.get_num_workers(); w++) {
+        std::cout << boost::format("Thread %d: %d tasks, %d stolen") % w % pool.get_num_tasks(w)
+                         % pool.get_steals(w)
+                  << std::endl;
+    }
+    const double total = static_cast<double>(nsamps) * scenarios.size();
+    std::cout << boost::format("Processed %.1f Msamples in %.3f s, %.2f Msps")
+                     % (total / 1e6) % elapsed % (total / elapsed / 1e6)
+              << std::endl;
+
+    return ret;
+}
@@ -66,6 +66,8 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         std::cout << "ERROR: Failed to extract block controller!" << std::endl;
         return EXIT_FAILURE;
     }
+    // Read back from the device, not from the register cache
+    shiftright_block->set_verify_readback(true);
     constexpr uint32_t new_shiftright_value = 42;
     shiftright_block->set_shiftright_value(new_shiftright_value);
     const uint32_t shiftright_value_read = shiftright_block->get_shiftright_value();
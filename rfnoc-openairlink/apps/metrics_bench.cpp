@@ -0,0 +1,131 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+// Measures the update cost of the metrics that the emulator loops update on
+// every step: counter, gauge and histogram, from one thread and from several
+// threads updating the same metric, plus the cost of rendering the registry.
+
+#include <rfnoc/openairlink/metrics.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace po = boost::program_options;
+using rfnoc::openairlink::metrics_registry;
+
+/****************************************************************************
+ * Nanoseconds per call of update, run num_iters times in each of
+ * num_threads threads at once
+ ***************************************************************************/
+double ns_per_update(const std::function<void(size_t)>& update, const size_t num_iters,
+    const size_t num_threads)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&update, num_iters] {
+            for (size_t n = 0; n < num_iters; n++) {
+                update(n);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return elapsed / num_iters * 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t num_iters, num_threads, num_links;
+
+    // setup the program options
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("iters", po::value<size_t>(&num_iters)->default_value(10000000), "Updates per thread and metric")
+        ("threads", po::value<size_t>(&num_threads)->default_value(4), "Threads for the contended runs")
+        ("links", po::value<size_t>(&num_links)->default_value(2), "Links in the registry for the render time")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("Metrics Benchmark %s") % desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    metrics_registry registry;
+    for (size_t i = 0; i < num_links; i++) {
+        const std::string link = (boost::format("link=\"link%d\"") % i).str();
+        registry.add_counter("oal_channel_updates_total", "Channel updates written", link);
+        registry.add_gauge("oal_shiftright", "Shift of the link", link);
+        registry.add_histogram("oal_control_seconds", "Duration of the channel writes",
+            metrics_registry::exponential_buckets(1e-5, 2.0, 16), link);
+    }
+    auto& counter = registry.add_counter("oal_channel_updates_total", "", "link=\"link0\"");
+    auto& gauge   = registry.add_gauge("oal_shiftright", "", "link=\"link0\"");
+    auto& hist    = registry.add_histogram("oal_control_seconds", "", {}, "link=\"link0\"");
+
+    // Spread the values over the buckets
+    std::vector<double> values(1024);
+    for (size_t k = 0; k < values.size(); k++) {
+        values[k] = 1e-5 * (1 + (k * 37) % 1000);
+    }
+
+    const std::vector<std::pair<std::string, std::function<void(size_t)>>> updates = {
+        {"counter inc", [&counter](size_t) { counter.inc(); }},
+        {"gauge set", [&gauge](size_t n) { gauge.set(static_cast<double>(n & 0xFF)); }},
+        {"gauge add", [&gauge](size_t) { gauge.add(1.0); }},
+        {"histogram observe",
+            [&hist, &values](size_t n) { hist.observe(values[n & 0x3FF]); }},
+    };
+
+    std::cout << boost::format("%-18s %12s %12s") % "Update" % "1 thread"
+                     % (boost::format("%d threads") % num_threads).str()
+              << std::endl;
+    for (const auto& update : updates) {
+        const double single    = ns_per_update(update.second, num_iters, 1);
+        const double contended = ns_per_update(update.second, num_iters, num_threads);
+        std::cout << boost::format("%-18s %9.2f ns %9.2f ns") % update.first % single % contended
+                  << std::endl;
+    }
+
+    const size_t num_renders = 1000;
+    size_t size              = 0;
+    const auto start         = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < num_renders; n++) {
+        size += registry.render().size();
+    }
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << boost::format("Render: %.1f us for %d bytes") % (elapsed / num_renders * 1e6)
+                     % (size / num_renders)
+              << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+// Runs the bit-exact 2x2 MIMO datapath model on recorded sc16 samples, so a
+// tap matrix can be checked offline against testbench or device captures.
+// Sample files are raw interleaved sc16 (I first, like UHD's sc16 format).
+
+#include <rfnoc/openairlink/mimo_model.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace po = boost::program_options;
+using rfnoc::openairlink::mimo_config;
+using rfnoc::openairlink::mimo_model;
+
+static const size_t NUM_CHANS = mimo_config::NUM_CHANS;
+
+/****************************************************************************
+ * Read a raw sc16 file into {I, Q} words
+ ***************************************************************************/
+std::vector<uint32_t> read_sc16(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open '" + path + "'");
+    }
+    std::vector<uint32_t> samples;
+    int16_t iq[2];
+    while (file.read(reinterpret_cast<char*>(iq), sizeof(iq))) {
+        samples.push_back((static_cast<uint32_t>(static_cast<uint16_t>(iq[0])) << 16)
+                          | static_cast<uint16_t>(iq[1]));
+    }
+    return samples;
+}
+
+/****************************************************************************
+ * Write {I, Q} words to a raw sc16 file
+ ***************************************************************************/
+void write_sc16(const std::string& path, const std::vector<uint32_t>& samples)
+{
+    std::ofstream file(path, std::ios::binary);
+    for (const uint32_t sample : samples) {
+        const int16_t iq[2] = {static_cast<int16_t>(sample >> 16),
+            static_cast<int16_t>(sample & 0xFFFF)};
+        file.write(reinterpret_cast<const char*>(iq), sizeof(iq));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string matrix_file;
+    std::vector<std::string> in_files, out_files, ref_files;
+
+    // setup the program options
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("matrix", po::value<std::string>(&matrix_file)->required(), "Channel matrix CSV, first line is \"taps00, shift00, taps01, shift01, taps10, shift10, taps11, shift11\"")
+        ("in", po::value<std::vector<std::string>>(&in_files)->multitoken()->required(), "Two sc16 input files, TX0 and TX1")
+        ("out", po::value<std::vector<std::string>>(&out_files)->multitoken(), "Two sc16 output files, RX0 and RX1")
+        ("ref", po::value<std::vector<std::string>>(&ref_files)->multitoken(), "Two sc16 reference files to compare the outputs with")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("MIMO Model Run %s") % desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+
+    if (in_files.size() != NUM_CHANS || (!out_files.empty() && out_files.size() != NUM_CHANS)
+        || (!ref_files.empty() && ref_files.size() != NUM_CHANS)) {
+        std::cerr << "Input, output and reference files must be given for both channels" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream matrix_in(matrix_file);
+    std::string line;
+    if (!std::getline(matrix_in, line)) {
+        std::cerr << "Could not read the channel matrix from '" << matrix_file << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+    mimo_model model(mimo_config::from_csv(line));
+
+    // Both inputs are cut to the shorter one, like the joined streams of the sum block
+    std::vector<uint32_t> in[NUM_CHANS], out[NUM_CHANS];
+    size_t nsamps = SIZE_MAX;
+    for (size_t t = 0; t < NUM_CHANS; t++) {
+        in[t]  = read_sc16(in_files[t]);
+        nsamps = std::min(nsamps, in[t].size());
+    }
+    const uint32_t* in_ptrs[NUM_CHANS];
+    uint32_t* out_ptrs[NUM_CHANS];
+    for (size_t c = 0; c < NUM_CHANS; c++) {
+        out[c].resize(nsamps);
+        in_ptrs[c]  = in[c].data();
+        out_ptrs[c] = out[c].data();
+    }
+    model.process(in_ptrs, out_ptrs, nsamps);
+    std::cout << boost::format("Processed %d samples per channel") % nsamps << std::endl;
+
+    for (size_t r = 0; r < out_files.size(); r++) {
+        write_sc16(out_files[r], out[r]);
+    }
+
+    int ret = EXIT_SUCCESS;
+    for (size_t r = 0; r < ref_files.size(); r++) {
+        const std::vector<uint32_t> ref = read_sc16(ref_files[r]);
+        const size_t ncomp = std::min(ref.size(), nsamps);
+        size_t mismatches = 0, first = ncomp;
+        for (size_t n = 0; n < ncomp; n++) {
+            if (ref[n] != out[r][n]) {
+                first = std::min(first, n);
+                mismatches++;
+            }
+        }
+        std::cout << boost::format("RX%d: %d of %d samples differ") % r % mismatches % ncomp;
+        if (mismatches) {
+            std::cout << boost::format(", first at %d (model %08X, reference %08X)") % first
+                             % out[r][first] % ref[first];
+            ret = EXIT_FAILURE;
+        }
+        std::cout << std::endl;
+    }
+
+    return ret;
+}
@@ -0,0 +1,532 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of 
+    the GNU General Public License as published by the Free Software Foundation, either 
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+// Long-lived single link emulator: the RFNoC graph is created, configured and
+// streaming once, then channel scripts are taken from a queue directory and
+// swapped in without stopping the stream. A job is a script file in the
+// "time, taps, shift[, snr]" format of oal_single, its first step is applied
+// when the job starts and the other times are relative to the first step.
+
+#include <uhd/exception.hpp>
+#include <uhd/rfnoc/block_id.hpp>
+#include <uhd/rfnoc/ddc_block_control.hpp>
+#include <uhd/rfnoc/duc_block_control.hpp>
+#include <uhd/rfnoc/mb_controller.hpp>
+#include <uhd/rfnoc/radio_control.hpp>
+#include <uhd/rfnoc/fir_filter_block_control.hpp>
+#include <uhd/rfnoc_graph.hpp>
+#include <uhd/utils/graph_utils.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <rfnoc/openairlink/awgn_block_control.hpp>
+#include <rfnoc/openairlink/channel_script.hpp>
+#include <rfnoc/openairlink/multirate_taps.hpp>
+#include <rfnoc/openairlink/shiftright_block_control.hpp>
+#include <rfnoc/openairlink/stream_health.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+using uhd::rfnoc::fir_filter_block_control;
+using rfnoc::openairlink::awgn_block_control;
+using rfnoc::openairlink::channel_step;
+using rfnoc::openairlink::multirate_taps;
+using rfnoc::openairlink::shiftright_block_control;
+using rfnoc::openairlink::stream_health;
+using rfnoc::openairlink::stream_health_monitor;
+using namespace std::chrono_literals;
+using steady_clock = std::chrono::steady_clock;
+
+/****************************************************************************
+ * SIGINT handling
+ ***************************************************************************/
+static std::atomic<bool> stop_signal_called{false};
+void sig_int_handler(int)
+{
+    stop_signal_called = true;
+}
+
+/****************************************************************************
+ * Seconds between two time points
+ ***************************************************************************/
+double seconds(const steady_clock::time_point& from, const steady_clock::time_point& to)
+{
+    return std::chrono::duration<double>(to - from).count();
+}
+
+/****************************************************************************
+ * Oldest job in the queue, i.e., the first *.csv file by name, empty if none
+ *
+ * Jobs should be written under another name and renamed into the queue, so
+ * that a partially written file is never picked up.
+ ***************************************************************************/
+fs::path next_job(const fs::path& queue_dir)
+{
+    fs::path job;
+    for (const fs::directory_entry& entry : fs::directory_iterator(queue_dir)) {
+        const fs::path& path = entry.path();
+        if (fs::is_regular_file(path) && path.extension() == ".csv"
+            && (job.empty() || path.filename() < job.filename())) {
+            job = path;
+        }
+    }
+    return job;
+}
+
+/****************************************************************************
+ * Blocks of the emulated link
+ ***************************************************************************/
+struct link_ctrl
+{
+    fir_filter_block_control::sptr fir;
+    shiftright_block_control::sptr sr;
+    awgn_block_control::sptr awgn;
+    double sig_pwr;
+    //! Tag the output packets with the step ID
+    bool tag = false;
+};
+
+/****************************************************************************
+ * Write one channel step, the taps are redesigned for the FIR rate. The step
+ * ID is (job number << 16) | step index, 0 is the idle pass-through.
+ ***************************************************************************/
+void apply_step(const link_ctrl& link,
+    const multirate_taps& redesigner,
+    const channel_step& step,
+    const uint32_t step_id)
+{
+    std::vector<int16_t> fir_coeffs = step.coeffs;
+    uint32_t bit_shift              = step.shiftright;
+    if (redesigner.get_decim() > 1) {
+        redesigner.redesign(step.coeffs, step.shiftright,
+            link.fir->get_max_num_coefficients(), fir_coeffs, bit_shift);
+    }
+    link.fir->set_coefficients(fir_coeffs, 0);
+    if (link.awgn && !step.snr_db.empty()) {
+        link.awgn->set_snr(step.snr_db[0], link.sig_pwr);
+    }
+    // Shift and step ID in one burst, the ID last so packets tagged with it
+    // have the new shift
+    if (link.tag) {
+        link.sr->write_registers({shiftright_block_control::REG_SHIFTRIGHT_VALUE,
+                                     shiftright_block_control::REG_TAG_ID},
+            {bit_shift, step_id});
+    } else {
+        link.sr->set_shiftright_value(bit_shift);
+    }
+}
+
+/****************************************************************************
+ * Result of one job
+ ***************************************************************************/
+struct job_result
+{
+    size_t num_steps = 0;
+    //! From taking the job off the queue until its first step is written
+    double swap_s = 0.0;
+    //! Largest delay of a step behind its scheduled time
+    double max_late_s = 0.0;
+    //! From taking the job off the queue until it is done
+    double run_s = 0.0;
+    std::string error;
+};
+
+/****************************************************************************
+ * Stream errors during a job from the monitor totals before and after it,
+ * returns the exceeded limit, empty if none. The limits are per job.
+ ***************************************************************************/
+std::string job_health(const stream_health& before, const stream_health& after,
+    const po::variables_map& vm, std::string& counts)
+{
+    using namespace rfnoc::openairlink;
+    const std::vector<std::pair<stream_event_t, std::string>> limits = {
+        {STREAM_EVENT_OVERFLOW, "max-overflows"},
+        {STREAM_EVENT_UNDERFLOW, "max-underflows"},
+        {STREAM_EVENT_LATE_COMMAND, "max-late"}};
+    std::string error;
+    counts.clear();
+    for (const auto& limit : limits) {
+        const uint64_t count = after[limit.first].count - before[limit.first].count;
+        counts += (boost::format("%s%d %s") % (counts.empty() ? "" : ", ") % count
+                   % stream_health_monitor::event_name(limit.first))
+                      .str();
+        if (error.empty() && vm.count(limit.second)
+            && count > vm[limit.second].as<uint64_t>()) {
+            error = (boost::format("%d %s events, limit %d") % count
+                     % stream_health_monitor::event_name(limit.first)
+                     % vm[limit.second].as<uint64_t>())
+                        .str();
+        }
+    }
+    return error;
+}
+
+/****************************************************************************
+ * Run the steps of a job, the last step is held for hold_t seconds
+ ***************************************************************************/
+job_result run_job(const fs::path& job, const link_ctrl& link,
+    const multirate_taps& redesigner, const uint32_t job_id, const double hold_t)
+{
+    job_result result;
+    const steady_clock::time_point picked = steady_clock::now();
+
+    std::vector<channel_step> steps;
+    try {
+        steps = rfnoc::openairlink::load_channel_script(job.string());
+    } catch (const uhd::value_error& ex) {
+        result.error = ex.what();
+        return result;
+    }
+    if (steps.empty()) {
+        result.error = "No steps before eos";
+        return result;
+    }
+    // Taps beyond the FIR length are only folded in when redesigning
+    const size_t max_taps = link.fir->get_max_num_coefficients();
+    for (size_t i = 0; i < steps.size() && redesigner.get_decim() == 1; i++) {
+        if (steps[i].coeffs.size() > max_taps) {
+            result.error = (boost::format("Step %d has %d taps, the FIR has %d") % i
+                            % steps[i].coeffs.size() % max_taps)
+                               .str();
+            return result;
+        }
+    }
+
+    steady_clock::time_point start;
+    for (const channel_step& step : steps) {
+        if (stop_signal_called) {
+            result.error = "Interrupted";
+            break;
+        }
+        if (result.num_steps > 0) {
+            const steady_clock::time_point due =
+                start
+                + std::chrono::duration_cast<steady_clock::duration>(
+                    1000ms * (step.time - steps.front().time));
+            std::this_thread::sleep_until(due);
+            result.max_late_s = std::max(result.max_late_s, seconds(due, steady_clock::now()));
+        }
+        try {
+            apply_step(link, redesigner, step, (job_id << 16) | (result.num_steps & 0xFFFF));
+        } catch (const std::exception& ex) {
+            result.error =
+                (boost::format("Step %d: %s") % result.num_steps % ex.what()).str();
+            break;
+        }
+        if (result.num_steps++ == 0) {
+            start         = steady_clock::now();
+            result.swap_s = seconds(picked, start);
+        }
+    }
+
+    const steady_clock::time_point end =
+        steady_clock::now() + std::chrono::duration_cast<steady_clock::duration>(1000ms * hold_t);
+    while (result.error.empty() && not stop_signal_called && steady_clock::now() < end) {
+        std::this_thread::sleep_until(std::min(end, steady_clock::now() + 100ms));
+    }
+    result.run_s = seconds(picked, steady_clock::now());
+    return result;
+}
+
+/****************************************************************************
+ * main
+ ***************************************************************************/
+int UHD_SAFE_MAIN(int argc, char* argv[])
+{
+    const steady_clock::time_point process_start = steady_clock::now();
+
+    // variables to be set by po
+    std::string args, queue;
+    double rx_freq, tx_freq, rx_gain, tx_gain, rx_bw, tx_bw, sig_pwr, hold_t, poll_t;
+    size_t decim;
+
+    // constant variable
+    std::string rx_blockid = "0/Radio#1";
+    std::string tx_blockid = "0/Radio#0";
+    std::string fir_id     = "0/FIR#1";
+    std::string shift_id   = "0/Shiftright#1";
+    std::string awgn_id    = "0/AWGN#1";
+    std::string ddc_id     = "0/DDC#1";
+    std::string duc_id     = "0/DUC#1";
+
+    double setup_time = 0.1;
+    size_t rx_chan    = 0; // Channel index
+    size_t tx_chan    = 0;
+    size_t spp        = 32; // Samples per packet (reduce for lower latency)
+
+    // Pass-through channel between jobs
+    const channel_step idle_step;
+
+    std::string root = CMAKE_SOURCE_DIR;
+
+    // setup the program options
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "UHD device address args")
+        ("rx-freq", po::value<double>(&rx_freq)->default_value(3619.2e6), "Rx RF center frequency in Hz")
+        ("tx-freq", po::value<double>(&tx_freq)->default_value(3619.2e6), "Tx RF center frequency in Hz")
+        ("rx-gain", po::value<double>(&rx_gain)->default_value(0.0), "Rx RF gain in dB")
+        ("tx-gain", po::value<double>(&tx_gain)->default_value(0.0), "Tx RF gain in dB")
+        ("rx-bw", po::value<double>(&rx_bw)->default_value(80e6), "RX analog frontend filter bandwidth in Hz")
+        ("tx-bw", po::value<double>(&tx_bw)->default_value(80e6), "TX analog frontend filter bandwidth in Hz")
+        ("sig-pwr", po::value<double>(&sig_pwr)->default_value(-12.0), "Signal power at the AWGN block input in dBFS, reference for the SNR column")
+        ("decim", po::value<size_t>(&decim)->default_value(1), "Run the FIR at the radio rate divided by this factor with the DDC/DUC blocks")
+        ("queue", po::value<std::string>(&queue)->default_value(root + "/channel_control/queue"), "Job queue directory, jobs are *.csv channel scripts")
+        ("hold", po::value<double>(&hold_t)->default_value(10.0), "Time to hold the last step of a job before the next job")
+        ("poll", po::value<double>(&poll_t)->default_value(0.05), "Time period to poll the queue when it is empty")
+        ("tag", "Tag the output packets of the Shiftright block with the step ID, (job << 16) | step")
+        ("max-overflows", po::value<uint64_t>(), "Fail a job with more RX overflows than this")
+        ("max-underflows", po::value<uint64_t>(), "Fail a job with more TX underflows than this")
+        ("max-late", po::value<uint64_t>(), "Fail a job with more late timed commands than this")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("Channel Emulator Daemon %s") % desc << std::endl;
+        std::cout << std::endl
+                  << "This application keeps the emulator streaming and runs channel scripts\n"
+                  << "from a queue directory. Finished jobs are moved to done/ with a .log\n"
+                  << "file, invalid, failed or interrupted jobs to failed/.\n"
+                  << std::endl;
+        return ~0;
+    }
+
+    const fs::path queue_dir(queue);
+    for (const fs::path& dir : {queue_dir, queue_dir / "running", queue_dir / "done", queue_dir / "failed"}) {
+        fs::create_directories(dir);
+    }
+
+    /************************************************************************
+     * Create device and block controls
+     ***********************************************************************/
+    std::cout << std::endl;
+    std::cout << boost::format("Creating the RFNoC graph with args: %s...") % args
+              << std::endl;
+    uhd::rfnoc::rfnoc_graph::sptr graph = uhd::rfnoc::rfnoc_graph::make(args);
+
+    uhd::rfnoc::block_id_t rx_radio_ctrl_id(rx_blockid);
+    uhd::rfnoc::block_id_t tx_radio_ctrl_id(tx_blockid);
+    uhd::rfnoc::block_id_t fir_ctrl_id(fir_id);
+    uhd::rfnoc::block_id_t shift_ctrl_id(shift_id);
+    uhd::rfnoc::block_id_t awgn_ctrl_id(awgn_id);
+    uhd::rfnoc::block_id_t ddc_ctrl_id(ddc_id);
+    uhd::rfnoc::block_id_t duc_ctrl_id(duc_id);
+
+    uhd::rfnoc::radio_control::sptr rx_radio_ctrl =
+        graph->get_block<uhd::rfnoc::radio_control>(rx_radio_ctrl_id);
+    uhd::rfnoc::radio_control::sptr tx_radio_ctrl =
+        graph->get_block<uhd::rfnoc::radio_control>(tx_radio_ctrl_id);
+    size_t rx_mb_idx = rx_radio_ctrl_id.get_device_no();
+
+    link_ctrl link;
+    link.fir     = graph->get_block<fir_filter_block_control>(fir_ctrl_id);
+    link.sr      = graph->get_block<shiftright_block_control>(shift_ctrl_id);
+    link.sig_pwr = sig_pwr;
+    link.tag     = vm.count("tag") > 0;
+    link.sr->set_tagging_enabled(link.tag);
+    if (graph->has_block(awgn_ctrl_id)) {
+        link.awgn = graph->get_block<awgn_block_control>(awgn_ctrl_id);
+        std::cout << "Using AWGN block " << awgn_ctrl_id << std::endl;
+    } else {
+        std::cout << "No AWGN block found, SNR settings are ignored." << std::endl;
+    }
+
+    uhd::rfnoc::ddc_block_control::sptr ddc_ctrl;
+    uhd::rfnoc::duc_block_control::sptr duc_ctrl;
+    if (graph->has_block(ddc_ctrl_id) && graph->has_block(duc_ctrl_id)) {
+        ddc_ctrl = graph->get_block<uhd::rfnoc::ddc_block_control>(ddc_ctrl_id);
+        duc_ctrl = graph->get_block<uhd::rfnoc::duc_block_control>(duc_ctrl_id);
+    } else if (decim > 1) {
+        std::cout << "No DDC/DUC blocks found, the FIR can only run at the radio rate." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    /************************************************************************
+     * Set up radio, once for all jobs
+     ***********************************************************************/
+    const bool skip_pp = rx_radio_ctrl_id == tx_radio_ctrl_id;
+    uhd::rfnoc::connect_through_blocks(
+        graph, rx_radio_ctrl_id, rx_chan, fir_ctrl_id, 0, false);
+    uhd::rfnoc::connect_through_blocks(
+        graph, fir_ctrl_id, 0, shift_ctrl_id, 0, false);
+    if (link.awgn) {
+        uhd::rfnoc::connect_through_blocks(
+            graph, shift_ctrl_id, 0, awgn_ctrl_id, 0, false);
+        uhd::rfnoc::connect_through_blocks(
+            graph, awgn_ctrl_id, 0, tx_radio_ctrl_id, tx_chan, skip_pp);
+    } else {
+        uhd::rfnoc::connect_through_blocks(
+            graph, shift_ctrl_id, 0, tx_radio_ctrl_id, tx_chan, skip_pp);
+    }
+    graph->commit();
+
+    rx_radio_ctrl->enable_rx_timestamps(false, rx_chan);
+    rx_radio_ctrl->set_rx_dc_offset(true, rx_chan);
+
+    const double rate = rx_radio_ctrl->get_rate();
+    if (ddc_ctrl) {
+        ddc_ctrl->set_output_rate(rate / decim, 0);
+        duc_ctrl->set_input_rate(rate / decim, 0);
+    }
+    const multirate_taps redesigner(decim);
+
+    rx_radio_ctrl->set_rx_frequency(rx_freq, rx_chan);
+    tx_radio_ctrl->set_tx_frequency(tx_freq, tx_chan);
+    rx_radio_ctrl->set_rx_gain(rx_gain, rx_chan);
+    tx_radio_ctrl->set_tx_gain(tx_gain, tx_chan);
+    rx_radio_ctrl->set_rx_bandwidth(rx_bw, rx_chan);
+    tx_radio_ctrl->set_tx_bandwidth(tx_bw, tx_chan);
+    rx_radio_ctrl->set_property<int>("spp", spp, 0);
+
+    apply_step(link, redesigner, idle_step, 0);
+    if (link.awgn) {
+        link.awgn->set_noise_scale(0);
+    }
+
+    std::this_thread::sleep_for(1s * setup_time);
+    std::signal(SIGINT, &sig_int_handler);
+
+    // Count overflows, underflows and late commands, checked per job
+    stream_health_monitor health;
+    health.add_link("link", link.sr, tx_radio_ctrl, tx_chan);
+    health.start();
+
+    uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    stream_cmd.stream_now = false;
+    stream_cmd.time_spec =
+        graph->get_mb_controller(rx_mb_idx)->get_timekeeper(rx_mb_idx)->get_time_now()
+        + setup_time;
+    rx_radio_ctrl->issue_stream_cmd(stream_cmd, rx_chan);
+
+    // This is what every test case pays when the emulator is restarted per test
+    const double startup_s = seconds(process_start, steady_clock::now());
+    std::cout << boost::format("Sample Rate: %f Msps, FIR Rate: %f Msps")
+                     % (rate / 1e6) % (rate / decim / 1e6)
+              << std::endl;
+    std::cout << boost::format("Startup took %.3f s, the graph is kept for all jobs") % startup_s
+              << std::endl;
+    std::cout << std::endl;
+    std::cout << "**********Emulation is Now Running**********" << std::endl;
+    std::cout << "Waiting for jobs in " << queue_dir << std::endl;
+
+    /************************************************************************
+     * Run jobs from the queue
+     ***********************************************************************/
+    size_t num_jobs  = 0;
+    uint32_t job_id  = 0;
+    double saved_sum = 0.0;
+    bool idle        = true;
+    while (not stop_signal_called) {
+        const fs::path job = next_job(queue_dir);
+        if (job.empty()) {
+            if (!idle) {
+                apply_step(link, redesigner, idle_step, 0);
+                if (link.awgn) {
+                    link.awgn->set_noise_scale(0);
+                }
+                idle = true;
+            }
+            std::this_thread::sleep_for(1000ms * poll_t);
+            continue;
+        }
+
+        const fs::path running = queue_dir / "running" / job.filename();
+        fs::rename(job, running);
+        idle = false;
+        std::cout << std::endl << "Job " << job.filename() << std::endl;
+
+        job_id = (job_id % 0xFFFF) + 1;
+        if (link.tag) {
+            std::cout << boost::format("Step IDs 0x%08x + step") % (job_id << 16) << std::endl;
+        }
+        const stream_health before = health.get_total_health();
+        job_result result = run_job(running, link, redesigner, job_id, hold_t);
+        std::string stream_errors;
+        const std::string health_error =
+            job_health(before, health.get_total_health(), vm, stream_errors);
+        if (result.error.empty() && !health_error.empty()) {
+            result.error = "Stream health: " + health_error;
+        }
+        if (!result.error.empty()) {
+            // A failed job may have left a partial step, go back to pass-through
+            apply_step(link, redesigner, idle_step, 0);
+            if (link.awgn) {
+                link.awgn->set_noise_scale(0);
+            }
+            idle = true;
+        }
+        const fs::path dest_dir = queue_dir / (result.error.empty() ? "done" : "failed");
+        std::ofstream log((dest_dir / job.filename()).string() + ".log");
+        if (result.num_steps) {
+            // Restarting the process would have cost the startup instead of the swap
+            const double saved_s = startup_s - result.swap_s;
+            saved_sum += saved_s;
+            num_jobs++;
+            const std::string summary =
+                (boost::format("%d steps, swap %.3f ms, max late %.3f ms, run %.3f s, saved %.3f s compared with a restart")
+                    % result.num_steps % (result.swap_s * 1e3) % (result.max_late_s * 1e3)
+                    % result.run_s % saved_s)
+                    .str();
+            std::cout << summary << std::endl;
+            log << summary << std::endl;
+            std::cout << "Stream errors: " << stream_errors << std::endl;
+            log << "Stream errors: " << stream_errors << std::endl;
+            if (link.tag) {
+                log << boost::format("Step IDs 0x%08x + step") % (job_id << 16) << std::endl;
+            }
+        }
+        if (!result.error.empty()) {
+            std::cout << "Error: " << result.error << std::endl;
+            log << "Error: " << result.error << std::endl;
+        }
+        fs::rename(running, dest_dir / job.filename());
+    }
+
+    if (num_jobs) {
+        std::cout << std::endl
+                  << boost::format("Ran %d jobs, saved %.3f s per job compared with a restart")
+                         % num_jobs % (saved_sum / num_jobs)
+                  << std::endl;
+    }
+
+    // Stop radio
+    std::cout << std::endl;
+    stream_cmd.stream_mode = uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS;
+    std::cout << "Issuing stop stream cmd..." << std::endl;
+    rx_radio_ctrl->issue_stream_cmd(stream_cmd, rx_chan);
+    std::cout << "Done" << std::endl << std::endl;
+    // Allow for the samples and ACKs to propagate
+    std::this_thread::sleep_for(100ms);
+    health.stop();
+    std::cout << "Stream health:" << std::endl << health.get_summary();
+
+    return EXIT_SUCCESS;
+}
@@ -14,6 +14,8 @@
 **/
 
 #include <uhd/rfnoc/block_id.hpp>
+#include <uhd/rfnoc/ddc_block_control.hpp>
+#include <uhd/rfnoc/duc_block_control.hpp>
 #include <uhd/rfnoc/mb_controller.hpp>
 #include <uhd/rfnoc/radio_control.hpp>
 #include <uhd/rfnoc/fir_filter_block_control.hpp>
@@ -22,13 +24,28 @@
 #include <uhd/utils/graph_utils.hpp>
 #include <uhd/utils/math.hpp>
 #include <uhd/utils/safe_main.hpp>
+#include <rfnoc/openairlink/awgn_block_control.hpp>
+#include <rfnoc/openairlink/awgn_model.hpp>
+#include <rfnoc/openairlink/channel_trace.hpp>
+#include <rfnoc/openairlink/metrics.hpp>
+#include <rfnoc/openairlink/metrics_server.hpp>
+#include <rfnoc/openairlink/multirate_taps.hpp>
+#include <rfnoc/openairlink/shiftright_agc.hpp>
 #include <rfnoc/openairlink/shiftright_block_control.hpp>
+#include <rfnoc/openairlink/stream_health.hpp>
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <csignal>
+#include <future>
 #include <iostream>
 #include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <thread>
 #include <vector>
@@ -36,18 +53,53 @@
 namespace po = boost::program_options;
 using uhd::rfnoc::radio_control;
 using uhd::rfnoc::fir_filter_block_control;
+using rfnoc::openairlink::awgn_block_control;
+using rfnoc::openairlink::awgn_model;
+using rfnoc::openairlink::channel_trace_link;
+using rfnoc::openairlink::link_blocks;
+using rfnoc::openairlink::metric_counter;
+using rfnoc::openairlink::metric_gauge;
+using rfnoc::openairlink::metric_histogram;
+using rfnoc::openairlink::metrics_registry;
+using rfnoc::openairlink::metrics_server;
+using rfnoc::openairlink::multirate_taps;
+using rfnoc::openairlink::shiftright_agc;
 using rfnoc::openairlink::shiftright_block_control;
+using rfnoc::openairlink::state_recorder;
+using rfnoc::openairlink::stream_health_monitor;
 using namespace std::chrono_literals;
 
 /****************************************************************************
  * SIGINT handling
  ***************************************************************************/
-static bool stop_signal_called = false;
+static std::atomic<bool> stop_signal_called{false};
 void sig_int_handler(int)
 {
     stop_signal_called = true;
 }
 
+/****************************************************************************
+ * Stream health limits from the command line
+ ***************************************************************************/
+void set_stream_limits(stream_health_monitor& monitor, const po::variables_map& vm)
+{
+    if (vm.count("max-overflows")) {
+        monitor.set_limit(rfnoc::openairlink::STREAM_EVENT_OVERFLOW,
+            vm["max-overflows"].as<uint64_t>());
+    }
+    if (vm.count("max-underflows")) {
+        monitor.set_limit(rfnoc::openairlink::STREAM_EVENT_UNDERFLOW,
+            vm["max-underflows"].as<uint64_t>());
+    }
+    if (vm.count("max-late")) {
+        monitor.set_limit(rfnoc::openairlink::STREAM_EVENT_LATE_COMMAND,
+            vm["max-late"].as<uint64_t>());
+    }
+    if (vm.count("stop-on-errors")) {
+        monitor.set_trip_callback([](const std::string&) { stop_signal_called = true; });
+    }
+}
+
 /****************************************************************************
  * String to FIR Coeffs
  ***************************************************************************/
@@ -78,6 +130,534 @@ std::string space_trim(const std::string& str) {
     return out;
 }
 
+/****************************************************************************
+ * Split the optional SNR columns (in dB) from the last field of a config line
+ ***************************************************************************/
+std::vector<double> snr_parser(std::string& field)
+{
+    std::vector<double> snr_db;
+    size_t sep = field.find(',');
+    if (sep == std::string::npos) {
+        return snr_db;
+    }
+
+    std::istringstream iss(field.substr(sep + 1));
+    std::string value;
+    field = field.substr(0, sep);
+    while (std::getline(iss, value, ',')) {
+        value = space_trim(value);
+        if (!value.empty()) {
+            snr_db.push_back(std::stod(value));
+        }
+    }
+
+    return snr_db;
+}
+
+/****************************************************************************
+ * Redesign full rate taps for the FIR rate, unchanged without decimation
+ ***************************************************************************/
+void redesign_taps(const multirate_taps& redesigner, const size_t max_taps,
+    std::vector<int16_t>& fir_coeffs, uint32_t& bit_shift)
+{
+    if (redesigner.get_decim() > 1) {
+        const std::vector<int16_t> full_rate_coeffs = fir_coeffs;
+        redesigner.redesign(full_rate_coeffs, bit_shift, max_taps, fir_coeffs, bit_shift);
+    }
+}
+
+/****************************************************************************
+ * Timing of one host-synchronized update, in seconds
+ ***************************************************************************/
+struct update_timing
+{
+    size_t num_links = 0;
+    //! Spread of the instants the links finished their writes
+    double skew_s = 0.0;
+    //! From the target time (device time at commit plus the lead) until the
+    //! first link started to write
+    double late_s = 0.0;
+};
+
+/****************************************************************************
+ * Host-synchronized group: the new states of the links are staged first,
+ * then the host starts the writes of all links concurrently at one host
+ * time. The FIR and Shiftright writes are not timed commands, so the device
+ * doesn't apply them at a shared time: a link takes its new taps with the
+ * last tap write, and the links change up to the skew apart.
+ ***************************************************************************/
+class host_sync_group
+{
+public:
+    host_sync_group(uhd::rfnoc::mb_controller::timekeeper::sptr tk,
+        const std::vector<link_blocks>& links, const double lead_s)
+        : _tk(tk), _links(links), _lead_s(lead_s), _staged(links.size())
+    {
+    }
+
+    //! Stage the taps and shift of a link for the next commit
+    void stage(const size_t link_idx, const std::vector<int16_t>& coeffs, const uint32_t shift)
+    {
+        _staged[link_idx].coeffs  = coeffs;
+        _staged[link_idx].shift   = shift;
+        _staged[link_idx].channel = true;
+    }
+
+    //! Stage the noise of a link for an SNR, ignored without AWGN block
+    void stage_snr(const size_t link_idx, const double snr_db, const double sig_pwr)
+    {
+        if (_links[link_idx].awgn) {
+            _staged[link_idx].noise_scale = awgn_model::noise_scale_from_dbfs(sig_pwr - snr_db);
+            _staged[link_idx].noise       = true;
+        }
+    }
+
+    //! Write all staged states lead_s after now, then clear the stage
+    update_timing commit(state_recorder* recorder)
+    {
+        const double tick_rate = _tk->get_tick_rate();
+        const int64_t target =
+            _tk->get_ticks_now() + static_cast<int64_t>(_lead_s * tick_rate);
+        const std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(1000ms * _lead_s);
+
+        std::vector<size_t> staged_links;
+        std::vector<std::future<std::pair<int64_t, int64_t>>> writes;
+        for (size_t i = 0; i < _staged.size(); i++) {
+            if (_staged[i].channel || _staged[i].noise) {
+                staged_links.push_back(i);
+                writes.push_back(std::async(
+                    std::launch::async, &host_sync_group::_write, this, i, deadline));
+            }
+        }
+
+        update_timing timing;
+        timing.num_links = writes.size();
+        if (writes.empty()) {
+            return timing;
+        }
+        int64_t first_start = std::numeric_limits<int64_t>::max();
+        int64_t first_end   = std::numeric_limits<int64_t>::max();
+        int64_t last_end    = std::numeric_limits<int64_t>::min();
+        for (auto& write : writes) {
+            const std::pair<int64_t, int64_t> window = write.get();
+            first_start = std::min(first_start, window.first);
+            first_end   = std::min(first_end, window.second);
+            last_end    = std::max(last_end, window.second);
+        }
+        timing.skew_s = (last_end - first_end) / tick_rate;
+        timing.late_s = (first_start - target) / tick_rate;
+
+        for (const size_t i : staged_links) {
+            if (recorder && _staged[i].channel) {
+                recorder->record(i, _staged[i].coeffs, _staged[i].shift);
+            }
+            _staged[i] = staged_state();
+        }
+
+        if (timing.num_links > 1) {
+            _num_commits++;
+            _max_skew_s = std::max(_max_skew_s, timing.skew_s);
+            _sum_skew_s += timing.skew_s;
+        }
+        _max_late_s = std::max(_max_late_s, timing.late_s);
+        return timing;
+    }
+
+    void print_stats() const
+    {
+        if (_num_commits) {
+            std::cout << boost::format("Link update skew over %d updates: mean %.1f us, max %.1f us, max late %.1f us")
+                             % _num_commits % (_sum_skew_s / _num_commits * 1e6)
+                             % (_max_skew_s * 1e6) % (_max_late_s * 1e6)
+                      << std::endl;
+        }
+    }
+
+private:
+    struct staged_state
+    {
+        bool channel = false;
+        std::vector<int16_t> coeffs;
+        uint32_t shift = 0;
+        bool noise     = false;
+        uint32_t noise_scale = 0;
+    };
+
+    // Device ticks before the first and after the last write of a link
+    std::pair<int64_t, int64_t> _write(
+        const size_t link_idx, const std::chrono::steady_clock::time_point deadline)
+    {
+        const link_blocks& link    = _links[link_idx];
+        const staged_state& staged = _staged[link_idx];
+        std::this_thread::sleep_until(deadline);
+        const int64_t start = _tk->get_ticks_now();
+        if (staged.noise) {
+            link.awgn->set_noise_scale(staged.noise_scale);
+        }
+        if (staged.channel) {
+            link.fir->set_coefficients(staged.coeffs, 0);
+            link.sr->set_shiftright_value(staged.shift);
+        }
+        return {start, _tk->get_ticks_now()};
+    }
+
+    uhd::rfnoc::mb_controller::timekeeper::sptr _tk;
+    std::vector<link_blocks> _links;
+    double _lead_s;
+    std::vector<staged_state> _staged;
+    size_t _num_commits = 0;
+    double _max_skew_s  = 0.0;
+    double _sum_skew_s  = 0.0;
+    double _max_late_s  = 0.0;
+};
+
+/****************************************************************************
+ * Metrics of the control loop of one link
+ ***************************************************************************/
+struct link_metrics
+{
+    link_metrics(metrics_registry& registry, const std::string& link)
+        : updates(registry.add_counter(
+            "oal_channel_updates_total", "Channel settings written", "link=\"" + link + "\""))
+        , control_s(registry.add_histogram("oal_control_seconds",
+              "Duration of the writes of a channel setting",
+              metrics_registry::exponential_buckets(1e-5, 2.0, 16),
+              "link=\"" + link + "\""))
+        , shiftright(registry.add_gauge(
+              "oal_shiftright", "Shift of the Shiftright block", "link=\"" + link + "\""))
+        , agc_updates(registry.add_counter(
+              "oal_agc_updates_total", "AGC settings written", "link=\"" + link + "\""))
+    {
+    }
+
+    //! A channel setting was written, the writes started at start
+    void updated(const std::chrono::steady_clock::time_point& start, const uint32_t shift)
+    {
+        updates.inc();
+        control_s.observe(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        shiftright.set(shift);
+    }
+
+    metric_counter& updates;
+    metric_histogram& control_s;
+    metric_gauge& shiftright;
+    metric_counter& agc_updates;
+};
+
+/****************************************************************************
+ * AGC state of one link
+ ***************************************************************************/
+struct agc_link
+{
+    agc_link(const double headroom_db, const double hysteresis_db, const uint32_t window,
+        fir_filter_block_control::sptr fir, shiftright_block_control::sptr sr)
+        : agc(headroom_db, hysteresis_db), fir(fir), sr(sr), window(window), count(0)
+    {
+    }
+
+    shiftright_agc agc;
+    fir_filter_block_control::sptr fir;
+    shiftright_block_control::sptr sr;
+    uint32_t window;
+    uint32_t count;
+    std::vector<int16_t> channel;
+    state_recorder* recorder = nullptr;
+    size_t link_idx          = 0;
+    link_metrics* metrics    = nullptr;
+    //! A channel is staged, restart the window after the group commit
+    bool restart = false;
+};
+
+/****************************************************************************
+ * Restart the telemetry window of a link after its setting was written
+ ***************************************************************************/
+void agc_restart(agc_link& link)
+{
+    link.sr->set_stats_window(link.window);
+    link.count   = link.sr->get_stats().count;
+    link.restart = false;
+}
+
+/****************************************************************************
+ * Write the AGC setting of a link and restart its telemetry window
+ ***************************************************************************/
+void agc_apply(agc_link& link)
+{
+    link.fir->set_coefficients(link.agc.get_coefficients(), 0);
+    link.sr->set_shiftright_value(link.agc.get_shiftright_value());
+    agc_restart(link);
+    if (link.recorder) {
+        link.recorder->record(
+            link.link_idx, link.agc.get_coefficients(), link.agc.get_shiftright_value());
+    }
+    if (link.metrics) {
+        link.metrics->agc_updates.inc();
+        link.metrics->shiftright.set(link.agc.get_shiftright_value());
+    }
+}
+
+/****************************************************************************
+ * Stage a channel setting, the AGC of the link replaces the shift if enabled
+ ***************************************************************************/
+void set_channel(std::vector<agc_link>& agc_links, host_sync_group& group,
+    const size_t link_idx, const std::vector<int16_t>& fir_coeffs, const uint32_t bit_shift)
+{
+    if (agc_links.empty()) {
+        group.stage(link_idx, fir_coeffs, bit_shift);
+        return;
+    }
+
+    agc_link& link = agc_links[link_idx];
+    if (fir_coeffs != link.channel) {
+        link.channel = fir_coeffs;
+        link.agc.set_coefficients(fir_coeffs);
+        group.stage(link_idx, link.agc.get_coefficients(), link.agc.get_shiftright_value());
+        link.restart = true;
+    }
+}
+
+/****************************************************************************
+ * Write the staged settings of both links at one device time
+ ***************************************************************************/
+update_timing commit_channel(
+    std::vector<agc_link>& agc_links, host_sync_group& group, state_recorder* recorder)
+{
+    const update_timing timing = group.commit(recorder);
+    for (auto& link : agc_links) {
+        if (link.restart) {
+            agc_restart(link);
+        }
+    }
+    return timing;
+}
+
+/****************************************************************************
+ * Sleep for the update period, run the AGC meanwhile if enabled
+ ***************************************************************************/
+void agc_sleep(std::vector<agc_link>& agc_links, const double agc_t, const double period)
+{
+    const auto end = std::chrono::steady_clock::now()
+                     + std::chrono::duration_cast<std::chrono::steady_clock::duration>(1000ms * period);
+    if (agc_links.empty()) {
+        std::this_thread::sleep_until(end);
+        return;
+    }
+
+    while (not stop_signal_called && std::chrono::steady_clock::now() < end) {
+        for (auto& link : agc_links) {
+            // One AGC step per telemetry window taken with the current setting
+            const rfnoc::openairlink::shiftright_stats stats = link.sr->get_stats();
+            if (stats.count == link.count) {
+                continue;
+            }
+            if (link.agc.update(stats)) {
+                agc_apply(link);
+            } else {
+                link.count = stats.count;
+            }
+        }
+        std::this_thread::sleep_until(std::min(end,
+            std::chrono::steady_clock::now()
+                + std::chrono::duration_cast<std::chrono::steady_clock::duration>(1000ms * agc_t)));
+    }
+}
+
+/****************************************************************************
+ * Startup timing breakdown
+ ***************************************************************************/
+class startup_timer
+{
+public:
+    startup_timer() : _start(std::chrono::steady_clock::now()), _last(_start) {}
+
+    //! End the current phase, returns its duration in seconds
+    double mark(const std::string& phase)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const double phase_s = std::chrono::duration<double>(now - _last).count();
+        _phases.emplace_back(phase, phase_s);
+        _last = now;
+        return phase_s;
+    }
+
+    //! Add a line below the last phase, e.g., for the tasks run in parallel
+    void detail(const std::string& task, const double seconds)
+    {
+        _phases.emplace_back("  " + task, seconds);
+    }
+
+    void print() const
+    {
+        std::cout << "Startup timing:" << std::endl;
+        for (const auto& phase : _phases) {
+            std::cout << boost::format("  %-28s %8.3f s") % phase.first % phase.second << std::endl;
+        }
+        std::cout << boost::format("  %-28s %8.3f s") % "Total"
+                         % std::chrono::duration<double>(_last - _start).count()
+                  << std::endl;
+    }
+
+private:
+    std::chrono::steady_clock::time_point _start, _last;
+    std::vector<std::pair<std::string, double>> _phases;
+};
+
+/****************************************************************************
+ * Tune results of earlier runs: actual frequency per radio, direction and
+ * requested frequency. A tune is skipped if the LO of the radio is locked
+ * and it reports the actual frequency of an earlier tune to the same
+ * requested frequency, within TOLERANCE_HZ.
+ ***************************************************************************/
+class tune_cache
+{
+public:
+    static constexpr double TOLERANCE_HZ = 1.0;
+
+    tune_cache(const std::string& path) : _path(path)
+    {
+        std::ifstream file(path);
+        std::string key;
+        double actual;
+        while (file >> key >> actual) {
+            _entries[key] = actual;
+        }
+    }
+
+    static std::string key(const radio_control::sptr& radio, const size_t chan,
+        const bool tx, const double freq)
+    {
+        return (boost::format("%s:%d:%s:%.0f") % radio->get_unique_id() % chan
+                   % (tx ? "tx" : "rx") % freq)
+            .str();
+    }
+
+    bool find(const std::string& key, double& actual) const
+    {
+        const auto it = _entries.find(key);
+        if (it == _entries.end()) {
+            return false;
+        }
+        actual = it->second;
+        return true;
+    }
+
+    void insert(const std::string& key, const double actual)
+    {
+        _entries[key] = actual;
+    }
+
+    void save() const
+    {
+        if (_path.empty()) {
+            return;
+        }
+        std::ofstream file(_path);
+        for (const auto& entry : _entries) {
+            file << entry.first << ' ' << boost::format("%.17g") % entry.second << '\n';
+        }
+    }
+
+private:
+    std::string _path;
+    std::map<std::string, double> _entries;
+};
+
+/****************************************************************************
+ * RF frontend setting of one radio and its result
+ ***************************************************************************/
+struct frontend_config
+{
+    radio_control::sptr radio;
+    size_t chan;
+    double freq, rx_gain, tx_gain, rx_bw, tx_bw;
+    bool rx_timestamps;
+};
+
+struct frontend_result
+{
+    double rx_freq = 0.0, tx_freq = 0.0;
+    std::vector<std::pair<std::string, double>> tunes; // cache updates
+    size_t skipped_tunes = 0;
+    double seconds       = 0.0;
+};
+
+/****************************************************************************
+ * LO lock of one direction of a radio, false if it has no lo_locked sensor
+ ***************************************************************************/
+bool lo_locked(const frontend_config& fe, const bool tx)
+{
+    const std::vector<std::string> names = tx ? fe.radio->get_tx_sensor_names(fe.chan)
+                                              : fe.radio->get_rx_sensor_names(fe.chan);
+    if (std::find(names.begin(), names.end(), "lo_locked") == names.end()) {
+        return false;
+    }
+    return (tx ? fe.radio->get_tx_sensor("lo_locked", fe.chan)
+               : fe.radio->get_rx_sensor("lo_locked", fe.chan))
+        .to_bool();
+}
+
+/****************************************************************************
+ * Tune one direction of a radio unless the cache shows it is already tuned
+ ***************************************************************************/
+double tune(const frontend_config& fe, const bool tx, const tune_cache& cache,
+    frontend_result& result)
+{
+    const std::string key = tune_cache::key(fe.radio, fe.chan, tx, fe.freq);
+    double actual;
+    if (cache.find(key, actual) && lo_locked(fe, tx)) {
+        const double current = tx ? fe.radio->get_tx_frequency(fe.chan)
+                                  : fe.radio->get_rx_frequency(fe.chan);
+        if (std::abs(current - actual) <= tune_cache::TOLERANCE_HZ) {
+            result.skipped_tunes++;
+            return actual;
+        }
+    }
+    actual = tx ? fe.radio->set_tx_frequency(fe.freq, fe.chan)
+                : fe.radio->set_rx_frequency(fe.freq, fe.chan);
+    result.tunes.emplace_back(key, actual);
+    return actual;
+}
+
+/****************************************************************************
+ * Set up the RF frontend of one radio, without readbacks
+ ***************************************************************************/
+frontend_result setup_frontend(const frontend_config& fe, const tune_cache& cache)
+{
+    const auto start = std::chrono::steady_clock::now();
+    frontend_result result;
+
+    fe.radio->enable_rx_timestamps(fe.rx_timestamps, fe.chan);
+    fe.radio->set_rx_dc_offset(true, fe.chan); // Set up DC offset calibration
+    result.rx_freq = tune(fe, false, cache, result);
+    result.tx_freq = tune(fe, true, cache, result);
+    fe.radio->set_rx_gain(fe.rx_gain, fe.chan);
+    fe.radio->set_tx_gain(fe.tx_gain, fe.chan);
+    fe.radio->set_rx_bandwidth(fe.rx_bw, fe.chan);
+    fe.radio->set_tx_bandwidth(fe.tx_bw, fe.chan);
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+/****************************************************************************
+ * Write the initial channel of one link: pass-through, no noise
+ ***************************************************************************/
+double setup_link(fir_filter_block_control::sptr fir, shiftright_block_control::sptr sr,
+    awgn_block_control::sptr awgn, const std::vector<int16_t>& fir_coeffs,
+    const uint32_t bit_shift)
+{
+    const auto start = std::chrono::steady_clock::now();
+    fir->set_coefficients(fir_coeffs, 0);
+    sr->set_shiftright_value(bit_shift);
+    if (awgn) {
+        awgn->set_noise_scale(0);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
 /****************************************************************************
  * Verify The condition of CSV config file
  ***************************************************************************/
@@ -97,9 +677,14 @@ bool is_csv_valid(const std::string& path) {
  ***************************************************************************/
 int UHD_SAFE_MAIN(int argc, char* argv[])
 {
+    startup_timer timer;
+
     // variables to be set by po
-    std::string args, rx_ant, tx_ant;
-    double rfa_freq, rfb_freq, rx_gain, tx_gain, rx_bw, tx_bw, update_t, print_t, scruni_t;
+    std::string args, rx_ant, tx_ant, tune_cache_path, record_path, replay_path;
+    double rfa_freq, rfb_freq, rx_gain, tx_gain, rx_bw, tx_bw, update_t, print_t, scruni_t, sig_pwr;
+    size_t decim;
+    double agc_headroom, agc_hyst, agc_t, sync_lead;
+    uint32_t agc_window;
 
     // constant variable
     std::string rfa_blkid = "0/Radio#0";
@@ -108,6 +693,12 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     std::string shift0_id = "0/Shiftright#0";
     std::string fir1_id   = "0/FIR#1";
     std::string shift1_id = "0/Shiftright#1";
+    std::string awgn0_id  = "0/AWGN#0";
+    std::string awgn1_id  = "0/AWGN#1";
+    std::string ddc0_id   = "0/DDC#0";
+    std::string ddc1_id   = "0/DDC#1";
+    std::string duc0_id   = "0/DUC#0";
+    std::string duc1_id   = "0/DUC#1";
 
     double setup_time = 0.1;
     uint32_t bit_shift = 0;
@@ -125,6 +716,7 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     std::string root = CMAKE_SOURCE_DIR;
     std::string config_path_manually = root + "/channel_control/chan_dual.csv";
     std::string config_path_script   = root + "/channel_control/chan_dual_script.csv";
+    std::string default_tune_cache   = root + "/channel_control/.tune_cache";
     std::ifstream config_in;
 
     // setup the program options
@@ -143,6 +735,25 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         ("prt", po::value<double>(&print_t)->default_value(5), "Time period to output emulator channel")
         ("script", "Use channel script config")
         ("scr-t", po::value<double>(&scruni_t)->default_value(0.2), "Time period to output emulator channel")
+        ("sig-pwr", po::value<double>(&sig_pwr)->default_value(-12.0), "Signal power at the AWGN block input in dBFS, reference for the SNR column")
+        ("decim", po::value<size_t>(&decim)->default_value(1), "Run the FIR at the radio rate divided by this factor with the DDC/DUC blocks, taps in the config are then given at the radio rate and redesigned")
+        ("agc", "Choose the shift and scale the taps automatically from the Shiftright telemetry, the shift column of the config is ignored")
+        ("agc-headroom", po::value<double>(&agc_headroom)->default_value(6.0), "AGC output peak target below full scale in dB")
+        ("agc-hyst", po::value<double>(&agc_hyst)->default_value(1.0), "AGC dead band on top of one shift step in dB")
+        ("agc-window", po::value<uint32_t>(&agc_window)->default_value(16), "Log2 of the AGC telemetry window length in samples")
+        ("agc-t", po::value<double>(&agc_t)->default_value(0.01), "Time period to poll the AGC telemetry")
+        ("parallel-init", "Set up both radios and links concurrently")
+        ("readback", "Read back and print the frontend settings at startup")
+        ("tune-cache", po::value<std::string>(&tune_cache_path)->default_value(default_tune_cache), "File of earlier tune results, tunes already in effect with a locked LO are skipped, empty to disable")
+        ("record", po::value<std::string>(&record_path), "Record every applied channel state with device time and readback to this binary trace")
+        ("replay", po::value<std::string>(&replay_path), "Replay a channel trace with its recorded timing instead of the channel config")
+        ("max-overflows", po::value<uint64_t>(), "Flag the run as degraded after more RX overflows than this")
+        ("max-underflows", po::value<uint64_t>(), "Flag the run as degraded after more TX underflows than this")
+        ("max-late", po::value<uint64_t>(), "Flag the run as degraded after more late timed commands than this")
+        ("stop-on-errors", "Stop the run when one of the stream error limits is exceeded")
+        ("metrics-port", po::value<uint16_t>(), "Serve Prometheus metrics of the run on this port of 127.0.0.1")
+        ("metrics-socket", po::value<std::string>(), "Serve Prometheus metrics of the run on this Unix socket")
+        ("sync-lead", po::value<double>(&sync_lead)->default_value(0.002), "Time from staging a channel update of both links until the host starts writing both")
     ;
     // clang-format on
     po::variables_map vm;
@@ -159,6 +770,14 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         return ~0;
     }
 
+    // The block clips larger windows, the AGC would then wait on the wrong length
+    if (agc_window > rfnoc::openairlink::shiftright_block_control::MAX_STATS_WINDOW) {
+        std::cout << boost::format("--agc-window must be at most %d")
+                         % rfnoc::openairlink::shiftright_block_control::MAX_STATS_WINDOW
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
     /************************************************************************
      * Create device and block controls
      ***********************************************************************/
@@ -166,6 +785,7 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     std::cout << boost::format("Creating the RFNoC graph with args: %s...") % args
               << std::endl;
     uhd::rfnoc::rfnoc_graph::sptr graph = uhd::rfnoc::rfnoc_graph::make(args);
+    timer.mark("Graph creation");
 
     // Create handles for radio objects
     uhd::rfnoc::block_id_t rfa_radio_ctrl_id(rfa_blkid);
@@ -175,6 +795,12 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     uhd::rfnoc::block_id_t fir1_ctrl_id(fir1_id);
     uhd::rfnoc::block_id_t shift0_ctrl_id(shift0_id);
     uhd::rfnoc::block_id_t shift1_ctrl_id(shift1_id);
+    uhd::rfnoc::block_id_t awgn0_ctrl_id(awgn0_id);
+    uhd::rfnoc::block_id_t awgn1_ctrl_id(awgn1_id);
+    uhd::rfnoc::block_id_t ddc0_ctrl_id(ddc0_id);
+    uhd::rfnoc::block_id_t ddc1_ctrl_id(ddc1_id);
+    uhd::rfnoc::block_id_t duc0_ctrl_id(duc0_id);
+    uhd::rfnoc::block_id_t duc1_ctrl_id(duc1_id);
 
     // This next line will fail if the radio is not actually available
     uhd::rfnoc::radio_control::sptr rfa_radio_ctrl =
@@ -199,83 +825,211 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     rfnoc::openairlink::shiftright_block_control::sptr sr1_ctrl;
     sr1_ctrl = graph->get_block<rfnoc::openairlink::shiftright_block_control>(shift1_ctrl_id);
 
+    // Create AWGN blocks, optional since older FPGA images don't have them
+    rfnoc::openairlink::awgn_block_control::sptr awgn0_ctrl;
+    rfnoc::openairlink::awgn_block_control::sptr awgn1_ctrl;
+    if (graph->has_block(awgn0_ctrl_id) && graph->has_block(awgn1_ctrl_id)) {
+        awgn0_ctrl = graph->get_block<rfnoc::openairlink::awgn_block_control>(awgn0_ctrl_id);
+        awgn1_ctrl = graph->get_block<rfnoc::openairlink::awgn_block_control>(awgn1_ctrl_id);
+        std::cout << "Using AWGN blocks " << awgn0_ctrl_id << ", " << awgn1_ctrl_id << std::endl;
+    } else {
+        std::cout << "No AWGN blocks found, SNR settings are ignored." << std::endl;
+    }
+
+    // Create DDC/DUC blocks, optional since older FPGA images don't have them
+    std::vector<uhd::rfnoc::ddc_block_control::sptr> ddc_ctrls;
+    std::vector<uhd::rfnoc::duc_block_control::sptr> duc_ctrls;
+    if (graph->has_block(ddc0_ctrl_id) && graph->has_block(ddc1_ctrl_id)
+        && graph->has_block(duc0_ctrl_id) && graph->has_block(duc1_ctrl_id)) {
+        ddc_ctrls.push_back(graph->get_block<uhd::rfnoc::ddc_block_control>(ddc0_ctrl_id));
+        ddc_ctrls.push_back(graph->get_block<uhd::rfnoc::ddc_block_control>(ddc1_ctrl_id));
+        duc_ctrls.push_back(graph->get_block<uhd::rfnoc::duc_block_control>(duc0_ctrl_id));
+        duc_ctrls.push_back(graph->get_block<uhd::rfnoc::duc_block_control>(duc1_ctrl_id));
+        std::cout << "Using DDC/DUC blocks " << ddc0_ctrl_id << ", " << ddc1_ctrl_id << ", "
+                  << duc0_ctrl_id << ", " << duc1_ctrl_id << std::endl;
+    } else if (decim > 1) {
+        std::cout << "No DDC/DUC blocks found, the FIR can only run at the radio rate." << std::endl;
+        return EXIT_FAILURE;
+    }
+    timer.mark("Block controllers");
+
     /************************************************************************
      * Set up radio
      ***********************************************************************/
-    // Connect block chain from the RF A radio to the RF B radio
+    // Connect block chain from the RF A radio to the RF B radio, this also
+    // connects the DDC/DUC blocks if the image has them statically in the chain
     uhd::rfnoc::connect_through_blocks(
         graph, rfa_radio_ctrl_id, rfa_chan, fir0_ctrl_id, 0, false);
     uhd::rfnoc::connect_through_blocks(
         graph, fir0_ctrl_id, 0, shift0_ctrl_id, 0, false);
-    uhd::rfnoc::connect_through_blocks(
-        graph, shift0_ctrl_id, 0, rfb_radio_ctrl_id, rfb_chan, false);
+    if (awgn0_ctrl) {
+        uhd::rfnoc::connect_through_blocks(
+            graph, shift0_ctrl_id, 0, awgn0_ctrl_id, 0, false);
+        uhd::rfnoc::connect_through_blocks(
+            graph, awgn0_ctrl_id, 0, rfb_radio_ctrl_id, rfb_chan, false);
+    } else {
+        uhd::rfnoc::connect_through_blocks(
+            graph, shift0_ctrl_id, 0, rfb_radio_ctrl_id, rfb_chan, false);
+    }
 
     uhd::rfnoc::connect_through_blocks(
         graph, rfb_radio_ctrl_id, rfa_chan, fir1_ctrl_id, 0, false);
     uhd::rfnoc::connect_through_blocks(
         graph, fir1_ctrl_id, 0, shift1_ctrl_id, 0, false);
-    uhd::rfnoc::connect_through_blocks(
-        graph, shift1_ctrl_id, 0, rfa_radio_ctrl_id, rfb_chan, true);
+    if (awgn1_ctrl) {
+        uhd::rfnoc::connect_through_blocks(
+            graph, shift1_ctrl_id, 0, awgn1_ctrl_id, 0, false);
+        uhd::rfnoc::connect_through_blocks(
+            graph, awgn1_ctrl_id, 0, rfa_radio_ctrl_id, rfb_chan, true);
+    } else {
+        uhd::rfnoc::connect_through_blocks(
+            graph, shift1_ctrl_id, 0, rfa_radio_ctrl_id, rfb_chan, true);
+    }
     graph->commit();
-
-    rfa_radio_ctrl->enable_rx_timestamps(rx_timestamps, rfa_chan);
-    rfb_radio_ctrl->enable_rx_timestamps(rx_timestamps, rfb_chan);
-    rfa_radio_ctrl->set_rx_dc_offset(true, rfa_chan); // Set up DC offset calibration
-    rfb_radio_ctrl->set_rx_dc_offset(true, rfb_chan);
-
-    // Set up FIR Filter
-    fir0_ctrl->set_coefficients(fir_coeffs, 0);
-    fir1_ctrl->set_coefficients(fir_coeffs, 0);
-    std::cout << boost::format("Max FIR taps supported: %f") % (fir0_ctrl->get_max_num_coefficients())
-              << std::endl;
-
-    // Set up Shiftright
-    sr0_ctrl->set_shiftright_value(bit_shift);
-    sr1_ctrl->set_shiftright_value(bit_shift);
+    timer.mark("Connect and commit");
 
     // show sample rate
     double rate;
     rate = rfa_radio_ctrl->get_rate();
     std::cout << boost::format("Sample Rate: %f Msps...") % (rate / 1e6) << std::endl;
 
-    // set the center frequency
-    rfa_radio_ctrl->set_rx_frequency(rfa_freq, rfa_chan);
-    rfa_radio_ctrl->set_tx_frequency(rfa_freq, rfa_chan);
-    std::cout << boost::format("Actual RF A central Freq: %f MHz...") % (rfa_radio_ctrl->get_rx_frequency(rfa_chan) / 1e6) << std::endl;
-
-    rfb_radio_ctrl->set_tx_frequency(rfb_freq, rfb_chan);
-    rfb_radio_ctrl->set_rx_frequency(rfb_freq, rfb_chan);
-    std::cout << boost::format("Actual RF B central Freq: %f MHz...") % (rfb_radio_ctrl->get_tx_frequency(rfb_chan) / 1e6) << std::endl;
-
-    // set the rf gain
-    rfa_radio_ctrl->set_rx_gain(rx_gain, rfa_chan);
-    rfb_radio_ctrl->set_rx_gain(rx_gain, rfb_chan);
-    std::cout << boost::format("Actual RX Gain: %f dB...") % rfa_radio_ctrl->get_rx_gain(rfa_chan)
-                << std::endl;
-
-    rfb_radio_ctrl->set_tx_gain(tx_gain, rfb_chan);
-    rfa_radio_ctrl->set_tx_gain(tx_gain, rfa_chan);
-    std::cout << boost::format("Actual TX Gain: %f dB...") % rfb_radio_ctrl->get_tx_gain(rfb_chan)
-                << std::endl;
-
-    // set the IF filter bandwidth
-    rfa_radio_ctrl->set_rx_bandwidth(rx_bw, rfa_chan);
-    rfb_radio_ctrl->set_rx_bandwidth(rx_bw, rfb_chan);
-    std::cout << boost::format("Actual RX Bandwidth: %f MHz...")
-                        % (rfa_radio_ctrl->get_rx_bandwidth(rfa_chan) / 1e6)
-                << std::endl;
-
-    rfb_radio_ctrl->set_tx_bandwidth(tx_bw, rfb_chan);
-    rfa_radio_ctrl->set_tx_bandwidth(tx_bw, rfa_chan);
-    std::cout << boost::format("Actual TX Bandwidth: %f MHz...")
-                        % (rfb_radio_ctrl->get_tx_bandwidth(rfb_chan) / 1e6)
-                << std::endl;
-
-    // set the antennas
+    // set the FIR rate, the DDC/DUC pass through with a rate change of 1.
+    // Rates and spp propagate through the graph, so they are set before the
+    // radios and links are set up in parallel.
+    for (size_t i = 0; i < ddc_ctrls.size(); i++) {
+        ddc_ctrls[i]->set_output_rate(rate / decim, 0);
+        duc_ctrls[i]->set_input_rate(rate / decim, 0);
+    }
+    if (!ddc_ctrls.empty()) {
+        std::cout << boost::format("FIR Rate: %f Msps, delay span %.1f ns...")
+                         % (ddc_ctrls[0]->get_output_rate(0) / 1e6)
+                         % (fir0_ctrl->get_max_num_coefficients() * 1e9 / ddc_ctrls[0]->get_output_rate(0))
+                  << std::endl;
+    }
+    const multirate_taps redesigner(decim);
+
     rfa_radio_ctrl->set_property<int>("spp", spp, 0);
     rfb_radio_ctrl->set_property<int>("spp", spp, 0);
-    spp = rfa_radio_ctrl->get_property<int>("spp", 0);
-    std::cout << "Samples per packet: " << spp << std::endl;
+    timer.mark("Rates and spp");
+
+    // Set up the RF frontends and the links, the radios and blocks are
+    // independent of each other
+    tune_cache tunes(tune_cache_path);
+    const frontend_config rfa_fe = {
+        rfa_radio_ctrl, rfa_chan, rfa_freq, rx_gain, tx_gain, rx_bw, tx_bw, rx_timestamps};
+    const frontend_config rfb_fe = {
+        rfb_radio_ctrl, rfb_chan, rfb_freq, rx_gain, tx_gain, rx_bw, tx_bw, rx_timestamps};
+    frontend_result rfa_result, rfb_result;
+    double link0_s, link1_s;
+    if (vm.count("parallel-init")) {
+        auto rfa_task = std::async(std::launch::async, setup_frontend, std::cref(rfa_fe), std::cref(tunes));
+        auto rfb_task = std::async(std::launch::async, setup_frontend, std::cref(rfb_fe), std::cref(tunes));
+        auto link0_task = std::async(std::launch::async, setup_link, fir0_ctrl, sr0_ctrl,
+            awgn0_ctrl, std::cref(fir_coeffs), bit_shift);
+        link1_s    = setup_link(fir1_ctrl, sr1_ctrl, awgn1_ctrl, fir_coeffs, bit_shift);
+        link0_s    = link0_task.get();
+        rfa_result = rfa_task.get();
+        rfb_result = rfb_task.get();
+    } else {
+        rfa_result = setup_frontend(rfa_fe, tunes);
+        rfb_result = setup_frontend(rfb_fe, tunes);
+        link0_s    = setup_link(fir0_ctrl, sr0_ctrl, awgn0_ctrl, fir_coeffs, bit_shift);
+        link1_s    = setup_link(fir1_ctrl, sr1_ctrl, awgn1_ctrl, fir_coeffs, bit_shift);
+    }
+    timer.mark(vm.count("parallel-init") ? "Radios and links (parallel)" : "Radios and links");
+    timer.detail("RF A frontend", rfa_result.seconds);
+    timer.detail("RF B frontend", rfb_result.seconds);
+    timer.detail("Link 0 FIR/Shiftright/AWGN", link0_s);
+    timer.detail("Link 1 FIR/Shiftright/AWGN", link1_s);
+
+    for (const frontend_result* result : {&rfa_result, &rfb_result}) {
+        for (const auto& tune : result->tunes) {
+            tunes.insert(tune.first, tune.second);
+        }
+    }
+    tunes.save();
+    if (rfa_result.skipped_tunes + rfb_result.skipped_tunes) {
+        std::cout << boost::format("Skipped %d tunes already in effect")
+                         % (rfa_result.skipped_tunes + rfb_result.skipped_tunes)
+                  << std::endl;
+    }
+
+    std::cout << boost::format("Actual RF A central Freq: %f MHz...") % (rfa_result.rx_freq / 1e6) << std::endl;
+    std::cout << boost::format("Actual RF B central Freq: %f MHz...") % (rfb_result.tx_freq / 1e6) << std::endl;
+    if (vm.count("readback")) {
+        std::cout << boost::format("Actual RX Gain: %f dB...") % rfa_radio_ctrl->get_rx_gain(rfa_chan)
+                  << std::endl;
+        std::cout << boost::format("Actual TX Gain: %f dB...") % rfb_radio_ctrl->get_tx_gain(rfb_chan)
+                  << std::endl;
+        std::cout << boost::format("Actual RX Bandwidth: %f MHz...")
+                         % (rfa_radio_ctrl->get_rx_bandwidth(rfa_chan) / 1e6)
+                  << std::endl;
+        std::cout << boost::format("Actual TX Bandwidth: %f MHz...")
+                         % (rfb_radio_ctrl->get_tx_bandwidth(rfb_chan) / 1e6)
+                  << std::endl;
+        std::cout << "Samples per packet: " << rfa_radio_ctrl->get_property<int>("spp", 0)
+                  << std::endl;
+        std::cout << boost::format("Max FIR taps supported: %d") % (fir0_ctrl->get_max_num_coefficients())
+                  << std::endl;
+        timer.mark("Readback");
+    }
+
+    // Set up the channel trace
+    const std::vector<link_blocks> links = {
+        {fir0_ctrl, sr0_ctrl, awgn0_ctrl}, {fir1_ctrl, sr1_ctrl, awgn1_ctrl}};
+    const std::vector<channel_trace_link> link_ids = {{fir0_id, shift0_id}, {fir1_id, shift1_id}};
+    uhd::rfnoc::mb_controller::timekeeper::sptr timekeeper =
+        graph->get_mb_controller(rfa_mb_idx)->get_timekeeper(rfa_mb_idx);
+    host_sync_group group(timekeeper, links, sync_lead);
+    std::unique_ptr<state_recorder> recorder;
+    if (vm.count("record")) {
+        recorder.reset(new state_recorder(record_path, timekeeper, link_ids, links));
+        recorder->record(0, fir_coeffs, bit_shift);
+        recorder->record(1, fir_coeffs, bit_shift);
+        std::cout << "Recording the channel states to " << record_path << std::endl;
+    }
+
+    // Set up the metrics, the updates are cheap enough to keep them always on
+    metrics_registry metrics;
+    link_metrics link0_metrics(metrics, "link0");
+    link_metrics link1_metrics(metrics, "link1");
+    metric_histogram& step_late_s = metrics.add_histogram("oal_step_late_seconds",
+        "Delay of a script step behind its scheduled time",
+        metrics_registry::exponential_buckets(1e-3, 2.0, 12));
+    metric_histogram& update_skew_s = metrics.add_histogram("oal_update_skew_seconds",
+        "Spread of the write times of the links in a host-synchronized update",
+        metrics_registry::exponential_buckets(1e-6, 2.0, 16));
+    metric_histogram& update_late_s = metrics.add_histogram("oal_update_late_seconds",
+        "Delay of the first write of a host-synchronized update behind its target time",
+        metrics_registry::exponential_buckets(1e-6, 2.0, 16));
+    metric_counter& config_reloads =
+        metrics.add_counter("oal_config_reloads_total", "Reads of the manual channel config");
+    metric_counter& config_changes = metrics.add_counter(
+        "oal_config_changes_total", "Reads of the manual channel config with a new setting");
+    metric_counter& config_errors = metrics.add_counter(
+        "oal_config_errors_total", "Failed reads of the manual channel config");
+    std::unique_ptr<metrics_server> server;
+    if (vm.count("metrics-port")) {
+        server.reset(new metrics_server(metrics, vm["metrics-port"].as<uint16_t>()));
+    } else if (vm.count("metrics-socket")) {
+        server.reset(new metrics_server(metrics, vm["metrics-socket"].as<std::string>()));
+    }
+    if (server) {
+        std::cout << "Serving metrics at " << server->get_endpoint() << std::endl;
+    }
+
+    // Set up AGC, the replay has the AGC states in the trace
+    std::vector<agc_link> agc_links;
+    if (vm.count("agc") && !vm.count("replay")) {
+        agc_links.emplace_back(agc_headroom, agc_hyst, agc_window, fir0_ctrl, sr0_ctrl);
+        agc_links.emplace_back(agc_headroom, agc_hyst, agc_window, fir1_ctrl, sr1_ctrl);
+        for (size_t i = 0; i < agc_links.size(); i++) {
+            agc_links[i].recorder = recorder.get();
+            agc_links[i].link_idx = i;
+            agc_links[i].metrics  = (i == 0) ? &link0_metrics : &link1_metrics;
+        }
+        std::cout << "Using AGC, the shift column of the config is ignored." << std::endl;
+    }
 
     // Allow for some setup time
     std::this_thread::sleep_for(1s * setup_time);
@@ -283,6 +1037,14 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     // Arm SIGINT handler
     std::signal(SIGINT, &sig_int_handler);
 
+    // Watch the radios for overflows, underflows and late commands
+    stream_health_monitor health;
+    health.add_link("link0", sr0_ctrl, rfb_radio_ctrl, rfb_chan);
+    health.add_link("link1", sr1_ctrl, rfa_radio_ctrl, rfb_chan);
+    set_stream_limits(health, vm);
+    health.set_metrics(metrics);
+    health.start();
+
     // Start streaming 
     uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
     stream_cmd.stream_now = false;
@@ -292,17 +1054,26 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     std::cout << "Issuing start stream cmd..." << std::endl;
     rfa_radio_ctrl->issue_stream_cmd(stream_cmd, rfa_chan);
     rfb_radio_ctrl->issue_stream_cmd(stream_cmd, rfb_chan);
-     
+    timer.mark("Setup wait and stream start");
+    timer.print();
+
     std::cout << std::endl;
     std::cout << "**********Emulation is Now Running**********" << std::endl;
 
     // Keep running and update channel
     std::string fir;
     std::string bit;
+    std::string last_config;
+    std::vector<double> snr_db;
     std::vector<int16_t> used_coeffs;
+    std::vector<int16_t> fir0_coeffs; // Link 0 setting until both links are parsed
+    uint32_t bit0_shift;
 
     // Check if script used
-    if (vm.count("script")) {
+    if (vm.count("replay")) {
+        std::cout << "Using Replay Mode..." << std::endl;
+    }
+    else if (vm.count("script")) {
         use_script = true;
         std::cout << "Using Script Mode..." << std::endl;
     }
@@ -311,8 +1082,15 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     }
 
     double elapsed_time = 0.0;
+    update_timing timing;
 
-    if (use_script && is_csv_valid(config_path_script)) {
+    if (vm.count("replay")) {
+        replay_trace(replay_path, timekeeper, link_ids, links, recorder.get(), stop_signal_called);
+        while (not stop_signal_called) {
+            std::this_thread::sleep_for(100ms);
+        }
+    }
+    else if (use_script && is_csv_valid(config_path_script)) {
         config_in.open(config_path_script);
 
         int step = 0;
@@ -325,30 +1103,54 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         std::cout << boost::format("Script starts at elapsed time: %.3fs") % (curr_index) << std::endl;
         std::cout << "Press Enter to start..." << std::endl;
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');        
+        const auto script_start = std::chrono::steady_clock::now();
 
         while (not stop_signal_called) {
             if (elapsed_time >= curr_index) {
+                step_late_s.observe(std::chrono::duration<double>(
+                                        std::chrono::steady_clock::now() - script_start)
+                                        .count()
+                                    - curr_index);
                 std::getline(config_in, fir, ',');
                 std::getline(config_in, bit, ',');
-                fir_coeffs = fir_parser(fir);
-                bit_shift  = static_cast<uint32_t>(std::stoi(bit));
-
-                fir0_ctrl->set_coefficients(fir_coeffs, 0);
-                sr0_ctrl->set_shiftright_value(bit_shift);
+                fir0_coeffs = fir_parser(fir);
+                bit0_shift  = static_cast<uint32_t>(std::stoi(bit));
+                redesign_taps(redesigner, fir0_ctrl->get_max_num_coefficients(), fir0_coeffs, bit0_shift);
 
                 std::getline(config_in, fir, ',');
                 std::getline(config_in, bit);
+                snr_db     = snr_parser(bit);
                 fir_coeffs = fir_parser(fir);
                 bit_shift  = static_cast<uint32_t>(std::stoi(bit));
-
-                fir1_ctrl->set_coefficients(fir_coeffs, 0);
-                sr1_ctrl->set_shiftright_value(bit_shift);
+                redesign_taps(redesigner, fir1_ctrl->get_max_num_coefficients(), fir_coeffs, bit_shift);
+
+                // One SNR applies to both links, two SNRs are per link. Both links
+                // are staged, then written together.
+                const auto update_start = std::chrono::steady_clock::now();
+                if (!snr_db.empty()) {
+                    group.stage_snr(0, snr_db.front(), sig_pwr);
+                    group.stage_snr(1, snr_db.back(), sig_pwr);
+                }
+                set_channel(agc_links, group, 0, fir0_coeffs, bit0_shift);
+                set_channel(agc_links, group, 1, fir_coeffs, bit_shift);
+                timing = commit_channel(agc_links, group, recorder.get());
+                link0_metrics.updated(update_start, sr0_ctrl->get_shiftright_value());
+                link1_metrics.updated(update_start, sr1_ctrl->get_shiftright_value());
+                if (timing.num_links > 1) {
+                    update_skew_s.observe(timing.skew_s);
+                    update_late_s.observe(timing.late_s);
+                }
 
                 // Check if FIR & RS coeffs updated
                 step += 1;
                 std::cout << std::endl;
                 std::cout << boost::format("Script Step: %d   ") % (step) 
                           << boost::format("Running Time: %.3fs") % (elapsed_time) << std::endl;
+                if (timing.num_links > 1) {
+                    std::cout << boost::format("Link update skew: %.1f us, late %.1f us")
+                                     % (timing.skew_s * 1e6) % (timing.late_s * 1e6)
+                              << std::endl;
+                }
 
                 std::cout << "Channel RF A to RF B:" << std::endl;
                 bit_shift = sr0_ctrl->get_shiftright_value();
@@ -357,6 +1159,10 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
                 std::cout << boost::format("FIR0 Coeffs:");
                 for (int16_t i: used_coeffs) std::cout << i << ' ';
                 std::cout << std::endl;
+                if (awgn0_ctrl) {
+                    std::cout << boost::format("SNR0: %.2f dB") % (sig_pwr - awgn0_ctrl->get_noise_power())
+                              << std::endl;
+                }
 
                 std::cout << "Channel RF B to RF A:" << std::endl;
                 bit_shift = sr1_ctrl->get_shiftright_value();
@@ -365,6 +1171,10 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
                 std::cout << boost::format("FIR1 Coeffs:");
                 for (int16_t i: used_coeffs) std::cout << i << ' ';
                 std::cout << std::endl;
+                if (awgn1_ctrl) {
+                    std::cout << boost::format("SNR1: %.2f dB") % (sig_pwr - awgn1_ctrl->get_noise_power())
+                              << std::endl;
+                }
 
                 // Get next config index, keep current config if reach end of script
                 std::getline(config_in, index, ',');
@@ -379,7 +1189,7 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
             }
 
             // Update Running Time & Sleep for update period
-            std::this_thread::sleep_for(1000ms * scruni_t);
+            agc_sleep(agc_links, agc_t, scruni_t);
             elapsed_time += scruni_t;
             std::cout << '.' << std::flush;
         }
@@ -396,28 +1206,50 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
 
                 std::getline(config_in, fir, ',');
                 std::getline(config_in, bit, ',');
-                fir_coeffs = fir_parser(fir);
-                bit_shift  = static_cast<uint32_t>(std::stoi(bit));
-
-                fir0_ctrl->set_coefficients(fir_coeffs, 0);
-                sr0_ctrl->set_shiftright_value(bit_shift);
+                config_reloads.inc();
+                std::string config = fir + ',' + bit + ',';
+                fir0_coeffs = fir_parser(fir);
+                bit0_shift  = static_cast<uint32_t>(std::stoi(bit));
+                redesign_taps(redesigner, fir0_ctrl->get_max_num_coefficients(), fir0_coeffs, bit0_shift);
 
                 std::getline(config_in, fir, ',');
                 std::getline(config_in, bit);
+                config += fir + ',' + bit;
+                if (config != last_config) {
+                    config_changes.inc();
+                    last_config = config;
+                }
+                snr_db     = snr_parser(bit);
                 fir_coeffs = fir_parser(fir);
                 bit_shift  = static_cast<uint32_t>(std::stoi(bit));
-
-                fir1_ctrl->set_coefficients(fir_coeffs, 0);
-                sr1_ctrl->set_shiftright_value(bit_shift);
+                redesign_taps(redesigner, fir1_ctrl->get_max_num_coefficients(), fir_coeffs, bit_shift);
+
+                // One SNR applies to both links, two SNRs are per link. Both links
+                // are staged, then written together.
+                const auto update_start = std::chrono::steady_clock::now();
+                if (!snr_db.empty()) {
+                    group.stage_snr(0, snr_db.front(), sig_pwr);
+                    group.stage_snr(1, snr_db.back(), sig_pwr);
+                }
+                set_channel(agc_links, group, 0, fir0_coeffs, bit0_shift);
+                set_channel(agc_links, group, 1, fir_coeffs, bit_shift);
+                timing = commit_channel(agc_links, group, recorder.get());
+                link0_metrics.updated(update_start, sr0_ctrl->get_shiftright_value());
+                link1_metrics.updated(update_start, sr1_ctrl->get_shiftright_value());
+                if (timing.num_links > 1) {
+                    update_skew_s.observe(timing.skew_s);
+                    update_late_s.observe(timing.late_s);
+                }
 
                 config_in.close();
             }
             else {
+                config_errors.inc();
                 std::cout << "Warning: Could not open the config at '" << config_path_manually << "', use default/previous config." << std::endl;
             }
             
             // Update Running Time & Sleep for update period
-            std::this_thread::sleep_for(1000ms * update_t);
+            agc_sleep(agc_links, agc_t, update_t);
             elapsed_time += update_t;
             std::cout << '.' << std::flush;
 
@@ -425,6 +1257,11 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
             if (std::fmod(elapsed_time, print_t) == 0) {
                 std::cout << std::endl;
                 std::cout << boost::format("Running Time: %fs") % (elapsed_time) << std::endl;
+                if (timing.num_links > 1) {
+                    std::cout << boost::format("Link update skew: %.1f us, late %.1f us")
+                                     % (timing.skew_s * 1e6) % (timing.late_s * 1e6)
+                              << std::endl;
+                }
 
                 std::cout << "Channel RF A to RF B:" << std::endl;
                 bit_shift = sr0_ctrl->get_shiftright_value();
@@ -433,6 +1270,10 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
                 std::cout << boost::format("FIR0 Coeffs:");
                 for (int16_t i: used_coeffs) std::cout << i << ' ';
                 std::cout << std::endl;
+                if (awgn0_ctrl) {
+                    std::cout << boost::format("SNR0: %.2f dB") % (sig_pwr - awgn0_ctrl->get_noise_power())
+                              << std::endl;
+                }
 
                 std::cout << "Channel RF B to RF A:" << std::endl;
                 bit_shift = sr1_ctrl->get_shiftright_value();
@@ -441,6 +1282,10 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
                 std::cout << boost::format("FIR1 Coeffs:");
                 for (int16_t i: used_coeffs) std::cout << i << ' ';
                 std::cout << std::endl;
+                if (awgn1_ctrl) {
+                    std::cout << boost::format("SNR1: %.2f dB") % (sig_pwr - awgn1_ctrl->get_noise_power())
+                              << std::endl;
+                }
             }
         }
     }
@@ -452,8 +1297,22 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     rfa_radio_ctrl->issue_stream_cmd(stream_cmd, rfa_chan);
     rfb_radio_ctrl->issue_stream_cmd(stream_cmd, rfb_chan);
     std::cout << "Done" << std::endl << std::endl;
+    group.print_stats();
+    for (size_t i = 0; i < links.size(); i++) {
+        const rfnoc::openairlink::shiftright_ctrl_stats ctrl = links[i].sr->get_ctrl_stats();
+        std::cout << boost::format("Shiftright%d control: %d writes (%d skipped, %d bursts), %d reads (%d cached, %d mixed telemetry)")
+                         % i % ctrl.pokes % ctrl.skipped_pokes % ctrl.bursts % ctrl.peeks
+                         % ctrl.cached_reads % ctrl.mixed_stats
+                  << std::endl;
+    }
+    if (recorder) {
+        std::cout << boost::format("Recorded %d channel states") % recorder->get_num_records()
+                  << std::endl;
+    }
     // Allow for the samples and ACKs to propagate
     std::this_thread::sleep_for(100ms);
+    health.stop();
+    std::cout << "Stream health:" << std::endl << health.get_summary();
 
-    return EXIT_SUCCESS;
+    return health.tripped() ? EXIT_FAILURE : EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,488 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of 
+    the GNU General Public License as published by the Free Software Foundation, either 
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <uhd/exception.hpp>
+#include <uhd/rfnoc/block_id.hpp>
+#include <uhd/rfnoc/mb_controller.hpp>
+#include <uhd/rfnoc/radio_control.hpp>
+#include <uhd/rfnoc/fir_filter_block_control.hpp>
+#include <uhd/rfnoc_graph.hpp>
+#include <uhd/types/tune_request.hpp>
+#include <uhd/utils/graph_utils.hpp>
+#include <uhd/utils/math.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <rfnoc/openairlink/mimo_model.hpp>
+#include <rfnoc/openairlink/shiftright_block_control.hpp>
+#include <rfnoc/openairlink/sum_block_control.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace po = boost::program_options;
+using uhd::rfnoc::radio_control;
+using uhd::rfnoc::fir_filter_block_control;
+using rfnoc::openairlink::mimo_config;
+using rfnoc::openairlink::shiftright_block_control;
+using rfnoc::openairlink::sum_block_control;
+using namespace std::chrono_literals;
+
+static const size_t NUM_CHANS = mimo_config::NUM_CHANS;
+
+/****************************************************************************
+ * SIGINT handling
+ ***************************************************************************/
+static std::atomic<bool> stop_signal_called{false};
+void sig_int_handler(int)
+{
+    stop_signal_called = true;
+}
+
+/****************************************************************************
+ * Utility function to trim whitespace from both ends of a string
+ ***************************************************************************/
+std::string space_trim(const std::string& str) {
+    std::string out = str;
+    out.erase(out.begin(), std::find_if(out.begin(), out.end(), [](unsigned char ch) {
+        return !std::isspace(ch);
+    }));
+    out.erase(std::find_if(out.rbegin(), out.rend(), [](unsigned char ch) {
+        return !std::isspace(ch);
+    }).base(), out.end());
+    return out;
+}
+
+/****************************************************************************
+ * Verify The condition of CSV config file
+ ***************************************************************************/
+bool is_csv_valid(const std::string& path) {
+    std::ifstream target_csv;
+    bool valid;
+
+    target_csv.open(path);
+    valid = !target_csv.fail();
+    target_csv.close();
+
+    return valid;
+}
+
+/****************************************************************************
+ * Handles of the four FIR -> Shiftright paths, path [rx][tx] has index 2*rx+tx
+ ***************************************************************************/
+struct mimo_paths
+{
+    std::vector<fir_filter_block_control::sptr> fir;
+    std::vector<shiftright_block_control::sptr> shift;
+};
+
+/****************************************************************************
+ * Write a channel matrix to the paths
+ *
+ * The whole matrix is checked before the first register write and only the
+ * paths that differ from the current matrix are written, back to back. If a
+ * write fails, the previous matrix is restored, so the emulator never keeps
+ * running with a mix of two matrices.
+ ***************************************************************************/
+double apply_matrix(mimo_paths& paths, mimo_config& current, const mimo_config& next)
+{
+    const size_t max_taps = paths.fir.front()->get_max_num_coefficients();
+    for (size_t r = 0; r < NUM_CHANS; r++) {
+        for (size_t t = 0; t < NUM_CHANS; t++) {
+            if (next.coeffs[r][t].empty() || next.coeffs[r][t].size() > max_taps) {
+                throw uhd::value_error(str(
+                    boost::format("Path %d%d has %d taps, must be 1 to %d")
+                    % r % t % next.coeffs[r][t].size() % max_taps));
+            }
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    auto write_paths = [&paths](const mimo_config& from, const mimo_config& to) {
+        for (size_t r = 0; r < NUM_CHANS; r++) {
+            for (size_t t = 0; t < NUM_CHANS; t++) {
+                const size_t k = r * NUM_CHANS + t;
+                if (from.coeffs[r][t] != to.coeffs[r][t]) {
+                    paths.fir[k]->set_coefficients(to.coeffs[r][t], 0);
+                }
+                if (from.shiftright[r][t] != to.shiftright[r][t]) {
+                    paths.shift[k]->set_shiftright_value(to.shiftright[r][t]);
+                }
+            }
+        }
+    };
+    try {
+        write_paths(current, next);
+    } catch (...) {
+        // Paths may be in either state, so write all of them back
+        mimo_config unknown;
+        for (size_t r = 0; r < NUM_CHANS; r++) {
+            for (size_t t = 0; t < NUM_CHANS; t++) {
+                unknown.coeffs[r][t].clear();
+                unknown.shiftright[r][t] = ~current.shiftright[r][t];
+            }
+        }
+        write_paths(unknown, current);
+        throw;
+    }
+    current = next;
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/****************************************************************************
+ * Print the channel matrix read back from the device
+ ***************************************************************************/
+void print_matrix(mimo_paths& paths, std::vector<sum_block_control::sptr>& sums)
+{
+    std::vector<int16_t> used_coeffs;
+    for (size_t r = 0; r < NUM_CHANS; r++) {
+        for (size_t t = 0; t < NUM_CHANS; t++) {
+            const size_t k = r * NUM_CHANS + t;
+            std::cout << boost::format("Path TX%d to RX%d: ") % t % r;
+            std::cout << boost::format("Shift%d bits: %d    ") % k % paths.shift[k]->get_shiftright_value();
+            used_coeffs = paths.fir[k]->get_coefficients();
+            std::cout << boost::format("FIR%d Coeffs:") % k;
+            for (int16_t i: used_coeffs) std::cout << i << ' ';
+            std::cout << std::endl;
+        }
+        std::cout << boost::format("Sum%d saturated samples: %d") % r % sums[r]->get_saturation_count()
+                  << std::endl;
+    }
+}
+
+/****************************************************************************
+ * main
+ ***************************************************************************/
+int UHD_SAFE_MAIN(int argc, char* argv[])
+{
+    // variables to be set by po
+    std::string args;
+    double rfa_freq, rfb_freq, rx_gain, tx_gain, rx_bw, tx_bw, update_t, print_t, scruni_t;
+
+    // constant variable
+    std::string rfa_blkid = "0/Radio#0";
+    std::string rfb_blkid = "0/Radio#1";
+
+    double setup_time = 0.1;
+
+    size_t rfa_chan = 0;  // Channel index
+    size_t rfb_chan = 0;
+    size_t spp      = 32; // Samples per packet (reduce for lower latency)
+
+    bool rx_timestamps = false; // Set timestamps on RX
+    bool use_script    = false;
+
+    // setup config path
+    std::string root = CMAKE_SOURCE_DIR;
+    std::string config_path_manually = root + "/channel_control/chan_mimo_manually.csv";
+    std::string config_path_script   = root + "/channel_control/chan_mimo_script.csv";
+    std::ifstream config_in;
+
+    // setup the program options
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "UHD device address args")
+        ("rfa-freq", po::value<double>(&rfa_freq)->default_value(3619.2e6), "RF A center frequency in Hz")
+        ("rfb-freq", po::value<double>(&rfb_freq)->default_value(3619.2e6), "RF B center frequency in Hz")
+        ("rx-gain", po::value<double>(&rx_gain)->default_value(0.0), "Rx RF gain in dB")
+        ("tx-gain", po::value<double>(&tx_gain)->default_value(0.0), "Tx RF gain in dB")
+        ("rx-bw", po::value<double>(&rx_bw)->default_value(80e6), "RX analog frontend filter bandwidth in Hz")
+        ("tx-bw", po::value<double>(&tx_bw)->default_value(80e6), "TX analog frontend filter bandwidth in Hz")
+        ("udt", po::value<double>(&update_t)->default_value(1), "Time period to update emulator channel")
+        ("prt", po::value<double>(&print_t)->default_value(5), "Time period to output emulator channel")
+        ("script", "Use channel script config")
+        ("scr-t", po::value<double>(&scruni_t)->default_value(0.2), "Time resolution of the channel script")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("Channel Emulator 2x2 MIMO %s") % desc << std::endl;
+        std::cout
+            << std::endl
+            << "This application runs 2x2 MIMO channel emulation using RFNoC.\n"
+            << "It needs the x310_mimo_rfnoc_image_core FPGA image.\n"
+            << std::endl;
+        return ~0;
+    }
+
+    /************************************************************************
+     * Create device and block controls
+     ***********************************************************************/
+    std::cout << std::endl;
+    std::cout << boost::format("Creating the RFNoC graph with args: %s...") % args
+              << std::endl;
+    uhd::rfnoc::rfnoc_graph::sptr graph = uhd::rfnoc::rfnoc_graph::make(args);
+
+    // Create handles for radio objects
+    uhd::rfnoc::block_id_t rfa_radio_ctrl_id(rfa_blkid);
+    uhd::rfnoc::block_id_t rfb_radio_ctrl_id(rfb_blkid);
+
+    // This next line will fail if the radio is not actually available
+    uhd::rfnoc::radio_control::sptr rfa_radio_ctrl =
+        graph->get_block<uhd::rfnoc::radio_control>(rfa_radio_ctrl_id);
+    uhd::rfnoc::radio_control::sptr rfb_radio_ctrl =
+        graph->get_block<uhd::rfnoc::radio_control>(rfb_radio_ctrl_id);
+    std::cout << "Using RF A radio " << rfa_radio_ctrl_id << ", channel " << rfa_chan
+              << std::endl;
+    std::cout << "Using RF B radio " << rfb_radio_ctrl_id << ", channel " << rfb_chan
+              << std::endl;
+    size_t rfa_mb_idx = rfa_radio_ctrl_id.get_device_no();
+
+    // Create the FIR and Shiftright blocks of the four paths
+    mimo_paths paths;
+    for (size_t k = 0; k < NUM_CHANS * NUM_CHANS; k++) {
+        paths.fir.push_back(graph->get_block<fir_filter_block_control>(
+            uhd::rfnoc::block_id_t(0, "FIR", k)));
+        paths.shift.push_back(graph->get_block<shiftright_block_control>(
+            uhd::rfnoc::block_id_t(0, "Shiftright", k)));
+    }
+
+    // Create Sum blocks
+    std::vector<sum_block_control::sptr> sums;
+    for (size_t r = 0; r < NUM_CHANS; r++) {
+        sums.push_back(graph->get_block<sum_block_control>(uhd::rfnoc::block_id_t(0, "Sum", r)));
+    }
+
+    /************************************************************************
+     * Set up radio
+     ***********************************************************************/
+    // Connect the static topology, see x310_mimo_rfnoc_image_core.yml:
+    // Radio#t -> SplitStream#t -> FIR#(2r+t) -> Shiftright#(2r+t) -> Sum#r -> Radio#r
+    const std::vector<uhd::rfnoc::block_id_t> radio_ids = {rfa_radio_ctrl_id, rfb_radio_ctrl_id};
+    for (size_t t = 0; t < NUM_CHANS; t++) {
+        const uhd::rfnoc::block_id_t split_id(0, "SplitStream", t);
+        graph->connect(radio_ids[t], 0, split_id, 0);
+        for (size_t r = 0; r < NUM_CHANS; r++) {
+            const size_t k = r * NUM_CHANS + t;
+            graph->connect(split_id, r, paths.fir[k]->get_block_id(), 0);
+            graph->connect(paths.fir[k]->get_block_id(), 0, paths.shift[k]->get_block_id(), 0);
+            graph->connect(paths.shift[k]->get_block_id(), 0, sums[r]->get_block_id(), t);
+        }
+    }
+    // Close the loop back to the radios, these edges form the graph cycles
+    for (size_t r = 0; r < NUM_CHANS; r++) {
+        graph->connect(sums[r]->get_block_id(), 0, radio_ids[r], 0, true);
+    }
+    graph->commit();
+
+    rfa_radio_ctrl->enable_rx_timestamps(rx_timestamps, rfa_chan);
+    rfb_radio_ctrl->enable_rx_timestamps(rx_timestamps, rfb_chan);
+    rfa_radio_ctrl->set_rx_dc_offset(true, rfa_chan); // Set up DC offset calibration
+    rfb_radio_ctrl->set_rx_dc_offset(true, rfb_chan);
+
+    // Start with the identity matrix, i.e., two independent links
+    mimo_config matrix;
+    for (size_t r = 0; r < NUM_CHANS; r++) {
+        for (size_t t = 0; t < NUM_CHANS; t++) {
+            const size_t k = r * NUM_CHANS + t;
+            paths.fir[k]->set_coefficients(matrix.coeffs[r][t], 0);
+            paths.shift[k]->set_shiftright_value(matrix.shiftright[r][t]);
+        }
+        sums[r]->clear_saturation_count();
+    }
+    std::cout << boost::format("Max FIR taps supported: %f") % (paths.fir.front()->get_max_num_coefficients())
+              << std::endl;
+
+    // show sample rate
+    double rate;
+    rate = rfa_radio_ctrl->get_rate();
+    std::cout << boost::format("Sample Rate: %f Msps...") % (rate / 1e6) << std::endl;
+
+    // set the center frequency
+    rfa_radio_ctrl->set_rx_frequency(rfa_freq, rfa_chan);
+    rfa_radio_ctrl->set_tx_frequency(rfa_freq, rfa_chan);
+    std::cout << boost::format("Actual RF A central Freq: %f MHz...") % (rfa_radio_ctrl->get_rx_frequency(rfa_chan) / 1e6) << std::endl;
+
+    rfb_radio_ctrl->set_tx_frequency(rfb_freq, rfb_chan);
+    rfb_radio_ctrl->set_rx_frequency(rfb_freq, rfb_chan);
+    std::cout << boost::format("Actual RF B central Freq: %f MHz...") % (rfb_radio_ctrl->get_tx_frequency(rfb_chan) / 1e6) << std::endl;
+
+    // set the rf gain
+    rfa_radio_ctrl->set_rx_gain(rx_gain, rfa_chan);
+    rfb_radio_ctrl->set_rx_gain(rx_gain, rfb_chan);
+    std::cout << boost::format("Actual RX Gain: %f dB...") % rfa_radio_ctrl->get_rx_gain(rfa_chan)
+                << std::endl;
+
+    rfb_radio_ctrl->set_tx_gain(tx_gain, rfb_chan);
+    rfa_radio_ctrl->set_tx_gain(tx_gain, rfa_chan);
+    std::cout << boost::format("Actual TX Gain: %f dB...") % rfb_radio_ctrl->get_tx_gain(rfb_chan)
+                << std::endl;
+
+    // set the IF filter bandwidth
+    rfa_radio_ctrl->set_rx_bandwidth(rx_bw, rfa_chan);
+    rfb_radio_ctrl->set_rx_bandwidth(rx_bw, rfb_chan);
+    std::cout << boost::format("Actual RX Bandwidth: %f MHz...")
+                        % (rfa_radio_ctrl->get_rx_bandwidth(rfa_chan) / 1e6)
+                << std::endl;
+
+    rfb_radio_ctrl->set_tx_bandwidth(tx_bw, rfb_chan);
+    rfa_radio_ctrl->set_tx_bandwidth(tx_bw, rfa_chan);
+    std::cout << boost::format("Actual TX Bandwidth: %f MHz...")
+                        % (rfb_radio_ctrl->get_tx_bandwidth(rfb_chan) / 1e6)
+                << std::endl;
+
+    // set the antennas
+    rfa_radio_ctrl->set_property<int>("spp", spp, 0);
+    rfb_radio_ctrl->set_property<int>("spp", spp, 0);
+    spp = rfa_radio_ctrl->get_property<int>("spp", 0);
+    std::cout << "Samples per packet: " << spp << std::endl;
+
+    // Allow for some setup time
+    std::this_thread::sleep_for(1s * setup_time);
+
+    // Arm SIGINT handler
+    std::signal(SIGINT, &sig_int_handler);
+
+    // Start streaming 
+    uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    stream_cmd.stream_now = false;
+    stream_cmd.time_spec =
+        graph->get_mb_controller(rfa_mb_idx)->get_timekeeper(rfa_mb_idx)->get_time_now()
+        + setup_time;
+    std::cout << "Issuing start stream cmd..." << std::endl;
+    rfa_radio_ctrl->issue_stream_cmd(stream_cmd, rfa_chan);
+    rfb_radio_ctrl->issue_stream_cmd(stream_cmd, rfb_chan);
+     
+    std::cout << std::endl;
+    std::cout << "**********Emulation is Now Running**********" << std::endl;
+
+    // Keep running and update channel
+    std::string line;
+    double apply_t;
+
+    // Check if script used
+    if (vm.count("script")) {
+        use_script = true;
+        std::cout << "Using Script Mode..." << std::endl;
+    }
+    else {
+        std::cout << "Using Manual Mode..." << std::endl;
+    }
+
+    double elapsed_time = 0.0;
+
+    if (use_script && is_csv_valid(config_path_script)) {
+        config_in.open(config_path_script);
+
+        int step = 0;
+        double curr_index;
+        std::string index;
+
+        std::getline(config_in, index, ',');
+        curr_index  = static_cast<double>(std::stod(index));
+
+        std::cout << boost::format("Script starts at elapsed time: %.3fs") % (curr_index) << std::endl;
+        std::cout << "Press Enter to start..." << std::endl;
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');        
+
+        while (not stop_signal_called) {
+            if (elapsed_time >= curr_index) {
+                std::getline(config_in, line);
+                step += 1;
+                std::cout << std::endl;
+                std::cout << boost::format("Script Step: %d   ") % (step) 
+                          << boost::format("Running Time: %.3fs") % (elapsed_time) << std::endl;
+
+                try {
+                    apply_t = apply_matrix(paths, matrix, mimo_config::from_csv(line));
+                    std::cout << boost::format("Matrix applied in %.3f ms") % (apply_t * 1e3) << std::endl;
+                } catch (const std::exception& ex) {
+                    std::cout << "Warning: Skipping script step, " << ex.what() << std::endl;
+                }
+                print_matrix(paths, sums);
+
+                // Get next config index, keep current config if reach end of script
+                std::getline(config_in, index, ',');
+                index = space_trim(index); // Trim whitespace
+        
+                if (index.compare("eos") != 0) {
+                    curr_index = static_cast<double>(std::stod(index));
+                } else {
+                    curr_index = std::numeric_limits<double>::infinity();
+                    std::cout << "Reached end of Script, keep the current config..." << std::endl << std::endl;
+                }
+            }
+
+            // Update Running Time & Sleep for update period
+            std::this_thread::sleep_for(1000ms * scruni_t);
+            elapsed_time += scruni_t;
+            std::cout << '.' << std::flush;
+        }
+        config_in.close();
+    }
+    else {
+        if (use_script) {
+            std::cout << "Warning: Could not open the script config at '" << config_path_script << "', using manually config instead." << std::endl;
+        }
+
+        while (not stop_signal_called) {
+            if (is_csv_valid(config_path_manually)) {
+                config_in.open(config_path_manually);
+                std::getline(config_in, line);
+                config_in.close();
+
+                try {
+                    const mimo_config next = mimo_config::from_csv(line);
+                    if (next != matrix) {
+                        apply_t = apply_matrix(paths, matrix, next);
+                        std::cout << std::endl;
+                        std::cout << boost::format("Matrix applied in %.3f ms") % (apply_t * 1e3) << std::endl;
+                    }
+                } catch (const std::exception& ex) {
+                    std::cout << "Warning: Keeping previous config, " << ex.what() << std::endl;
+                }
+            }
+            else {
+                std::cout << "Warning: Could not open the config at '" << config_path_manually << "', use default/previous config." << std::endl;
+            }
+            
+            // Update Running Time & Sleep for update period
+            std::this_thread::sleep_for(1000ms * update_t);
+            elapsed_time += update_t;
+            std::cout << '.' << std::flush;
+
+            // Check FIR & RS coeffs with print period
+            if (std::fmod(elapsed_time, print_t) == 0) {
+                std::cout << std::endl;
+                std::cout << boost::format("Running Time: %fs") % (elapsed_time) << std::endl;
+                print_matrix(paths, sums);
+            }
+        }
+    }
+
+    // Stop radio
+    std::cout << std::endl;
+    stream_cmd.stream_mode = uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS;
+    std::cout << "Issuing stop stream cmd..." << std::endl;
+    rfa_radio_ctrl->issue_stream_cmd(stream_cmd, rfa_chan);
+    rfb_radio_ctrl->issue_stream_cmd(stream_cmd, rfb_chan);
+    std::cout << "Done" << std::endl << std::endl;
+    // Allow for the samples and ACKs to propagate
+    std::this_thread::sleep_for(100ms);
+
+    return EXIT_SUCCESS;
+}
@@ -14,6 +14,8 @@
 **/
 
 #include <uhd/rfnoc/block_id.hpp>
+#include <uhd/rfnoc/ddc_block_control.hpp>
+#include <uhd/rfnoc/duc_block_control.hpp>
 #include <uhd/rfnoc/mb_controller.hpp>
 #include <uhd/rfnoc/radio_control.hpp>
 #include <uhd/rfnoc/fir_filter_block_control.hpp>
@@ -22,13 +24,22 @@
 #include <uhd/utils/graph_utils.hpp>
 #include <uhd/utils/math.hpp>
 #include <uhd/utils/safe_main.hpp>
+#include <rfnoc/openairlink/awgn_block_control.hpp>
+#include <rfnoc/openairlink/channel_trace.hpp>
+#include <rfnoc/openairlink/metrics.hpp>
+#include <rfnoc/openairlink/metrics_server.hpp>
+#include <rfnoc/openairlink/multirate_taps.hpp>
+#include <rfnoc/openairlink/shiftright_agc.hpp>
 #include <rfnoc/openairlink/shiftright_block_control.hpp>
+#include <rfnoc/openairlink/stream_health.hpp>
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
+#include <atomic>
 #include <chrono>
 #include <csignal>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <thread>
 #include <vector>
@@ -36,18 +47,52 @@
 namespace po = boost::program_options;
 using uhd::rfnoc::radio_control;
 using uhd::rfnoc::fir_filter_block_control;
+using rfnoc::openairlink::awgn_block_control;
+using rfnoc::openairlink::channel_trace_link;
+using rfnoc::openairlink::link_blocks;
+using rfnoc::openairlink::metric_counter;
+using rfnoc::openairlink::metric_gauge;
+using rfnoc::openairlink::metric_histogram;
+using rfnoc::openairlink::metrics_registry;
+using rfnoc::openairlink::metrics_server;
+using rfnoc::openairlink::multirate_taps;
+using rfnoc::openairlink::shiftright_agc;
 using rfnoc::openairlink::shiftright_block_control;
+using rfnoc::openairlink::state_recorder;
+using rfnoc::openairlink::stream_health_monitor;
 using namespace std::chrono_literals;
 
 /****************************************************************************
  * SIGINT handling
  ***************************************************************************/
-static bool stop_signal_called = false;
+static std::atomic<bool> stop_signal_called{false};
 void sig_int_handler(int)
 {
     stop_signal_called = true;
 }
 
+/****************************************************************************
+ * Stream health limits from the command line
+ ***************************************************************************/
+void set_stream_limits(stream_health_monitor& monitor, const po::variables_map& vm)
+{
+    if (vm.count("max-overflows")) {
+        monitor.set_limit(rfnoc::openairlink::STREAM_EVENT_OVERFLOW,
+            vm["max-overflows"].as<uint64_t>());
+    }
+    if (vm.count("max-underflows")) {
+        monitor.set_limit(rfnoc::openairlink::STREAM_EVENT_UNDERFLOW,
+            vm["max-underflows"].as<uint64_t>());
+    }
+    if (vm.count("max-late")) {
+        monitor.set_limit(rfnoc::openairlink::STREAM_EVENT_LATE_COMMAND,
+            vm["max-late"].as<uint64_t>());
+    }
+    if (vm.count("stop-on-errors")) {
+        monitor.set_trip_callback([](const std::string&) { stop_signal_called = true; });
+    }
+}
+
 /****************************************************************************
  * String to FIR Coeffs
  ***************************************************************************/
@@ -78,6 +123,173 @@ std::string space_trim(const std::string& str) {
     return out;
 }
 
+/****************************************************************************
+ * Split the optional SNR columns (in dB) from the last field of a config line
+ ***************************************************************************/
+std::vector<double> snr_parser(std::string& field)
+{
+    std::vector<double> snr_db;
+    size_t sep = field.find(',');
+    if (sep == std::string::npos) {
+        return snr_db;
+    }
+
+    std::istringstream iss(field.substr(sep + 1));
+    std::string value;
+    field = field.substr(0, sep);
+    while (std::getline(iss, value, ',')) {
+        value = space_trim(value);
+        if (!value.empty()) {
+            snr_db.push_back(std::stod(value));
+        }
+    }
+
+    return snr_db;
+}
+
+/****************************************************************************
+ * Redesign full rate taps for the FIR rate, unchanged without decimation
+ ***************************************************************************/
+void redesign_taps(const multirate_taps& redesigner, const size_t max_taps,
+    std::vector<int16_t>& fir_coeffs, uint32_t& bit_shift)
+{
+    if (redesigner.get_decim() > 1) {
+        const std::vector<int16_t> full_rate_coeffs = fir_coeffs;
+        redesigner.redesign(full_rate_coeffs, bit_shift, max_taps, fir_coeffs, bit_shift);
+    }
+}
+
+/****************************************************************************
+ * Metrics of the control loop of one link
+ ***************************************************************************/
+struct link_metrics
+{
+    link_metrics(metrics_registry& registry, const std::string& link)
+        : updates(registry.add_counter(
+            "oal_channel_updates_total", "Channel settings written", "link=\"" + link + "\""))
+        , control_s(registry.add_histogram("oal_control_seconds",
+              "Duration of the writes of a channel setting",
+              metrics_registry::exponential_buckets(1e-5, 2.0, 16),
+              "link=\"" + link + "\""))
+        , shiftright(registry.add_gauge(
+              "oal_shiftright", "Shift of the Shiftright block", "link=\"" + link + "\""))
+        , agc_updates(registry.add_counter(
+              "oal_agc_updates_total", "AGC settings written", "link=\"" + link + "\""))
+    {
+    }
+
+    //! A channel setting was written, the writes started at start
+    void updated(const std::chrono::steady_clock::time_point& start, const uint32_t shift)
+    {
+        updates.inc();
+        control_s.observe(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        shiftright.set(shift);
+    }
+
+    metric_counter& updates;
+    metric_histogram& control_s;
+    metric_gauge& shiftright;
+    metric_counter& agc_updates;
+};
+
+/****************************************************************************
+ * AGC state of one link
+ ***************************************************************************/
+struct agc_link
+{
+    agc_link(const double headroom_db, const double hysteresis_db, const uint32_t window,
+        fir_filter_block_control::sptr fir, shiftright_block_control::sptr sr)
+        : agc(headroom_db, hysteresis_db), fir(fir), sr(sr), window(window), count(0)
+    {
+    }
+
+    shiftright_agc agc;
+    fir_filter_block_control::sptr fir;
+    shiftright_block_control::sptr sr;
+    uint32_t window;
+    uint32_t count;
+    std::vector<int16_t> channel;
+    state_recorder* recorder = nullptr;
+    size_t link_idx          = 0;
+    link_metrics* metrics    = nullptr;
+};
+
+/****************************************************************************
+ * Write the AGC setting of a link and restart its telemetry window
+ ***************************************************************************/
+void agc_apply(agc_link& link)
+{
+    link.fir->set_coefficients(link.agc.get_coefficients(), 0);
+    link.sr->set_shiftright_value(link.agc.get_shiftright_value());
+    link.sr->set_stats_window(link.window);
+    link.count = link.sr->get_stats().count;
+    if (link.recorder) {
+        link.recorder->record(
+            link.link_idx, link.agc.get_coefficients(), link.agc.get_shiftright_value());
+    }
+    if (link.metrics) {
+        link.metrics->agc_updates.inc();
+        link.metrics->shiftright.set(link.agc.get_shiftright_value());
+    }
+}
+
+/****************************************************************************
+ * Write a channel setting, the AGC of the link replaces the shift if enabled
+ ***************************************************************************/
+void set_channel(std::vector<agc_link>& agc_links, const size_t link_idx,
+    fir_filter_block_control::sptr fir, shiftright_block_control::sptr sr,
+    const std::vector<int16_t>& fir_coeffs, const uint32_t bit_shift,
+    state_recorder* recorder)
+{
+    if (agc_links.empty()) {
+        fir->set_coefficients(fir_coeffs, 0);
+        sr->set_shiftright_value(bit_shift);
+        if (recorder) {
+            recorder->record(link_idx, fir_coeffs, bit_shift);
+        }
+        return;
+    }
+
+    agc_link& link = agc_links[link_idx];
+    if (fir_coeffs != link.channel) {
+        link.channel = fir_coeffs;
+        link.agc.set_coefficients(fir_coeffs);
+        agc_apply(link);
+    }
+}
+
+/****************************************************************************
+ * Sleep for the update period, run the AGC meanwhile if enabled
+ ***************************************************************************/
+void agc_sleep(std::vector<agc_link>& agc_links, const double agc_t, const double period)
+{
+    const auto end = std::chrono::steady_clock::now()
+                     + std::chrono::duration_cast<std::chrono::steady_clock::duration>(1000ms * period);
+    if (agc_links.empty()) {
+        std::this_thread::sleep_until(end);
+        return;
+    }
+
+    while (not stop_signal_called && std::chrono::steady_clock::now() < end) {
+        for (auto& link : agc_links) {
+            // One AGC step per telemetry window taken with the current setting
+            const rfnoc::openairlink::shiftright_stats stats = link.sr->get_stats();
+            if (stats.count == link.count) {
+                continue;
+            }
+            if (link.agc.update(stats)) {
+                agc_apply(link);
+            } else {
+                link.count = stats.count;
+            }
+        }
+        std::this_thread::sleep_until(std::min(end,
+            std::chrono::steady_clock::now()
+                + std::chrono::duration_cast<std::chrono::steady_clock::duration>(1000ms * agc_t)));
+    }
+}
+
 /****************************************************************************
  * Verify The condition of CSV config file
  ***************************************************************************/
@@ -98,14 +310,20 @@ bool is_csv_valid(const std::string& path) {
 int UHD_SAFE_MAIN(int argc, char* argv[])
 {
     // variables to be set by po
-    std::string args, rx_ant, tx_ant;
-    double rx_freq, tx_freq, rx_gain, tx_gain, rx_bw, tx_bw, update_t, print_t, scruni_t;
+    std::string args, rx_ant, tx_ant, record_path, replay_path;
+    double rx_freq, tx_freq, rx_gain, tx_gain, rx_bw, tx_bw, update_t, print_t, scruni_t, sig_pwr;
+    size_t decim;
+    double agc_headroom, agc_hyst, agc_t;
+    uint32_t agc_window;
 
     // constant variable
     std::string rx_blockid = "0/Radio#1";
     std::string tx_blockid = "0/Radio#0";
     std::string fir_id     = "0/FIR#1";
     std::string shift_id   = "0/Shiftright#1";
+    std::string awgn_id    = "0/AWGN#1";
+    std::string ddc_id     = "0/DDC#1";
+    std::string duc_id     = "0/DUC#1";
 
     double setup_time = 0.1;
     uint32_t bit_shift = 0;
@@ -141,6 +359,21 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         ("prt", po::value<double>(&print_t)->default_value(5), "Time period to output emulator channel")
         ("script", "Use channel script config")
         ("scr-t", po::value<double>(&scruni_t)->default_value(0.2), "Time period to output emulator channel")
+        ("sig-pwr", po::value<double>(&sig_pwr)->default_value(-12.0), "Signal power at the AWGN block input in dBFS, reference for the SNR column")
+        ("decim", po::value<size_t>(&decim)->default_value(1), "Run the FIR at the radio rate divided by this factor with the DDC/DUC blocks, taps in the config are then given at the radio rate and redesigned")
+        ("agc", "Choose the shift and scale the taps automatically from the Shiftright telemetry, the shift column of the config is ignored")
+        ("agc-headroom", po::value<double>(&agc_headroom)->default_value(6.0), "AGC output peak target below full scale in dB")
+        ("agc-hyst", po::value<double>(&agc_hyst)->default_value(1.0), "AGC dead band on top of one shift step in dB")
+        ("agc-window", po::value<uint32_t>(&agc_window)->default_value(16), "Log2 of the AGC telemetry window length in samples")
+        ("agc-t", po::value<double>(&agc_t)->default_value(0.01), "Time period to poll the AGC telemetry")
+        ("record", po::value<std::string>(&record_path), "Record every applied channel state with device time and readback to this binary trace")
+        ("replay", po::value<std::string>(&replay_path), "Replay a channel trace with its recorded timing instead of the channel config")
+        ("max-overflows", po::value<uint64_t>(), "Flag the run as degraded after more RX overflows than this")
+        ("max-underflows", po::value<uint64_t>(), "Flag the run as degraded after more TX underflows than this")
+        ("max-late", po::value<uint64_t>(), "Flag the run as degraded after more late timed commands than this")
+        ("stop-on-errors", "Stop the run when one of the stream error limits is exceeded")
+        ("metrics-port", po::value<uint16_t>(), "Serve Prometheus metrics of the run on this port of 127.0.0.1")
+        ("metrics-socket", po::value<std::string>(), "Serve Prometheus metrics of the run on this Unix socket")
     ;
     // clang-format on
     po::variables_map vm;
@@ -157,6 +390,14 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         return ~0;
     }
 
+    // The block clips larger windows, the AGC would then wait on the wrong length
+    if (agc_window > rfnoc::openairlink::shiftright_block_control::MAX_STATS_WINDOW) {
+        std::cout << boost::format("--agc-window must be at most %d")
+                         % rfnoc::openairlink::shiftright_block_control::MAX_STATS_WINDOW
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
     /************************************************************************
      * Create device and block controls
      ***********************************************************************/
@@ -170,6 +411,9 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     uhd::rfnoc::block_id_t tx_radio_ctrl_id(tx_blockid);
     uhd::rfnoc::block_id_t fir_ctrl_id(fir_id);
     uhd::rfnoc::block_id_t shift_ctrl_id(shift_id);
+    uhd::rfnoc::block_id_t awgn_ctrl_id(awgn_id);
+    uhd::rfnoc::block_id_t ddc_ctrl_id(ddc_id);
+    uhd::rfnoc::block_id_t duc_ctrl_id(duc_id);
 
     // This next line will fail if the radio is not actually available
     uhd::rfnoc::radio_control::sptr rx_radio_ctrl =
@@ -190,6 +434,27 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     rfnoc::openairlink::shiftright_block_control::sptr sr_ctrl;
     sr_ctrl = graph->get_block<rfnoc::openairlink::shiftright_block_control>(shift_ctrl_id);
 
+    // Create AWGN block, optional since older FPGA images don't have it
+    rfnoc::openairlink::awgn_block_control::sptr awgn_ctrl;
+    if (graph->has_block(awgn_ctrl_id)) {
+        awgn_ctrl = graph->get_block<rfnoc::openairlink::awgn_block_control>(awgn_ctrl_id);
+        std::cout << "Using AWGN block " << awgn_ctrl_id << std::endl;
+    } else {
+        std::cout << "No AWGN block found, SNR settings are ignored." << std::endl;
+    }
+
+    // Create DDC/DUC blocks, optional since older FPGA images don't have them
+    uhd::rfnoc::ddc_block_control::sptr ddc_ctrl;
+    uhd::rfnoc::duc_block_control::sptr duc_ctrl;
+    if (graph->has_block(ddc_ctrl_id) && graph->has_block(duc_ctrl_id)) {
+        ddc_ctrl = graph->get_block<uhd::rfnoc::ddc_block_control>(ddc_ctrl_id);
+        duc_ctrl = graph->get_block<uhd::rfnoc::duc_block_control>(duc_ctrl_id);
+        std::cout << "Using DDC/DUC blocks " << ddc_ctrl_id << ", " << duc_ctrl_id << std::endl;
+    } else if (decim > 1) {
+        std::cout << "No DDC/DUC blocks found, the FIR can only run at the radio rate." << std::endl;
+        return EXIT_FAILURE;
+    }
+
     /************************************************************************
      * Set up radio
      ***********************************************************************/
@@ -197,14 +462,22 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     // looping back to a single radio block, skip property propagation after
     // traversing back to the starting point of the chain.
     const bool skip_pp = rx_radio_ctrl_id == tx_radio_ctrl_id;
-    // Connect block chain from the RF A radio to the RF B radio
+    // Connect block chain from the RF A radio to the RF B radio, this also
+    // connects the DDC/DUC blocks if the image has them statically in the chain
 
     uhd::rfnoc::connect_through_blocks(
         graph, rx_radio_ctrl_id, rx_chan, fir_ctrl_id, 0, false);
     uhd::rfnoc::connect_through_blocks(
         graph, fir_ctrl_id, 0, shift_ctrl_id, 0, false);
-    uhd::rfnoc::connect_through_blocks(
-        graph, shift_ctrl_id, 0, tx_radio_ctrl_id, tx_chan, skip_pp);
+    if (awgn_ctrl) {
+        uhd::rfnoc::connect_through_blocks(
+            graph, shift_ctrl_id, 0, awgn_ctrl_id, 0, false);
+        uhd::rfnoc::connect_through_blocks(
+            graph, awgn_ctrl_id, 0, tx_radio_ctrl_id, tx_chan, skip_pp);
+    } else {
+        uhd::rfnoc::connect_through_blocks(
+            graph, shift_ctrl_id, 0, tx_radio_ctrl_id, tx_chan, skip_pp);
+    }
     graph->commit();
 
     rx_radio_ctrl->enable_rx_timestamps(rx_timestamps, rx_chan);
@@ -218,10 +491,69 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     // Set up Shiftright
     sr_ctrl->set_shiftright_value(bit_shift);
 
+    // Set up the channel trace
+    const std::vector<link_blocks> links = {{fir_ctrl, sr_ctrl, awgn_ctrl}};
+    const std::vector<channel_trace_link> link_ids = {{fir_id, shift_id}};
+    uhd::rfnoc::mb_controller::timekeeper::sptr timekeeper =
+        graph->get_mb_controller(rx_mb_idx)->get_timekeeper(rx_mb_idx);
+    std::unique_ptr<state_recorder> recorder;
+    if (vm.count("record")) {
+        recorder.reset(new state_recorder(record_path, timekeeper, link_ids, links));
+        std::cout << "Recording the channel states to " << record_path << std::endl;
+    }
+
+    // Set up the metrics, the updates are cheap enough to keep them always on
+    metrics_registry metrics;
+    link_metrics link0_metrics(metrics, "link0");
+    metric_histogram& step_late_s = metrics.add_histogram("oal_step_late_seconds",
+        "Delay of a script step behind its scheduled time",
+        metrics_registry::exponential_buckets(1e-3, 2.0, 12));
+    metric_counter& config_reloads =
+        metrics.add_counter("oal_config_reloads_total", "Reads of the manual channel config");
+    metric_counter& config_changes = metrics.add_counter(
+        "oal_config_changes_total", "Reads of the manual channel config with a new setting");
+    metric_counter& config_errors = metrics.add_counter(
+        "oal_config_errors_total", "Failed reads of the manual channel config");
+    std::unique_ptr<metrics_server> server;
+    if (vm.count("metrics-port")) {
+        server.reset(new metrics_server(metrics, vm["metrics-port"].as<uint16_t>()));
+    } else if (vm.count("metrics-socket")) {
+        server.reset(new metrics_server(metrics, vm["metrics-socket"].as<std::string>()));
+    }
+    if (server) {
+        std::cout << "Serving metrics at " << server->get_endpoint() << std::endl;
+    }
+
+    // Set up AGC, the replay has the AGC states in the trace
+    std::vector<agc_link> agc_links;
+    if (vm.count("agc") && !vm.count("replay")) {
+        agc_links.emplace_back(agc_headroom, agc_hyst, agc_window, fir_ctrl, sr_ctrl);
+        agc_links.back().recorder = recorder.get();
+        agc_links.back().metrics  = &link0_metrics;
+        std::cout << "Using AGC, the shift column of the config is ignored." << std::endl;
+    }
+
+    // Set up AWGN, no noise until configured
+    if (awgn_ctrl) {
+        awgn_ctrl->set_noise_scale(0);
+    }
+
     // show sample rate
     double rate;
+    rate = rx_radio_ctrl->get_rate();
     std::cout << boost::format("Sample Rate: %f Msps...") % (rate / 1e6) << std::endl;
 
+    // set the FIR rate, the DDC/DUC pass through with a rate change of 1
+    if (ddc_ctrl) {
+        ddc_ctrl->set_output_rate(rate / decim, 0);
+        duc_ctrl->set_input_rate(rate / decim, 0);
+        std::cout << boost::format("FIR Rate: %f Msps, delay span %.1f ns...")
+                         % (ddc_ctrl->get_output_rate(0) / 1e6)
+                         % (fir_ctrl->get_max_num_coefficients() * 1e9 / ddc_ctrl->get_output_rate(0))
+                  << std::endl;
+    }
+    const multirate_taps redesigner(decim);
+
     // set the center frequency
     std::cout << boost::format("Setting RX Freq: %f MHz...     ") % (rx_freq / 1e6);
     rx_radio_ctrl->set_rx_frequency(rx_freq, rx_chan);
@@ -258,12 +590,24 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
      * Run The Emulator
      ***********************************************************************/
 
+    // Record the initial state
+    if (recorder) {
+        recorder->record(0, fir_coeffs, bit_shift);
+    }
+
     // Allow for some setup time
     std::this_thread::sleep_for(1s * setup_time);
 
     // Arm SIGINT handler
     std::signal(SIGINT, &sig_int_handler);
 
+    // Watch the radios for overflows, underflows and late commands
+    stream_health_monitor health;
+    health.add_link("link0", sr_ctrl, tx_radio_ctrl, tx_chan);
+    set_stream_limits(health, vm);
+    health.set_metrics(metrics);
+    health.start();
+
     // Start streaming 
     uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
     stream_cmd.stream_now = false;
@@ -279,10 +623,15 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     // Keep running and update channel
     std::string fir;
     std::string bit;
+    std::string last_config;
+    std::vector<double> snr_db;
     std::vector<int16_t> used_coeffs;
 
     // Check if script used
-    if (vm.count("script")) {
+    if (vm.count("replay")) {
+        std::cout << "Using Replay Mode..." << std::endl;
+    }
+    else if (vm.count("script")) {
         use_script = true;
         std::cout << "Using Script Mode..." << std::endl;
     }
@@ -291,7 +640,13 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     }
 
     double elapsed_time = 0.0;
-    if (use_script && is_csv_valid(config_path_script)) {
+    if (vm.count("replay")) {
+        replay_trace(replay_path, timekeeper, link_ids, links, recorder.get(), stop_signal_called);
+        while (not stop_signal_called) {
+            std::this_thread::sleep_for(100ms);
+        }
+    }
+    else if (use_script && is_csv_valid(config_path_script)) {
         config_in.open(config_path_script);
 
         int step = 0;
@@ -304,18 +659,29 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         std::cout << boost::format("Script starts at elapsed time: %.3fs") % (curr_index) << std::endl;
         std::cout << "Press Enter to start..." << std::endl;
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');        
+        const auto script_start = std::chrono::steady_clock::now();
 
         while (not stop_signal_called) {
             if (elapsed_time >= curr_index) {
                 std::cout << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()) << std::endl;
+                step_late_s.observe(std::chrono::duration<double>(
+                                        std::chrono::steady_clock::now() - script_start)
+                                        .count()
+                                    - curr_index);
                 std::getline(config_in, fir, ',');
                 std::getline(config_in, bit);
 
+                snr_db     = snr_parser(bit);
                 fir_coeffs = fir_parser(fir);
                 bit_shift  = static_cast<uint32_t>(std::stoi(bit));
+                redesign_taps(redesigner, fir_ctrl->get_max_num_coefficients(), fir_coeffs, bit_shift);
 
-                fir_ctrl->set_coefficients(fir_coeffs, 0);
-                sr_ctrl->set_shiftright_value(bit_shift);
+                const auto update_start = std::chrono::steady_clock::now();
+                if (awgn_ctrl && !snr_db.empty()) {
+                    awgn_ctrl->set_snr(snr_db[0], sig_pwr);
+                }
+                set_channel(agc_links, 0, fir_ctrl, sr_ctrl, fir_coeffs, bit_shift, recorder.get());
+                link0_metrics.updated(update_start, sr_ctrl->get_shiftright_value());
 
                 // Check if FIR & RS coeffs updated
                 step += 1;
@@ -329,6 +695,10 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
                 std::cout << boost::format("FIR Coeffs:");
                 for (int16_t i: used_coeffs) std::cout << i << ' ';
                 std::cout << std::endl;
+                if (awgn_ctrl) {
+                    std::cout << boost::format("SNR: %.2f dB") % (sig_pwr - awgn_ctrl->get_noise_power())
+                              << std::endl;
+                }
 
                 // Get next config index, keep current config if reach end of script
                 std::getline(config_in, index, ',');
@@ -343,7 +713,7 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
             }
 
             // Update Running Time & Sleep for update period
-            std::this_thread::sleep_for(1000ms * scruni_t);
+            agc_sleep(agc_links, agc_t, scruni_t);
             elapsed_time += scruni_t;
             std::cout << '.' << std::flush;
         }
@@ -360,20 +730,33 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
 
                 std::getline(config_in, fir, ',');
                 std::getline(config_in, bit);
+                config_reloads.inc();
+                const std::string config = fir + ',' + bit;
+                if (config != last_config) {
+                    config_changes.inc();
+                    last_config = config;
+                }
+                snr_db     = snr_parser(bit);
                 fir_coeffs = fir_parser(fir);
                 bit_shift  = static_cast<uint32_t>(std::stoi(bit));
+                redesign_taps(redesigner, fir_ctrl->get_max_num_coefficients(), fir_coeffs, bit_shift);
 
-                fir_ctrl->set_coefficients(fir_coeffs, 0);
-                sr_ctrl->set_shiftright_value(bit_shift);
+                const auto update_start = std::chrono::steady_clock::now();
+                if (awgn_ctrl && !snr_db.empty()) {
+                    awgn_ctrl->set_snr(snr_db[0], sig_pwr);
+                }
+                set_channel(agc_links, 0, fir_ctrl, sr_ctrl, fir_coeffs, bit_shift, recorder.get());
+                link0_metrics.updated(update_start, sr_ctrl->get_shiftright_value());
 
                 config_in.close();
             }
             else {
+                config_errors.inc();
                 std::cout << "Warning: Could not open the config at '" << config_path_manually << "', use default/previous config." << std::endl;
             }
             
             // Update Running Time & Sleep for update period
-            std::this_thread::sleep_for(1000ms * update_t);
+            agc_sleep(agc_links, agc_t, update_t);
             elapsed_time += update_t;
             std::cout << '.' << std::flush;
 
@@ -388,6 +771,10 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
                 std::cout << boost::format("FIR Coeffs:");
                 for (int16_t i: used_coeffs) std::cout << i << ' ';
                 std::cout << std::endl;
+                if (awgn_ctrl) {
+                    std::cout << boost::format("SNR: %.2f dB") % (sig_pwr - awgn_ctrl->get_noise_power())
+                              << std::endl;
+                }
             } 
         }
     }
@@ -398,8 +785,19 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     std::cout << "Issuing stop stream cmd..." << std::endl;
     rx_radio_ctrl->issue_stream_cmd(stream_cmd, rx_chan);
     std::cout << "Done" << std::endl << std::endl;
+    const rfnoc::openairlink::shiftright_ctrl_stats ctrl = sr_ctrl->get_ctrl_stats();
+    std::cout << boost::format("Shiftright control: %d writes (%d skipped, %d bursts), %d reads (%d cached, %d mixed telemetry)")
+                     % ctrl.pokes % ctrl.skipped_pokes % ctrl.bursts % ctrl.peeks
+                     % ctrl.cached_reads % ctrl.mixed_stats
+              << std::endl;
+    if (recorder) {
+        std::cout << boost::format("Recorded %d channel states") % recorder->get_num_records()
+                  << std::endl;
+    }
     // Allow for the samples and ACKs to propagate
     std::this_thread::sleep_for(100ms);
+    health.stop();
+    std::cout << "Stream health:" << std::endl << health.get_summary();
 
-    return EXIT_SUCCESS;
+    return health.tripped() ? EXIT_FAILURE : EXIT_SUCCESS;
 }
@@ -0,0 +1,176 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+// Converts floating point channel taps into a channel script for oal_single.
+// Each input line is "time, gain_db, re0 re1 ...[, im0 im1 ...]" with taps in
+// linear amplitude (1.0 is unity gain). The output lines are "time, taps, shift"
+// followed by "eos", and the achieved SQNR is reported for every step.
+
+#include <rfnoc/openairlink/tap_quantizer.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace po = boost::program_options;
+using rfnoc::openairlink::tap_quantizer;
+
+/****************************************************************************
+ * Parse space separated taps into a row of num_taps values, padded with zeros
+ ***************************************************************************/
+void parse_taps(const std::string& field, const size_t num_taps, double* row)
+{
+    std::istringstream iss(field);
+    size_t n = 0;
+    double value;
+    while (iss >> value) {
+        if (n == num_taps) {
+            throw std::runtime_error("More than " + std::to_string(num_taps) + " taps");
+        }
+        row[n++] = value;
+    }
+    std::fill(row + n, row + num_taps, 0.0);
+}
+
+int main(int argc, char* argv[])
+{
+    std::string in_file, out_file, report_file;
+    size_t num_taps;
+    double input_peak_dbfs;
+
+    // setup the program options
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("in", po::value<std::string>(&in_file)->required(), "Floating point taps CSV, lines are \"time, gain_db, re taps[, im taps]\"")
+        ("out", po::value<std::string>(&out_file), "Channel script CSV to write")
+        ("report", po::value<std::string>(&report_file), "Write the per step report to this CSV instead of the console")
+        ("num-taps", po::value<size_t>(&num_taps)->default_value(41), "Number of FIR taps, shorter channels are padded with zeros")
+        ("input-peak", po::value<double>(&input_peak_dbfs)->default_value(0.0), "Peak I/Q magnitude at the FIR input in dBFS, sets the overflow bound")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("Quantize Taps %s") % desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+
+    std::ifstream in(in_file);
+    if (!in) {
+        std::cerr << "Could not open '" << in_file << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Read all steps into contiguous arrays, so they are quantized in one batch
+    std::vector<std::string> times;
+    std::vector<double> gains_db, taps_re, taps_im;
+    bool complex_taps = false;
+    std::string line;
+    size_t line_num = 0;
+    while (std::getline(in, line)) {
+        line_num++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line.rfind("eos", 0) == 0) {
+            continue;
+        }
+        std::istringstream iss(line);
+        std::string time, gain, re, im;
+        std::getline(iss, time, ',');
+        std::getline(iss, gain, ',');
+        std::getline(iss, re, ',');
+        std::getline(iss, im, ',');
+        try {
+            times.push_back(time);
+            gains_db.push_back(std::stod(gain));
+            taps_re.resize(taps_re.size() + num_taps);
+            taps_im.resize(taps_im.size() + num_taps);
+            parse_taps(re, num_taps, &taps_re[taps_re.size() - num_taps]);
+            parse_taps(im, num_taps, &taps_im[taps_im.size() - num_taps]);
+            complex_taps |= (im.find_first_not_of(" \t\r") != std::string::npos);
+        } catch (const std::exception& ex) {
+            std::cerr << boost::format("Line %d: %s") % line_num % ex.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    const size_t num_steps = times.size();
+
+    std::vector<int16_t> coeffs(num_steps * num_taps);
+    std::vector<uint32_t> shifts(num_steps);
+    std::vector<double> sqnr_db(num_steps), gain_loss_db(num_steps), real_loss_db(num_steps);
+    tap_quantizer quantizer(num_taps, input_peak_dbfs);
+    const auto start = std::chrono::steady_clock::now();
+    quantizer.quantize(taps_re.data(),
+        complex_taps ? taps_im.data() : nullptr,
+        gains_db.data(),
+        num_steps,
+        coeffs.data(),
+        shifts.data(),
+        sqnr_db.data(),
+        gain_loss_db.data(),
+        real_loss_db.data());
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (vm.count("out")) {
+        std::ofstream out(out_file);
+        for (size_t step = 0; step < num_steps; step++) {
+            out << times[step] << ',';
+            for (size_t n = 0; n < num_taps; n++) {
+                out << ' ' << coeffs[step * num_taps + n];
+            }
+            out << ", " << shifts[step] << '\n';
+        }
+        out << "eos";
+    }
+
+    std::ofstream report;
+    if (vm.count("report")) {
+        report.open(report_file);
+    }
+    std::ostream& rep = vm.count("report") ? report : std::cout;
+    rep << "time, shift, sqnr_db, gain_loss_db" << (complex_taps ? ", real_loss_db" : "") << '\n';
+    double min_sqnr = sqnr_db.empty() ? 0.0 : sqnr_db[0];
+    size_t num_reduced = 0;
+    for (size_t step = 0; step < num_steps; step++) {
+        rep << boost::format("%s, %d, %.2f, %.2f") % times[step] % shifts[step] % sqnr_db[step]
+                   % gain_loss_db[step];
+        if (complex_taps) {
+            rep << boost::format(", %.2f") % real_loss_db[step];
+        }
+        rep << '\n';
+        min_sqnr = std::min(min_sqnr, sqnr_db[step]);
+        num_reduced += (gain_loss_db[step] > 0.0) ? 1 : 0;
+    }
+    rep.flush();
+
+    std::cout << boost::format("Quantized %d steps in %.3f s, lowest SQNR %.2f dB")
+                     % num_steps % elapsed.count() % min_sqnr
+              << std::endl;
+    if (num_reduced) {
+        std::cout << boost::format("%d steps exceed the FIR bounds and use a reduced gain")
+                         % num_reduced
+                  << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+// Prints a binary channel trace recorded with --record of oal_single or
+// oal_dual as CSV, and checks that every recorded readback matches the
+// written state.
+
+#include <rfnoc/openairlink/channel_trace.hpp>
+#include <uhd/exception.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <cstdlib>
+#include <iostream>
+
+namespace po = boost::program_options;
+using rfnoc::openairlink::channel_record;
+using rfnoc::openairlink::channel_trace_reader;
+
+int main(int argc, char* argv[])
+{
+    std::string trace_file;
+
+    // setup the program options
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("trace", po::value<std::string>(&trace_file)->required(), "Channel trace file")
+        ("no-taps", "Leave out the taps")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("Channel Trace Dump %s") % desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+
+    try {
+        channel_trace_reader trace(trace_file);
+        std::cout << boost::format("# tick rate %.0f Hz") % trace.get_tick_rate() << std::endl;
+        for (size_t i = 0; i < trace.get_links().size(); i++) {
+            std::cout << boost::format("# link %d: %s, %s") % i % trace.get_links()[i].fir_id
+                             % trace.get_links()[i].shiftright_id
+                      << std::endl;
+        }
+        std::cout << "device_s, host_s, link, shift, noise_scale, readback"
+                  << (vm.count("no-taps") ? "" : ", taps") << std::endl;
+
+        channel_record record;
+        size_t num_records = 0, mismatches = 0;
+        while (trace.read(record)) {
+            const bool ok = record.readback_ok();
+            std::cout << boost::format("%.9f, %.6f, %d, %d, %s, %s")
+                             % (record.device_ticks / trace.get_tick_rate())
+                             % (record.host_ns * 1e-9) % record.link % record.shiftright
+                             % (record.noise_scale == channel_record::NO_NOISE_SCALE
+                                       ? std::string("-")
+                                       : std::to_string(record.noise_scale))
+                             % (ok ? "ok" : "mismatch");
+            if (!vm.count("no-taps")) {
+                std::cout << ',';
+                for (const int16_t tap : record.coeffs) {
+                    std::cout << ' ' << tap;
+                }
+            }
+            std::cout << std::endl;
+            num_records++;
+            mismatches += ok ? 0 : 1;
+        }
+        std::cout << boost::format("# %d records, %d readback mismatches") % num_records
+                         % mismatches
+                  << std::endl;
+        return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+    } catch (const uhd::runtime_error& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
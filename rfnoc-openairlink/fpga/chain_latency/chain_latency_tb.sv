@@ -0,0 +1,388 @@
+//
+// Copyright 2024 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+//
+// Module: chain_latency_tb
+//
+// Description:
+//
+//   Measures the input to output latency of the radio -> FIR -> Shiftright ->
+//   (AWGN) -> radio chain of the image cores, for each spp and for each build
+//   variant of the Shiftright block (LOW_LATENCY and FIFO_SIZE), with and
+//   without the AWGN block of x310_awgn_rfnoc_image_core.yml.
+//
+//   Each variant gets its own chain of the UHD FIR filter block, the
+//   Shiftright block and optionally the AWGN block, and all chains see the
+//   same stream. The RX radio is
+//   modeled at its CHDR output: it takes one sample every SAMP_PER and sends
+//   a packet once the last of its spp samples is in. The latency of a sample
+//   is the time from its sampling to the CHDR transfer of the sample at the
+//   chain output. The TX radio plays the samples at the same constant
+//   rate, so the radio to radio latency of the chain is the largest sample
+//   latency, and it includes the packetization of spp samples.
+//
+//   Not modeled are the pipelines inside the radios, the DDC and DUC (which
+//   pass through with a rate change of 1) and the group delay of the FIR taps ((N-1)/2 samples for N linear phase taps).
+//
+
+`default_nettype none
+
+
+module chain_latency_tb;
+
+  `include "test_exec.svh"
+
+  import PkgTestExec::*;
+  import PkgChdrUtils::*;
+  import PkgRfnocBlockCtrlBfm::*;
+
+  //---------------------------------------------------------------------------
+  // Testbench Configuration
+  //---------------------------------------------------------------------------
+
+  localparam int    CHDR_W       = 64;     // CHDR size in bits
+  localparam int    MTU          = 10;     // Log2 of max transmission unit in CHDR words
+  localparam int    ITEM_W       = 32;     // Sample size in bits
+  localparam int    NUM_PKTS     = 32;     // Packets per measurement
+  localparam real   CHDR_CLK_PER = 5.333;  // 187.5 MHz, X310 bus_clk
+  localparam real   CTRL_CLK_PER = 8.0;    // 125 MHz
+  localparam real   CE_CLK_PER   = 4.667;  // 214.286 MHz, X310 ce_clk
+  localparam real   SAMP_PER     = 5.0;    // 200 MS/s, X310 radio rate
+
+  // Samples per packet to measure
+  localparam int    NUM_SPP                = 5;
+  localparam int    SPP_LIST [NUM_SPP]     = '{16, 32, 64, 128, 256};
+
+  // Chain variants, one chain each: the default Shiftright, the combinational
+  // shift, the smallest FIFOs and both, then the default and the low-latency
+  // Shiftright followed by the AWGN block.
+  localparam int    NUM_CFG                   = 6;
+  localparam int    LOW_LATENCY_CFG [NUM_CFG] = '{0, 1, 0, 1, 0, 1};
+  localparam int    FIFO_SIZE_CFG   [NUM_CFG] = '{5, 5, 1, 1, 5, 1};
+  localparam int    AWGN_CFG        [NUM_CFG] = '{0, 0, 0, 0, 1, 1};
+
+  //---------------------------------------------------------------------------
+  // Clocks
+  //---------------------------------------------------------------------------
+
+  bit rfnoc_chdr_clk;
+  bit rfnoc_ctrl_clk;
+  bit ce_clk;
+
+  sim_clock_gen #(CHDR_CLK_PER) rfnoc_chdr_clk_gen (.clk(rfnoc_chdr_clk), .rst());
+  sim_clock_gen #(CTRL_CLK_PER) rfnoc_ctrl_clk_gen (.clk(rfnoc_ctrl_clk), .rst());
+  sim_clock_gen #(CE_CLK_PER) ce_clk_gen (.clk(ce_clk), .rst());
+
+  //---------------------------------------------------------------------------
+  // Measurement Control and Results
+  //---------------------------------------------------------------------------
+
+  int  run_spp   = 0;  // spp of the current measurement
+  int  run_id    = 0;  // Incremented to start a measurement on all chains
+  int  num_done  = 0;  // Chains done with the current measurement
+  bit  chain_ready [NUM_CFG];
+
+  realtime lat_min    [NUM_CFG];  // Smallest sample latency
+  realtime lat_max    [NUM_CFG];  // Largest sample latency
+  int      recv_samps [NUM_CFG];  // Samples received
+  int      recv_errs  [NUM_CFG];  // Malformed output packets
+
+  //---------------------------------------------------------------------------
+  // Chains
+  //---------------------------------------------------------------------------
+
+  for (genvar c = 0; c < NUM_CFG; c++) begin : gen_chain
+
+    // Backend and control BFMs, only used to flush and reset the blocks
+    RfnocBackendIf fir_backend (rfnoc_chdr_clk, rfnoc_ctrl_clk);
+    RfnocBackendIf sr_backend  (rfnoc_chdr_clk, rfnoc_ctrl_clk);
+    RfnocBackendIf awgn_backend(rfnoc_chdr_clk, rfnoc_ctrl_clk);
+    AxiStreamIf #(32) fir_m_ctrl (rfnoc_ctrl_clk, 1'b0);
+    AxiStreamIf #(32) fir_s_ctrl (rfnoc_ctrl_clk, 1'b0);
+    AxiStreamIf #(32) sr_m_ctrl  (rfnoc_ctrl_clk, 1'b0);
+    AxiStreamIf #(32) sr_s_ctrl  (rfnoc_ctrl_clk, 1'b0);
+    AxiStreamIf #(32) awgn_m_ctrl(rfnoc_ctrl_clk, 1'b0);
+    AxiStreamIf #(32) awgn_s_ctrl(rfnoc_ctrl_clk, 1'b0);
+
+    RfnocBlockCtrlBfm #(CHDR_W, ITEM_W) fir_ctrl = new(fir_backend, fir_m_ctrl, fir_s_ctrl);
+    RfnocBlockCtrlBfm #(CHDR_W, ITEM_W) sr_ctrl  = new(sr_backend, sr_m_ctrl, sr_s_ctrl);
+    RfnocBlockCtrlBfm #(CHDR_W, ITEM_W) awgn_ctrl = new(awgn_backend, awgn_m_ctrl, awgn_s_ctrl);
+
+    // RX radio model -> FIR
+    logic [CHDR_W-1:0] src_tdata  = '0;
+    logic              src_tlast  = 1'b0;
+    logic              src_tvalid = 1'b0;
+    logic              src_tready;
+
+    // FIR -> Shiftright
+    logic [CHDR_W-1:0] fir_tdata;
+    logic              fir_tlast, fir_tvalid, fir_tready;
+
+    // Shiftright -> AWGN
+    logic [CHDR_W-1:0] sr_tdata;
+    logic              sr_tlast, sr_tvalid, sr_tready;
+
+    // Chain output -> TX radio model, which always accepts
+    logic [CHDR_W-1:0] snk_tdata;
+    logic              snk_tlast, snk_tvalid;
+    logic              snk_tready = 1'b1;
+
+    // The FIR with the parameters of the image cores (block defaults)
+    rfnoc_block_fir_filter #(
+      .THIS_PORTID         (10'd1),
+      .CHDR_W              (CHDR_W),
+      .NUM_PORTS           (1),
+      .MTU                 (MTU)
+    ) fir_i (
+      .rfnoc_chdr_clk      (rfnoc_chdr_clk),
+      .rfnoc_ctrl_clk      (rfnoc_ctrl_clk),
+      .ce_clk              (ce_clk),
+      .rfnoc_core_config   (fir_backend.cfg),
+      .rfnoc_core_status   (fir_backend.sts),
+      .s_rfnoc_chdr_tdata  (src_tdata),
+      .s_rfnoc_chdr_tlast  (src_tlast),
+      .s_rfnoc_chdr_tvalid (src_tvalid),
+      .s_rfnoc_chdr_tready (src_tready),
+      .m_rfnoc_chdr_tdata  (fir_tdata),
+      .m_rfnoc_chdr_tlast  (fir_tlast),
+      .m_rfnoc_chdr_tvalid (fir_tvalid),
+      .m_rfnoc_chdr_tready (fir_tready),
+      .s_rfnoc_ctrl_tdata  (fir_m_ctrl.tdata),
+      .s_rfnoc_ctrl_tlast  (fir_m_ctrl.tlast),
+      .s_rfnoc_ctrl_tvalid (fir_m_ctrl.tvalid),
+      .s_rfnoc_ctrl_tready (fir_m_ctrl.tready),
+      .m_rfnoc_ctrl_tdata  (fir_s_ctrl.tdata),
+      .m_rfnoc_ctrl_tlast  (fir_s_ctrl.tlast),
+      .m_rfnoc_ctrl_tvalid (fir_s_ctrl.tvalid),
+      .m_rfnoc_ctrl_tready (fir_s_ctrl.tready)
+    );
+
+    rfnoc_block_shiftright #(
+      .THIS_PORTID         (10'd2),
+      .CHDR_W              (CHDR_W),
+      .MTU                 (MTU),
+      .LOW_LATENCY         (LOW_LATENCY_CFG[c]),
+      .FIFO_SIZE           (FIFO_SIZE_CFG[c])
+    ) shiftright_i (
+      .rfnoc_chdr_clk      (rfnoc_chdr_clk),
+      .rfnoc_ctrl_clk      (rfnoc_ctrl_clk),
+      .ce_clk              (ce_clk),
+      .rfnoc_core_config   (sr_backend.cfg),
+      .rfnoc_core_status   (sr_backend.sts),
+      .s_rfnoc_chdr_tdata  (fir_tdata),
+      .s_rfnoc_chdr_tlast  (fir_tlast),
+      .s_rfnoc_chdr_tvalid (fir_tvalid),
+      .s_rfnoc_chdr_tready (fir_tready),
+      .m_rfnoc_chdr_tdata  (sr_tdata),
+      .m_rfnoc_chdr_tlast  (sr_tlast),
+      .m_rfnoc_chdr_tvalid (sr_tvalid),
+      .m_rfnoc_chdr_tready (sr_tready),
+      .s_rfnoc_ctrl_tdata  (sr_m_ctrl.tdata),
+      .s_rfnoc_ctrl_tlast  (sr_m_ctrl.tlast),
+      .s_rfnoc_ctrl_tvalid (sr_m_ctrl.tvalid),
+      .s_rfnoc_ctrl_tready (sr_m_ctrl.tready),
+      .m_rfnoc_ctrl_tdata  (sr_s_ctrl.tdata),
+      .m_rfnoc_ctrl_tlast  (sr_s_ctrl.tlast),
+      .m_rfnoc_ctrl_tvalid (sr_s_ctrl.tvalid),
+      .m_rfnoc_ctrl_tready (sr_s_ctrl.tready)
+    );
+
+    // The AWGN block with its reset state (noise off), which adds its
+    // pipeline to the chain like in x310_awgn_rfnoc_image_core.yml
+    if (AWGN_CFG[c]) begin : gen_awgn
+      rfnoc_block_awgn #(
+        .THIS_PORTID         (10'd3),
+        .CHDR_W              (CHDR_W),
+        .MTU                 (MTU)
+      ) awgn_i (
+        .rfnoc_chdr_clk      (rfnoc_chdr_clk),
+        .rfnoc_ctrl_clk      (rfnoc_ctrl_clk),
+        .ce_clk              (ce_clk),
+        .rfnoc_core_config   (awgn_backend.cfg),
+        .rfnoc_core_status   (awgn_backend.sts),
+        .s_rfnoc_chdr_tdata  (sr_tdata),
+        .s_rfnoc_chdr_tlast  (sr_tlast),
+        .s_rfnoc_chdr_tvalid (sr_tvalid),
+        .s_rfnoc_chdr_tready (sr_tready),
+        .m_rfnoc_chdr_tdata  (snk_tdata),
+        .m_rfnoc_chdr_tlast  (snk_tlast),
+        .m_rfnoc_chdr_tvalid (snk_tvalid),
+        .m_rfnoc_chdr_tready (snk_tready),
+        .s_rfnoc_ctrl_tdata  (awgn_m_ctrl.tdata),
+        .s_rfnoc_ctrl_tlast  (awgn_m_ctrl.tlast),
+        .s_rfnoc_ctrl_tvalid (awgn_m_ctrl.tvalid),
+        .s_rfnoc_ctrl_tready (awgn_m_ctrl.tready),
+        .m_rfnoc_ctrl_tdata  (awgn_s_ctrl.tdata),
+        .m_rfnoc_ctrl_tlast  (awgn_s_ctrl.tlast),
+        .m_rfnoc_ctrl_tvalid (awgn_s_ctrl.tvalid),
+        .m_rfnoc_ctrl_tready (awgn_s_ctrl.tready)
+      );
+    end else begin : gen_no_awgn
+      assign snk_tdata  = sr_tdata;
+      assign snk_tlast  = sr_tlast;
+      assign snk_tvalid = sr_tvalid;
+      assign sr_tready  = snk_tready;
+    end
+
+    // RX radio model: sample k is taken at t0 + k*SAMP_PER, a packet is sent
+    // at the first clock edge after its last sample. The samples hold their
+    // index, the FIR output is not checked.
+    task automatic send_stream(input int spp, input realtime t0);
+      chdr_header_t      hdr;
+      logic [CHDR_W-1:0] hdr_word;
+      for (int p = 0; p < NUM_PKTS; p++) begin
+        while ($realtime < t0 + (p*spp + spp - 1) * SAMP_PER) begin
+          @(posedge rfnoc_chdr_clk);
+        end
+        hdr = '{pkt_type: CHDR_DATA_NO_TS, seq_num: p, length: CHDR_W/8 + spp*ITEM_W/8,
+                default: 0};
+        hdr_word = hdr;
+        for (int w = 0; w <= spp/2; w++) begin
+          src_tdata  <= (w == 0) ? hdr_word :
+                        { ITEM_W'(p*spp + 2*w - 1), ITEM_W'(p*spp + 2*w - 2) };
+          src_tlast  <= (w == spp/2);
+          src_tvalid <= 1'b1;
+          do begin
+            @(posedge rfnoc_chdr_clk);
+          end while (!src_tready);
+        end
+        src_tvalid <= 1'b0;
+      end
+    endtask
+
+    // TX radio model: takes the latency of every sample at its transfer
+    task automatic recv_stream(input int spp, input realtime t0);
+      chdr_header_t hdr;
+      int      k = 0;
+      int      pkt_samps;
+      bit      first;
+      realtime lat;
+      for (int p = 0; p < NUM_PKTS; p++) begin
+        first = 1'b1;
+        forever begin
+          @(posedge rfnoc_chdr_clk);
+          if (!snk_tvalid) continue;
+          if (first) begin
+            hdr       = snk_tdata;
+            pkt_samps = (hdr.length - CHDR_W/8) / (ITEM_W/8);
+            if (hdr.num_mdata != 0 || pkt_samps != spp) recv_errs[c]++;
+            first     = 1'b0;
+          end else begin
+            for (int j = 0; j < CHDR_W/ITEM_W && pkt_samps > 0; j++, pkt_samps--) begin
+              lat        = $realtime - (t0 + k * SAMP_PER);
+              lat_min[c] = (lat < lat_min[c]) ? lat : lat_min[c];
+              lat_max[c] = (lat > lat_max[c]) ? lat : lat_max[c];
+              k++;
+            end
+          end
+          if (snk_tlast) break;
+        end
+      end
+      recv_samps[c] = k;
+    endtask
+
+    initial begin : chain_main
+      int      last_id = 0;
+      realtime t0;
+
+      fir_ctrl.run();
+      sr_ctrl.run();
+      fir_ctrl.flush_and_reset();
+      sr_ctrl.flush_and_reset();
+      if (AWGN_CFG[c]) begin
+        awgn_ctrl.run();
+        awgn_ctrl.flush_and_reset();
+      end
+      chain_ready[c] = 1'b1;
+
+      forever begin
+        wait (run_id != last_id);
+        last_id       = run_id;
+        lat_min[c]    = 1.0e12;
+        lat_max[c]    = 0.0;
+        recv_samps[c] = 0;
+        recv_errs[c]  = 0;
+        @(posedge rfnoc_chdr_clk);
+        t0 = $realtime;
+        fork
+          send_stream(run_spp, t0);
+          recv_stream(run_spp, t0);
+        join
+        num_done++;
+      end
+    end
+
+  end : gen_chain
+
+  //---------------------------------------------------------------------------
+  // Main Test Process
+  //---------------------------------------------------------------------------
+
+  initial begin : tb_main
+
+    // Initialize the test exec object for this testbench
+    test.start_tb("chain_latency_tb");
+
+    //--------------------------------
+    // Reset
+    //--------------------------------
+
+    test.start_test("Flush and reset the blocks", 50us);
+    for (int c = 0; c < NUM_CFG; c++) begin
+      wait (chain_ready[c]);
+    end
+    test.end_test();
+
+    //--------------------------------
+    // Latency per spp and variant
+    //--------------------------------
+
+    $display("");
+    $display("   spp  LOW_LATENCY  FIFO_SIZE  AWGN     min [ce cycles]     max [ce cycles]   min [samples]   max [samples]");
+    for (int i = 0; i < NUM_SPP; i++) begin
+      test.start_test($sformatf("Measure latency with spp %0d", SPP_LIST[i]), 2ms);
+      run_spp  = SPP_LIST[i];
+      num_done = 0;
+      run_id++;
+      wait (num_done == NUM_CFG);
+
+      for (int c = 0; c < NUM_CFG; c++) begin
+        $display("  %4d  %11d  %9d  %4d  %18.1f  %18.1f  %14.1f  %14.1f",
+          SPP_LIST[i], LOW_LATENCY_CFG[c], FIFO_SIZE_CFG[c], AWGN_CFG[c],
+          lat_min[c] / CE_CLK_PER, lat_max[c] / CE_CLK_PER,
+          lat_min[c] / SAMP_PER, lat_max[c] / SAMP_PER);
+        `ASSERT_ERROR(recv_samps[c] == NUM_PKTS * SPP_LIST[i],
+          $sformatf("Chain %0d received %0d samples, expected %0d",
+                    c, recv_samps[c], NUM_PKTS * SPP_LIST[i]));
+        `ASSERT_ERROR(recv_errs[c] == 0,
+          $sformatf("Chain %0d received %0d malformed packets", c, recv_errs[c]));
+      end
+
+      // The low-latency shift is never slower than the pipelined one with
+      // the same FIFOs and the same AWGN stage
+      for (int c = 0; c < NUM_CFG; c++) begin
+        for (int d = 0; d < NUM_CFG; d++) begin
+          if (LOW_LATENCY_CFG[c] && !LOW_LATENCY_CFG[d] && FIFO_SIZE_CFG[c] == FIFO_SIZE_CFG[d] &&
+              AWGN_CFG[c] == AWGN_CFG[d]) begin
+            `ASSERT_ERROR(lat_max[c] <= lat_max[d],
+              $sformatf("Low-latency chain %0d is slower than chain %0d", c, d));
+          end
+        end
+      end
+      test.end_test();
+    end
+    $display("");
+
+    //--------------------------------
+    // Finish Up
+    //--------------------------------
+
+    // Display final statistics and results
+    test.end_tb();
+  end : tb_main
+
+endmodule : chain_latency_tb
+
+
+`default_nettype wire
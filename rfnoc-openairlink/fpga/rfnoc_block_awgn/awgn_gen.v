@@ -0,0 +1,122 @@
+//
+// Copyright 2024 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+//
+// Module: awgn_gen
+//
+// Description:
+//
+//   Gaussian noise generator for the AWGN block. Twelve xorshift LFSRs (32
+//   bit state each) produce 24 uniform 16-bit values per step. Summing twelve
+//   of them per component (central limit theorem) gives an approximately
+//   Gaussian value with standard deviation 2^16, which is then scaled by
+//   the noise_scale input:
+//
+//     noise = (g * noise_scale + 2^(SCALE_SHIFT-1)) >>> SCALE_SHIFT
+//
+//   With SCALE_SHIFT = 18 the standard deviation of each noise component is
+//   noise_scale/4 LSBs.
+//
+//   The generator only advances when en is asserted, so the n-th noise value
+//   after a seed load is deterministic and can be reproduced bit-exactly by
+//   the host model (rfnoc::openairlink::awgn_model). The pipeline is three
+//   steps deep and loaded with zero noise on seed, i.e., the first three
+//   values after a seed load are zero.
+//
+// Parameters:
+//
+//   SCALE_SHIFT : Right shift applied after multiplying with noise_scale
+//
+
+`default_nettype none
+
+
+module awgn_gen #(
+  parameter SCALE_SHIFT = 18
+)(
+  input  wire               clk,
+  input  wire               rst,
+  input  wire [31:0]        seed,
+  input  wire               seed_stb,
+  input  wire [15:0]        noise_scale,
+  input  wire               en,
+  output reg  signed [19:0] noise_i,
+  output reg  signed [19:0] noise_q
+);
+
+  localparam NUM_URNG    = 12;
+  localparam SEED_MIX    = 32'h9E3779B9;
+  // Mean of twelve uniform values in [0, 65535]
+  localparam CLT_OFFSET  = 20'sd393210;
+  // Partial sums are loaded with a third of the offset each, so that a freshly
+  // seeded pipeline yields zero noise.
+  localparam PSUM_INIT   = 18'd131070;
+
+  reg  [31:0] state [0:NUM_URNG-1];
+  reg  [17:0] psum_i [0:2];
+  reg  [17:0] psum_q [0:2];
+  reg  signed [19:0] g_i, g_q;
+
+  //---------------------------------------------------------------------------
+  // Uniform Generators
+  //---------------------------------------------------------------------------
+
+  genvar k;
+  generate
+    for (k = 0; k < NUM_URNG; k = k + 1) begin : gen_urng
+      wire [31:0] seed_mixed = seed ^ (SEED_MIX * (k+1));
+      wire [31:0] x0 = state[k];
+      wire [31:0] x1 = x0 ^ (x0 << 13);
+      wire [31:0] x2 = x1 ^ (x1 >> 17);
+      wire [31:0] x3 = x2 ^ (x2 << 5);
+
+      always @(posedge clk) begin
+        if (rst || seed_stb) begin
+          // All-zero is the only invalid xorshift state
+          state[k] <= (seed_mixed == 32'd0) ? 32'd1 : seed_mixed;
+        end else if (en) begin
+          state[k] <= x3;
+        end
+      end
+    end
+  endgenerate
+
+  //---------------------------------------------------------------------------
+  // CLT Summation and Scaling
+  //---------------------------------------------------------------------------
+
+  wire signed [36:0] prod_i = g_i * $signed({1'b0, noise_scale});
+  wire signed [36:0] prod_q = g_q * $signed({1'b0, noise_scale});
+  wire signed [36:0] prod_i_rnd = prod_i + (37'sd1 <<< (SCALE_SHIFT-1));
+  wire signed [36:0] prod_q_rnd = prod_q + (37'sd1 <<< (SCALE_SHIFT-1));
+
+  integer j;
+  always @(posedge clk) begin
+    if (rst || seed_stb) begin
+      for (j = 0; j < 3; j = j + 1) begin
+        psum_i[j] <= PSUM_INIT;
+        psum_q[j] <= PSUM_INIT;
+      end
+      g_i     <= 20'sd0;
+      g_q     <= 20'sd0;
+      noise_i <= 20'sd0;
+      noise_q <= 20'sd0;
+    end else if (en) begin
+      for (j = 0; j < 3; j = j + 1) begin
+        psum_i[j] <= state[4*j][31:16] + state[4*j+1][31:16]
+                   + state[4*j+2][31:16] + state[4*j+3][31:16];
+        psum_q[j] <= state[4*j][15:0] + state[4*j+1][15:0]
+                   + state[4*j+2][15:0] + state[4*j+3][15:0];
+      end
+      g_i     <= $signed({2'b0, psum_i[0]} + psum_i[1] + psum_i[2]) - CLT_OFFSET;
+      g_q     <= $signed({2'b0, psum_q[0]} + psum_q[1] + psum_q[2]) - CLT_OFFSET;
+      noise_i <= prod_i_rnd >>> SCALE_SHIFT;
+      noise_q <= prod_q_rnd >>> SCALE_SHIFT;
+    end
+  end
+
+endmodule // awgn_gen
+
+
+`default_nettype wire
@@ -0,0 +1,421 @@
+//
+// Copyright 2024 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+//
+// Module: rfnoc_block_awgn_tb
+//
+// Description: Testbench for the awgn RFNoC block.
+//
+
+`default_nettype none
+
+
+module rfnoc_block_awgn_tb;
+
+  `include "test_exec.svh"
+
+  import PkgTestExec::*;
+  import PkgChdrUtils::*;
+  import PkgRfnocBlockCtrlBfm::*;
+  import PkgRfnocItemUtils::*;
+
+  //---------------------------------------------------------------------------
+  // Testbench Configuration
+  //---------------------------------------------------------------------------
+
+  localparam [31:0] NOC_ID          = 32'h0002D025;
+  localparam [ 9:0] THIS_PORTID     = 10'h123;
+  localparam int    CHDR_W          = 64;    // CHDR size in bits
+  localparam int    MTU             = 10;    // Log2 of max transmission unit in CHDR words
+  localparam int    NUM_PORTS       = 1;     // Number of CHDR data ports
+  localparam int    NUM_PORTS_I     = 1;
+  localparam int    NUM_PORTS_O     = 1;
+  localparam int    ITEM_W          = 32;    // Sample size in bits
+  localparam int    SPP             = 64;    // Samples per packet
+  localparam int    PKT_SIZE_BYTES  = SPP * (ITEM_W/8);
+  localparam int    STALL_PROB      = 25;    // Default BFM stall probability
+  localparam real   CHDR_CLK_PER    = 5.0;   // 200 MHz
+  localparam real   CTRL_CLK_PER    = 8.0;   // 125 MHz
+  localparam real   CE_CLK_PER      = 4.0;   // 250 MHz
+
+  //---------------------------------------------------------------------------
+  // Clocks and Resets
+  //---------------------------------------------------------------------------
+
+  bit rfnoc_chdr_clk;
+  bit rfnoc_ctrl_clk;
+  bit ce_clk;
+
+  sim_clock_gen #(CHDR_CLK_PER) rfnoc_chdr_clk_gen (.clk(rfnoc_chdr_clk), .rst());
+  sim_clock_gen #(CTRL_CLK_PER) rfnoc_ctrl_clk_gen (.clk(rfnoc_ctrl_clk), .rst());
+  sim_clock_gen #(CE_CLK_PER) ce_clk_gen (.clk(ce_clk), .rst());
+
+  //---------------------------------------------------------------------------
+  // Bus Functional Models
+  //---------------------------------------------------------------------------
+
+  // Backend Interface
+  RfnocBackendIf backend (rfnoc_chdr_clk, rfnoc_ctrl_clk);
+
+  // AXIS-Ctrl Interface
+  AxiStreamIf #(32) m_ctrl (rfnoc_ctrl_clk, 1'b0);
+  AxiStreamIf #(32) s_ctrl (rfnoc_ctrl_clk, 1'b0);
+
+  // AXIS-CHDR Interfaces
+  AxiStreamIf #(CHDR_W) m_chdr [NUM_PORTS_I] (rfnoc_chdr_clk, 1'b0);
+  AxiStreamIf #(CHDR_W) s_chdr [NUM_PORTS_O] (rfnoc_chdr_clk, 1'b0);
+
+  // Block Controller BFM
+  RfnocBlockCtrlBfm #(CHDR_W, ITEM_W) blk_ctrl = new(backend, m_ctrl, s_ctrl);
+
+  // CHDR word and item/sample data types
+  typedef ChdrData #(CHDR_W, ITEM_W)::chdr_word_t chdr_word_t;
+  typedef ChdrData #(CHDR_W, ITEM_W)::item_t      item_t;
+
+  // Connect block controller to BFMs
+  for (genvar i = 0; i < NUM_PORTS_I; i++) begin : gen_bfm_input_connections
+    initial begin
+      blk_ctrl.connect_master_data_port(i, m_chdr[i], PKT_SIZE_BYTES);
+      blk_ctrl.set_master_stall_prob(i, STALL_PROB);
+    end
+  end
+  for (genvar i = 0; i < NUM_PORTS_O; i++) begin : gen_bfm_output_connections
+    initial begin
+      blk_ctrl.connect_slave_data_port(i, s_chdr[i]);
+      blk_ctrl.set_slave_stall_prob(i, STALL_PROB);
+    end
+  end
+
+  //---------------------------------------------------------------------------
+  // Reference Model
+  //---------------------------------------------------------------------------
+  //
+  // Bit-exact model of awgn_gen and the saturating adder. Must match
+  // rfnoc::openairlink::awgn_model on the host.
+  //
+  //---------------------------------------------------------------------------
+
+  class AwgnModel;
+    bit [31:0]          state [12];
+    bit [17:0]          psum_i [3];
+    bit [17:0]          psum_q [3];
+    logic signed [19:0] g_i, g_q, n_i, n_q;
+    bit [15:0]          scale;
+
+    function new(bit [31:0] seed, bit [15:0] noise_scale);
+      scale = noise_scale;
+      reseed(seed);
+    endfunction
+
+    function void reseed(bit [31:0] seed);
+      for (int k = 0; k < 12; k++) begin
+        bit [31:0] s;
+        s = seed ^ (32'h9E3779B9 * (k+1));
+        state[k] = (s == 0) ? 32'd1 : s;
+      end
+      for (int j = 0; j < 3; j++) begin
+        psum_i[j] = 18'd131070;
+        psum_q[j] = 18'd131070;
+      end
+      g_i = 0; g_q = 0;
+      n_i = 0; n_q = 0;
+    endfunction
+
+    function void step();
+      logic signed [36:0] prod_i, prod_q;
+      // Update in reverse pipeline order, so every stage sees the old value
+      // of its predecessor like the registers do.
+      prod_i = g_i * $signed({1'b0, scale});
+      prod_q = g_q * $signed({1'b0, scale});
+      n_i = (prod_i + (37'sd1 <<< 17)) >>> 18;
+      n_q = (prod_q + (37'sd1 <<< 17)) >>> 18;
+      g_i = $signed({2'b0, psum_i[0]} + psum_i[1] + psum_i[2]) - 20'sd393210;
+      g_q = $signed({2'b0, psum_q[0]} + psum_q[1] + psum_q[2]) - 20'sd393210;
+      for (int j = 0; j < 3; j++) begin
+        psum_i[j] = state[4*j][31:16] + state[4*j+1][31:16]
+                  + state[4*j+2][31:16] + state[4*j+3][31:16];
+        psum_q[j] = state[4*j][15:0] + state[4*j+1][15:0]
+                  + state[4*j+2][15:0] + state[4*j+3][15:0];
+      end
+      for (int k = 0; k < 12; k++) begin
+        bit [31:0] x;
+        x = state[k];
+        x = x ^ (x << 13);
+        x = x ^ (x >> 17);
+        x = x ^ (x << 5);
+        state[k] = x;
+      end
+    endfunction
+
+    function bit [31:0] process(bit [31:0] sample);
+      logic signed [15:0] i_samp, q_samp;
+      logic signed [20:0] i_sum, q_sum;
+      logic signed [15:0] i_sat, q_sat;
+      i_samp = sample[31:16];
+      q_samp = sample[15:0];
+      i_sum  = i_samp + n_i;
+      q_sum  = q_samp + n_q;
+      i_sat  = (i_sum > 32767) ? 16'sh7FFF : (i_sum < -32768) ? 16'sh8000 : i_sum[15:0];
+      q_sat  = (q_sum > 32767) ? 16'sh7FFF : (q_sum < -32768) ? 16'sh8000 : q_sum[15:0];
+      step();
+      return {i_sat, q_sat};
+    endfunction
+  endclass
+
+  //---------------------------------------------------------------------------
+  // Device Under Test (DUT)
+  //---------------------------------------------------------------------------
+
+  // DUT Slave (Input) Port Signals
+  logic [CHDR_W*NUM_PORTS_I-1:0] s_rfnoc_chdr_tdata;
+  logic [       NUM_PORTS_I-1:0] s_rfnoc_chdr_tlast;
+  logic [       NUM_PORTS_I-1:0] s_rfnoc_chdr_tvalid;
+  logic [       NUM_PORTS_I-1:0] s_rfnoc_chdr_tready;
+
+  // DUT Master (Output) Port Signals
+  logic [CHDR_W*NUM_PORTS_O-1:0] m_rfnoc_chdr_tdata;
+  logic [       NUM_PORTS_O-1:0] m_rfnoc_chdr_tlast;
+  logic [       NUM_PORTS_O-1:0] m_rfnoc_chdr_tvalid;
+  logic [       NUM_PORTS_O-1:0] m_rfnoc_chdr_tready;
+
+  // Map the array of BFMs to a flat vector for the DUT connections
+  for (genvar i = 0; i < NUM_PORTS_I; i++) begin : gen_dut_input_connections
+    // Connect BFM master to DUT slave port
+    assign s_rfnoc_chdr_tdata[CHDR_W*i+:CHDR_W] = m_chdr[i].tdata;
+    assign s_rfnoc_chdr_tlast[i]                = m_chdr[i].tlast;
+    assign s_rfnoc_chdr_tvalid[i]               = m_chdr[i].tvalid;
+    assign m_chdr[i].tready                     = s_rfnoc_chdr_tready[i];
+  end
+  for (genvar i = 0; i < NUM_PORTS_O; i++) begin : gen_dut_output_connections
+    // Connect BFM slave to DUT master port
+    assign s_chdr[i].tdata        = m_rfnoc_chdr_tdata[CHDR_W*i+:CHDR_W];
+    assign s_chdr[i].tlast        = m_rfnoc_chdr_tlast[i];
+    assign s_chdr[i].tvalid       = m_rfnoc_chdr_tvalid[i];
+    assign m_rfnoc_chdr_tready[i] = s_chdr[i].tready;
+  end
+
+  rfnoc_block_awgn #(
+    .THIS_PORTID         (THIS_PORTID),
+    .CHDR_W              (CHDR_W),
+    .MTU                 (MTU)
+  ) dut (
+    .rfnoc_chdr_clk      (rfnoc_chdr_clk),
+    .rfnoc_ctrl_clk      (rfnoc_ctrl_clk),
+    .ce_clk              (ce_clk),
+    .rfnoc_core_config   (backend.cfg),
+    .rfnoc_core_status   (backend.sts),
+    .s_rfnoc_chdr_tdata  (s_rfnoc_chdr_tdata),
+    .s_rfnoc_chdr_tlast  (s_rfnoc_chdr_tlast),
+    .s_rfnoc_chdr_tvalid (s_rfnoc_chdr_tvalid),
+    .s_rfnoc_chdr_tready (s_rfnoc_chdr_tready),
+    .m_rfnoc_chdr_tdata  (m_rfnoc_chdr_tdata),
+    .m_rfnoc_chdr_tlast  (m_rfnoc_chdr_tlast),
+    .m_rfnoc_chdr_tvalid (m_rfnoc_chdr_tvalid),
+    .m_rfnoc_chdr_tready (m_rfnoc_chdr_tready),
+    .s_rfnoc_ctrl_tdata  (m_ctrl.tdata),
+    .s_rfnoc_ctrl_tlast  (m_ctrl.tlast),
+    .s_rfnoc_ctrl_tvalid (m_ctrl.tvalid),
+    .s_rfnoc_ctrl_tready (m_ctrl.tready),
+    .m_rfnoc_ctrl_tdata  (s_ctrl.tdata),
+    .m_rfnoc_ctrl_tlast  (s_ctrl.tlast),
+    .m_rfnoc_ctrl_tvalid (s_ctrl.tvalid),
+    .m_rfnoc_ctrl_tready (s_ctrl.tready)
+  );
+
+  //---------------------------------------------------------------------------
+  // Main Test Process
+  //---------------------------------------------------------------------------
+
+  initial begin : tb_main
+
+    // Initialize the test exec object for this testbench
+    test.start_tb("rfnoc_block_awgn_tb");
+
+    // Start the BFMs running
+    blk_ctrl.run();
+
+    //--------------------------------
+    // Reset
+    //--------------------------------
+
+    test.start_test("Flush block then reset it", 10us);
+    blk_ctrl.flush_and_reset();
+    test.end_test();
+
+    //--------------------------------
+    // Verify Block Info
+    //--------------------------------
+
+    test.start_test("Verify Block Info", 2us);
+    `ASSERT_ERROR(blk_ctrl.get_noc_id() == NOC_ID, "Incorrect NOC_ID Value");
+    `ASSERT_ERROR(blk_ctrl.get_num_data_i() == NUM_PORTS_I, "Incorrect NUM_DATA_I Value");
+    `ASSERT_ERROR(blk_ctrl.get_num_data_o() == NUM_PORTS_O, "Incorrect NUM_DATA_O Value");
+    `ASSERT_ERROR(blk_ctrl.get_mtu() == MTU, "Incorrect MTU Value");
+    test.end_test();
+
+    //--------------------------------
+    // Test Sequences
+    //--------------------------------
+
+    begin
+      // Read and write the user registers to make sure they update correctly.
+      logic [31:0] write_val, read_val;
+      test.start_test("Verify user registers", 5us);
+
+      // Test user registers have a default value
+      blk_ctrl.reg_read(dut.REG_NOISE_SCALE_ADDR, read_val);
+      `ASSERT_ERROR(
+        read_val == dut.REG_NOISE_SCALE_DEFAULT, "Incorrect default value for noise scale register");
+      blk_ctrl.reg_read(dut.REG_NOISE_SEED_ADDR, read_val);
+      `ASSERT_ERROR(
+        read_val == dut.REG_NOISE_SEED_DEFAULT, "Incorrect default value for noise seed register");
+
+      // Test writing and read user registers works
+      write_val = 32'h0000_1234;
+      blk_ctrl.reg_write(dut.REG_NOISE_SCALE_ADDR, write_val);
+      blk_ctrl.reg_read(dut.REG_NOISE_SCALE_ADDR, read_val);
+      `ASSERT_ERROR(
+        read_val == write_val, "Readback of noise scale register is incorrect");
+      write_val = 32'hDEAD_BEEF;
+      blk_ctrl.reg_write(dut.REG_NOISE_SEED_ADDR, write_val);
+      blk_ctrl.reg_read(dut.REG_NOISE_SEED_ADDR, read_val);
+      `ASSERT_ERROR(
+        read_val == write_val, "Readback of noise seed register is incorrect");
+
+      test.end_test();
+    end
+
+    begin
+      item_t send_samples[$];
+      item_t recv_samples[$];
+
+      test.start_test("Test passing through samples without noise", 10us);
+
+      blk_ctrl.reg_write(dut.REG_NOISE_SCALE_ADDR, 0);
+      for (int i = 0; i < SPP; i++) begin
+        send_samples.push_back($random()); // 32-bit I,Q
+      end
+      blk_ctrl.send_items(0, send_samples);
+      blk_ctrl.recv_items(0, recv_samples);
+
+      `ASSERT_ERROR(recv_samples.size() == SPP,
+        "Received payload didn't match size of payload sent");
+      for (int i = 0; i < SPP; i++) begin
+        `ASSERT_ERROR(
+          recv_samples[i] == send_samples[i],
+          $sformatf("Sample %4d, Received 0x%08X, Expected 0x%08X",
+                    i, recv_samples[i], send_samples[i]));
+      end
+
+      test.end_test();
+    end
+
+    begin
+      int        num_pkts = 16;
+      bit [31:0] seed     = 32'h1234_5678;
+      bit [15:0] scale    = 16'd20000;
+      AwgnModel model;
+      item_t send_samples[$];
+      item_t recv_samples[$];
+
+      test.start_test("Compare noisy samples against bit-exact model", 100us);
+
+      // Loading the seed restarts the noise sequence
+      blk_ctrl.reg_write(dut.REG_NOISE_SCALE_ADDR, scale);
+      blk_ctrl.reg_write(dut.REG_NOISE_SEED_ADDR, seed);
+      model = new(seed, scale);
+
+      for (int n = 0; n < num_pkts; n++) begin
+        send_samples = {};
+        for (int i = 0; i < SPP; i++) begin
+          send_samples.push_back($random()); // 32-bit I,Q, includes saturation
+        end
+        blk_ctrl.send_items(0, send_samples);
+        recv_samples = {};
+        blk_ctrl.recv_items(0, recv_samples);
+
+        `ASSERT_ERROR(recv_samples.size() == SPP,
+          $sformatf("Packet %0d: received payload didn't match size of payload sent", n));
+        for (int i = 0; i < SPP; i++) begin
+          item_t expected;
+          expected = model.process(send_samples[i]);
+          `ASSERT_ERROR(
+            recv_samples[i] == expected,
+            $sformatf("Packet %0d, Sample %4d, Received 0x%08X, Expected 0x%08X, Original 0x%08X",
+                      n, i, recv_samples[i], expected, send_samples[i]));
+        end
+      end
+
+      test.end_test();
+    end
+
+    begin
+      int        num_pkts = 64;
+      bit [15:0] scale    = 16'd4000; // Sigma of 1000 LSBs
+      item_t send_samples[$];
+      item_t recv_samples[$];
+      real   sigma, sum, sum_sq, mean, variance, in_one_sigma;
+      int    count, count_one_sigma;
+
+      test.start_test("Verify noise statistics", 200us);
+
+      blk_ctrl.reg_write(dut.REG_NOISE_SCALE_ADDR, scale);
+      blk_ctrl.reg_write(dut.REG_NOISE_SEED_ADDR, 32'hCAFE_F00D);
+      sigma           = scale / 4.0;
+      sum             = 0.0;
+      sum_sq          = 0.0;
+      count           = 0;
+      count_one_sigma = 0;
+
+      for (int n = 0; n < num_pkts; n++) begin
+        send_samples = {};
+        for (int i = 0; i < SPP; i++) begin
+          send_samples.push_back(0);
+        end
+        blk_ctrl.send_items(0, send_samples);
+        recv_samples = {};
+        blk_ctrl.recv_items(0, recv_samples);
+
+        // Skip the zero values while the generator pipeline fills
+        for (int i = (n == 0) ? 3 : 0; i < recv_samples.size(); i++) begin
+          logic signed [15:0] comp [2];
+          comp[0] = recv_samples[i][31:16];
+          comp[1] = recv_samples[i][15:0];
+          foreach (comp[c]) begin
+            sum    += comp[c];
+            sum_sq += real'(comp[c]) * real'(comp[c]);
+            count++;
+            if (comp[c] >= -sigma && comp[c] <= sigma) count_one_sigma++;
+          end
+        end
+      end
+
+      mean         = sum / count;
+      variance     = sum_sq / count - mean * mean;
+      in_one_sigma = real'(count_one_sigma) / count;
+      $display("Noise statistics: mean = %f, sigma = %f (expected %f), P(|x| <= sigma) = %f",
+               mean, $sqrt(variance), sigma, in_one_sigma);
+
+      `ASSERT_ERROR(mean > -0.05*sigma && mean < 0.05*sigma,
+        $sformatf("Noise mean %f is not zero", mean));
+      `ASSERT_ERROR(variance > 0.9*sigma*sigma && variance < 1.1*sigma*sigma,
+        $sformatf("Noise variance %f does not match expected %f", variance, sigma*sigma));
+      `ASSERT_ERROR(in_one_sigma > 0.65 && in_one_sigma < 0.72,
+        $sformatf("Noise is not Gaussian, P(|x| <= sigma) = %f", in_one_sigma));
+
+      test.end_test();
+    end
+
+    //--------------------------------
+    // Finish Up
+    //--------------------------------
+
+    // Display final statistics and results
+    test.end_tb();
+  end : tb_main
+
+endmodule : rfnoc_block_awgn_tb
+
+
+`default_nettype wire
@@ -16,6 +16,8 @@
 //   CHDR_W      : AXIS-CHDR data bus width
 //   MTU         : Maximum transmission unit (i.e., maximum packet size in
 //                 CHDR words is 2**MTU).
+//   FIFO_SIZE   : Log2 of the depth of the context and payload FIFOs of the
+//                 data paths.
 //
 
 `default_nettype none
@@ -24,7 +26,8 @@
 module noc_shell_shiftright #(
   parameter [9:0] THIS_PORTID     = 10'd0,
   parameter       CHDR_W          = 64,
-  parameter [5:0] MTU             = 10
+  parameter [5:0] MTU             = 10,
+  parameter       FIFO_SIZE       = $clog2(32)
 ) (
   //---------------------
   // Framework Interface
@@ -231,8 +234,8 @@ module noc_shell_shiftright #(
     .ITEM_W              (32),
     .NIPC                (1),
     .SYNC_CLKS           (0),
-    .CONTEXT_FIFO_SIZE   ($clog2(32)),
-    .PAYLOAD_FIFO_SIZE   ($clog2(32)),
+    .CONTEXT_FIFO_SIZE   (FIFO_SIZE),
+    .PAYLOAD_FIFO_SIZE   (FIFO_SIZE),
     .CONTEXT_PREFETCH_EN (1)
   ) chdr_to_axis_pyld_ctxt_in_in (
     .axis_chdr_clk         (rfnoc_chdr_clk),
@@ -268,8 +271,8 @@ module noc_shell_shiftright #(
     .ITEM_W              (32),
     .NIPC                (1),
     .SYNC_CLKS           (0),
-    .CONTEXT_FIFO_SIZE   ($clog2(32)),
-    .PAYLOAD_FIFO_SIZE   ($clog2(32)),
+    .CONTEXT_FIFO_SIZE   (FIFO_SIZE),
+    .PAYLOAD_FIFO_SIZE   (FIFO_SIZE),
     .MTU                 (MTU),
     .CONTEXT_PREFETCH_EN (1)
   ) axis_pyld_ctxt_to_chdr_out_out (
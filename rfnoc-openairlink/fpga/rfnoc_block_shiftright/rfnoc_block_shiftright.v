@@ -15,6 +15,10 @@
 //   CHDR_W      : AXIS-CHDR data bus width
 //   MTU         : Maximum transmission unit (i.e., maximum packet size in
 //                 CHDR words is 2**MTU).
+//   LOW_LATENCY : Set to 1 for the low-latency variant of the shift, see
+//                 shiftright_core.
+//   FIFO_SIZE   : Log2 of the depth of the context and payload FIFOs of the
+//                 NoC shell data paths. 1 (two entries) is the smallest.
 //
 
 `default_nettype none
@@ -23,7 +27,9 @@
 module rfnoc_block_shiftright #(
   parameter [9:0] THIS_PORTID     = 10'd0,
   parameter       CHDR_W          = 64,
-  parameter [5:0] MTU             = 10
+  parameter [5:0] MTU             = 10,
+  parameter       LOW_LATENCY     = 0,
+  parameter       FIFO_SIZE       = 5
 )(
   // RFNoC Framework Clocks and Resets
   input  wire                   rfnoc_chdr_clk,
@@ -54,9 +60,6 @@ module rfnoc_block_shiftright #(
   input  wire                   m_rfnoc_ctrl_tready
 );
 
-  `define RFNOC_CHDR_UTILS_PATH `"`UHD_FPGA_DIR/usrp3/lib/rfnoc/core/rfnoc_chdr_utils.vh`"
-  `include `RFNOC_CHDR_UTILS_PATH
-
   //---------------------------------------------------------------------------
   // Signal Declarations
   //---------------------------------------------------------------------------
@@ -71,8 +74,8 @@ module rfnoc_block_shiftright #(
   wire               m_ctrlport_req_rd;
   wire [19:0]        m_ctrlport_req_addr;
   wire [31:0]        m_ctrlport_req_data;
-  reg                m_ctrlport_resp_ack;
-  reg  [31:0]        m_ctrlport_resp_data;
+  wire               m_ctrlport_resp_ack;
+  wire [31:0]        m_ctrlport_resp_data;
   // Payload Stream to User Logic: in
   wire [32*1-1:0]    m_in_payload_tdata;
   wire [1-1:0]       m_in_payload_tkeep;
@@ -105,7 +108,8 @@ module rfnoc_block_shiftright #(
   noc_shell_shiftright #(
     .CHDR_W              (CHDR_W),
     .THIS_PORTID         (THIS_PORTID),
-    .MTU                 (MTU)
+    .MTU                 (MTU),
+    .FIFO_SIZE           (FIFO_SIZE)
   ) noc_shell_shiftright_i (
     //---------------------
     // Framework Interface
@@ -187,129 +191,49 @@ module rfnoc_block_shiftright #(
     .s_out_context_tready (s_out_context_tready)
   );
 
-  //---------------------------------------------------------------------------
-  // User Registers
-  //---------------------------------------------------------------------------
-  //
-  // There's only one register now, but we'll structure the register code to
-  // make it easier to add more registers later.
-  // Register use the ctrlport_clk clock.
-  //
-  //---------------------------------------------------------------------------
-
-  localparam REG_SHIFT_ADDR    = 0; // Address shift right register
-  localparam REG_SHIFT_DEFAULT = 0; // Default shift right value
-
-  reg signed [15:0] reg_shift = REG_SHIFT_DEFAULT;
-
-  always @(posedge ctrlport_clk) begin
-    if (ctrlport_rst) begin
-      reg_shift = REG_SHIFT_DEFAULT;
-    end else begin
-      // Default assignment
-      m_ctrlport_resp_ack <= 0;
-
-      // Read user register
-      if (m_ctrlport_req_rd) begin // Read request
-        case (m_ctrlport_req_addr)
-          REG_SHIFT_ADDR: begin
-            m_ctrlport_resp_ack  <= 1;
-            m_ctrlport_resp_data <= { 16'b0, reg_shift };
-          end
-        endcase
-      end
-
-      // Write user register
-      if (m_ctrlport_req_wr) begin // Write requst
-        case (m_ctrlport_req_addr)
-          REG_SHIFT_ADDR: begin
-            m_ctrlport_resp_ack <= 1;
-            reg_shift           <= m_ctrlport_req_data[15:0];
-          end
-        endcase
-      end
-    end
-  end
-
   //---------------------------------------------------------------------------
   // User Logic
   //---------------------------------------------------------------------------
   //
-  // User logic uses the axis_data_clk clock. While the registers above use the
-  // ctrlport_clk clock, in the block YAML configuration file both the control
-  // and data interfaces are specified to use the rfnoc_chdr clock. Therefore,
-  // we do not need to cross clock domains when using user registers with
-  // user logic.
+  // Registers, shift, telemetry and channel tag, see shiftright_core.v. Both
+  // the control and data interfaces use the ce_clk clock (see the block YAML
+  // configuration file), so the core runs on one clock.
   //
   //---------------------------------------------------------------------------
 
-
-
-  wire [31:0] pipe_in_tdata;
-  wire pipe_in_tvalid, pipe_in_tlast;
-  wire pipe_in_tready;
-
-  wire [31:0] pipe_out_tdata;
-  wire pipe_out_tvalid, pipe_out_tlast;
-  wire pipe_out_tready;
-
-  // Adding FIFO to ensure Pipeline
-  axi_fifo #(
-    .WIDTH (32+1),
-    .SIZE  (0)
-  )
-  pipeline0_axi_fifo (
-    .clk      (ce_clk),
-    .reset    (0),
-    .clear    (0),
-    .i_tdata  ({m_in_payload_tlast, m_in_payload_tdata}),
-    .i_tvalid (m_in_payload_tvalid),
-    .i_tready (m_in_payload_tready),
-    .o_tdata  ({pipe_in_tlast, pipe_in_tdata}),
-    .o_tvalid (pipe_in_tvalid),
-    .o_tready (pipe_in_tready)
-  );
-
-  wire signed [15:0] shift_bits = reg_shift[15:0];
-  wire signed [15:0] i = pipe_in_tdata[31:16];
-  wire signed [15:0] q = pipe_in_tdata[15:0];
-
-  wire signed [31:0] i_sr = i >>> shift_bits;
-  wire signed [31:0] q_sr = q >>> shift_bits;
-
-  wire signed [31:0] sr_data = {i_sr[15:0], q_sr[15:0]};
-
-  axi_fifo #(
-    .WIDTH (32+1),
-    .SIZE  (0)
-  )
-  pipeline1_axi_fifo (
-    .clk(ce_clk),
-    .reset    (0),
-    .clear    (0),
-    .i_tdata  ({pipe_in_tlast, sr_data}),
-    .i_tvalid (pipe_in_tvalid),
-    .i_tready (pipe_in_tready),
-    .o_tdata  ({pipe_out_tlast, pipe_out_tdata}),
-    .o_tvalid (pipe_out_tvalid),
-    .o_tready (pipe_out_tready)
+  shiftright_core #(
+    .CHDR_W      (CHDR_W),
+    .LOW_LATENCY (LOW_LATENCY)
+  ) shiftright_core_i (
+    .clk                  (ce_clk),
+    .ctrlport_rst         (ctrlport_rst),
+    .axis_data_rst        (axis_data_rst),
+    .s_ctrlport_req_wr    (m_ctrlport_req_wr),
+    .s_ctrlport_req_rd    (m_ctrlport_req_rd),
+    .s_ctrlport_req_addr  (m_ctrlport_req_addr),
+    .s_ctrlport_req_data  (m_ctrlport_req_data),
+    .s_ctrlport_resp_ack  (m_ctrlport_resp_ack),
+    .s_ctrlport_resp_data (m_ctrlport_resp_data),
+    .m_in_payload_tdata   (m_in_payload_tdata),
+    .m_in_payload_tlast   (m_in_payload_tlast),
+    .m_in_payload_tvalid  (m_in_payload_tvalid),
+    .m_in_payload_tready  (m_in_payload_tready),
+    .m_in_context_tdata   (m_in_context_tdata),
+    .m_in_context_tuser   (m_in_context_tuser),
+    .m_in_context_tlast   (m_in_context_tlast),
+    .m_in_context_tvalid  (m_in_context_tvalid),
+    .m_in_context_tready  (m_in_context_tready),
+    .s_out_payload_tdata  (s_out_payload_tdata),
+    .s_out_payload_tlast  (s_out_payload_tlast),
+    .s_out_payload_tvalid (s_out_payload_tvalid),
+    .s_out_payload_tready (s_out_payload_tready),
+    .s_out_context_tdata  (s_out_context_tdata),
+    .s_out_context_tuser  (s_out_context_tuser),
+    .s_out_context_tlast  (s_out_context_tlast),
+    .s_out_context_tvalid (s_out_context_tvalid),
+    .s_out_context_tready (s_out_context_tready)
   );
 
-
-  // Sample data, pass through unchanged
-  assign s_out_payload_tdata  = pipe_out_tdata;
-  assign s_out_payload_tlast  = pipe_out_tlast;
-  assign s_out_payload_tvalid = pipe_out_tvalid;
-  assign pipe_out_tready      = s_out_payload_tready;
-
-  // Context data, we are not doing anything with the context
-  // (the CHDR header info) so we can simply pass through unchanged
-  assign s_out_context_tdata  = m_in_context_tdata;
-  assign s_out_context_tuser  = m_in_context_tuser;
-  assign s_out_context_tlast  = m_in_context_tlast;
-  assign s_out_context_tvalid = m_in_context_tvalid;
-  assign m_in_context_tready  = s_out_context_tready;
-
   // Only 1-sample per clock, so tkeep should always be asserted
   assign s_out_payload_tkeep = 1'b1;
 
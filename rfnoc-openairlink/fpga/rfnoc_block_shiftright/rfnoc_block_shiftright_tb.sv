@@ -188,15 +188,15 @@ module rfnoc_block_shiftright_tb;
       test.start_test("Verify user register", 5us);
 
       // Test user register has a default value
-      blk_ctrl.reg_read(dut.REG_SHIFT_ADDR, read_val);
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_SHIFT_ADDR, read_val);
       `ASSERT_ERROR(
-        read_val == dut.REG_SHIFT_DEFAULT, "Incorrect default value for user register");
+        read_val == dut.shiftright_core_i.REG_SHIFT_DEFAULT, "Incorrect default value for user register");
 
       // Test writing and read user register works
       write_val = 2;
       write_val = { 16'b0, write_val[15:0] };
-      blk_ctrl.reg_write(dut.REG_SHIFT_ADDR, write_val);
-      blk_ctrl.reg_read(dut.REG_SHIFT_ADDR, read_val);
+      blk_ctrl.reg_write(dut.shiftright_core_i.REG_SHIFT_ADDR, write_val);
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_SHIFT_ADDR, read_val);
       `ASSERT_ERROR(
         read_val == write_val, "Initial value for user register is incorrect");
 
@@ -214,7 +214,7 @@ module rfnoc_block_shiftright_tb;
 
         logic signed [15:0] gain;
         logic [31:0] user_reg;
-        blk_ctrl.reg_read(dut.REG_SHIFT_ADDR, user_reg);
+        blk_ctrl.reg_read(dut.shiftright_core_i.REG_SHIFT_ADDR, user_reg);
         gain = user_reg[15:0];
         // Generate a payload of random samples
         send_samples = {};
@@ -261,6 +261,112 @@ module rfnoc_block_shiftright_tb;
       test.end_test();
     end
 
+    begin
+      item_t send_samples[$];
+      item_t recv_samples[$];
+      logic [31:0] read_val, count_before;
+      logic signed [15:0] i_samp, q_samp;
+      longint unsigned exp_power;
+      int exp_peak, exp_clip, i_mag, q_mag;
+
+      test.start_test("Verify telemetry", 20us);
+
+      // One window per packet, writing the window restarts it
+      blk_ctrl.reg_write(dut.shiftright_core_i.REG_STATS_WINDOW_ADDR, $clog2(SPP));
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_STATS_WINDOW_ADDR, read_val);
+      `ASSERT_ERROR(read_val == $clog2(SPP), "Incorrect telemetry window");
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_STATS_COUNT_ADDR, count_before);
+
+      // Random samples, one of them at negative full scale
+      send_samples = {};
+      for (int i = 0; i < SPP; i++) begin
+        send_samples.push_back($random());
+      end
+      send_samples[SPP/2] = {16'h8000, 16'h0001};
+
+      exp_power = 0;
+      exp_peak  = 0;
+      exp_clip  = 0;
+      for (int i = 0; i < SPP; i++) begin
+        i_samp = send_samples[i][31:16];
+        q_samp = send_samples[i][15:0];
+        i_mag  = (i_samp < 0) ? -int'(i_samp) : int'(i_samp);
+        q_mag  = (q_samp < 0) ? -int'(q_samp) : int'(q_samp);
+        exp_power += i_mag*i_mag + q_mag*q_mag;
+        exp_peak   = (i_mag > exp_peak) ? i_mag : exp_peak;
+        exp_peak   = (q_mag > exp_peak) ? q_mag : exp_peak;
+        exp_clip  += (i_mag >= 32767 || q_mag >= 32767) ? 1 : 0;
+      end
+      exp_power = exp_power >> $clog2(SPP);
+
+      blk_ctrl.send_items(0, send_samples);
+      blk_ctrl.recv_items(0, recv_samples);
+
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_STATS_COUNT_ADDR, read_val);
+      `ASSERT_ERROR(read_val == count_before + 1, "Telemetry window did not complete");
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_STATS_POWER_ADDR, read_val);
+      `ASSERT_ERROR(read_val == exp_power,
+        $sformatf("Power is %0d, expected %0d", read_val, exp_power));
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_STATS_PEAK_ADDR, read_val);
+      `ASSERT_ERROR(read_val == exp_peak,
+        $sformatf("Peak is %0d, expected %0d", read_val, exp_peak));
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_STATS_CLIP_ADDR, read_val);
+      `ASSERT_ERROR(read_val == exp_clip,
+        $sformatf("Clip count is %0d, expected %0d", read_val, exp_clip));
+
+      test.end_test();
+    end
+
+    begin
+      item_t send_samples[$];
+      item_t recv_samples[$];
+      chdr_word_t recv_mdata[$];
+      packet_info_t pkt_info;
+      logic [31:0] read_val, shift_val;
+
+      test.start_test("Verify channel tag", 20us);
+
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_TAG_CTRL_ADDR, read_val);
+      `ASSERT_ERROR(read_val == 0, "Channel tag is enabled by default");
+
+      blk_ctrl.reg_write(dut.shiftright_core_i.REG_TAG_ID_ADDR, 32'hC0FFEE01);
+      blk_ctrl.reg_write(dut.shiftright_core_i.REG_TAG_CTRL_ADDR, 1);
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_TAG_ID_ADDR, read_val);
+      `ASSERT_ERROR(read_val == 32'hC0FFEE01, "Incorrect channel tag step ID");
+      blk_ctrl.reg_read(dut.shiftright_core_i.REG_SHIFT_ADDR, shift_val);
+
+      send_samples = {};
+      for (int i = 0; i < SPP; i++) begin
+        send_samples.push_back($random());
+      end
+
+      // The tag is the only metadata word
+      blk_ctrl.send_items(0, send_samples);
+      blk_ctrl.recv_items_adv(0, recv_samples, recv_mdata, pkt_info);
+      `ASSERT_ERROR(recv_samples.size() == SPP, "Tagged packet has the wrong payload size");
+      `ASSERT_ERROR(recv_mdata.size() == 1,
+        $sformatf("Tagged packet has %0d metadata words, expected 1", recv_mdata.size()));
+      `ASSERT_ERROR(recv_mdata[0][63:48] == dut.shiftright_core_i.TAG_MARKER, "Incorrect channel tag marker");
+      `ASSERT_ERROR(recv_mdata[0][47:32] == shift_val[15:0], "Incorrect channel tag shift");
+      `ASSERT_ERROR(recv_mdata[0][31:0] == 32'hC0FFEE01, "Incorrect channel tag step ID");
+
+      // The tag is appended after existing metadata
+      blk_ctrl.send_items(0, send_samples, '{64'h0123456789ABCDEF});
+      blk_ctrl.recv_items_adv(0, recv_samples, recv_mdata, pkt_info);
+      `ASSERT_ERROR(recv_mdata.size() == 2,
+        $sformatf("Tagged packet has %0d metadata words, expected 2", recv_mdata.size()));
+      `ASSERT_ERROR(recv_mdata[0] == 64'h0123456789ABCDEF, "Metadata was not passed through");
+      `ASSERT_ERROR(recv_mdata[1][31:0] == 32'hC0FFEE01, "Incorrect channel tag step ID");
+
+      // No tag once disabled
+      blk_ctrl.reg_write(dut.shiftright_core_i.REG_TAG_CTRL_ADDR, 0);
+      blk_ctrl.send_items(0, send_samples);
+      blk_ctrl.recv_items_adv(0, recv_samples, recv_mdata, pkt_info);
+      `ASSERT_ERROR(recv_mdata.size() == 0, "Packet is tagged with the tag disabled");
+
+      test.end_test();
+    end
+
     //--------------------------------
     // Finish Up
     //--------------------------------
@@ -0,0 +1,493 @@
+//
+// Copyright 2024 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+//
+// Module: shiftright_core
+//
+// Description:
+//
+//   User logic of the Shiftright block: the registers, the shift, the
+//   telemetry and the channel tag, between the CtrlPort and AXI-Stream
+//   interfaces of noc_shell_shiftright. It has no dependency on the NoC shell,
+//   so it can be simulated on its own (see the verilator directory).
+//
+//   The registers and the data path use one clock, in the block YAML
+//   configuration file both the control and data interfaces are specified to
+//   use the ce clock.
+//
+// Parameters:
+//
+//   CHDR_W      : AXIS-CHDR data bus width
+//   LOW_LATENCY : Set to 1 to leave out the pipeline FIFOs before and after
+//                 the shift. The shift is then combinational from the input
+//                 to the output payload stream, between the registered FIFOs
+//                 of the NoC shell. Use it where the 16-bit barrel shift
+//                 meets timing at the ce clock rate.
+//
+
+`default_nettype none
+
+
+module shiftright_core #(
+  parameter CHDR_W      = 64,
+  parameter LOW_LATENCY = 0
+)(
+  input  wire              clk,
+  input  wire              ctrlport_rst,
+  input  wire              axis_data_rst,
+  // CtrlPort Slave
+  input  wire              s_ctrlport_req_wr,
+  input  wire              s_ctrlport_req_rd,
+  input  wire [19:0]       s_ctrlport_req_addr,
+  input  wire [31:0]       s_ctrlport_req_data,
+  output reg               s_ctrlport_resp_ack,
+  output reg  [31:0]       s_ctrlport_resp_data,
+  // Payload Stream: in
+  input  wire [31:0]       m_in_payload_tdata,
+  input  wire              m_in_payload_tlast,
+  input  wire              m_in_payload_tvalid,
+  output wire              m_in_payload_tready,
+  // Context Stream: in
+  input  wire [CHDR_W-1:0] m_in_context_tdata,
+  input  wire [3:0]        m_in_context_tuser,
+  input  wire              m_in_context_tlast,
+  input  wire              m_in_context_tvalid,
+  output reg               m_in_context_tready,
+  // Payload Stream: out
+  output wire [31:0]       s_out_payload_tdata,
+  output wire              s_out_payload_tlast,
+  output wire              s_out_payload_tvalid,
+  input  wire              s_out_payload_tready,
+  // Context Stream: out
+  output reg  [CHDR_W-1:0] s_out_context_tdata,
+  output reg  [3:0]        s_out_context_tuser,
+  output reg               s_out_context_tlast,
+  output reg               s_out_context_tvalid,
+  input  wire              s_out_context_tready
+);
+
+  `define RFNOC_CHDR_UTILS_PATH `"`UHD_FPGA_DIR/usrp3/lib/rfnoc/core/rfnoc_chdr_utils.vh`"
+  `include `RFNOC_CHDR_UTILS_PATH
+
+  //---------------------------------------------------------------------------
+  // User Registers
+  //---------------------------------------------------------------------------
+  //
+  // REG_SHIFT        : Shift right value.
+  // REG_STATS_WINDOW : Log2 of the number of samples per telemetry window.
+  //                    Writing it restarts the current window.
+  // REG_STATS_COUNT  : Number of completed telemetry windows (read only).
+  // REG_STATS_POWER  : Mean I^2+Q^2 at the block input over the last window
+  //                    (read only).
+  // REG_STATS_PEAK   : Max of |I| and |Q| at the block input over the last
+  //                    window (read only).
+  // REG_STATS_CLIP   : Samples in the last window with I or Q at full scale
+  //                    at the block input, i.e., saturated by the FIR (read
+  //                    only).
+  // REG_TAG_CTRL     : Bit 0 enables the channel tag. Each output packet then
+  //                    carries one extra metadata word with the tag.
+  // REG_TAG_ID       : Channel step ID written into the tag.
+  //
+  // The tag is latched when the context header of a packet is accepted,
+  // together with the shift used for the whole packet, so all samples of a
+  // packet belong to the tagged channel state. The tag metadata word is
+  // { TAG_MARKER[15:0], shift[15:0], step ID[31:0] }. It is not added if the
+  // packet already has the maximum of 31 metadata words.
+  //
+  // The telemetry is taken before the shift, so it does not depend on
+  // REG_SHIFT and the output level is the input level scaled by 2^-shift.
+  //
+  //---------------------------------------------------------------------------
+
+  localparam [19:0] REG_SHIFT_ADDR           = 0;  // Address shift right register
+  localparam [15:0] REG_SHIFT_DEFAULT        = 0;  // Default shift right value
+  localparam [19:0] REG_STATS_WINDOW_ADDR    = 4;  // Address telemetry window register
+  localparam [ 4:0] REG_STATS_WINDOW_DEFAULT = 16; // Default telemetry window (65536 samples)
+  localparam [31:0] REG_STATS_WINDOW_MAX     = 24; // Largest telemetry window
+  localparam [19:0] REG_STATS_COUNT_ADDR     = 8;  // Address telemetry window count
+  localparam [19:0] REG_STATS_POWER_ADDR     = 12; // Address telemetry mean power
+  localparam [19:0] REG_STATS_PEAK_ADDR      = 16; // Address telemetry peak
+  localparam [19:0] REG_STATS_CLIP_ADDR      = 20; // Address telemetry clip count
+  localparam [19:0] REG_TAG_CTRL_ADDR        = 24; // Address channel tag control register
+  localparam [19:0] REG_TAG_ID_ADDR          = 28; // Address channel tag step ID register
+  localparam [15:0] TAG_MARKER               = 16'h0A1C; // Marks the tag metadata word
+
+  reg signed [15:0] reg_shift        = REG_SHIFT_DEFAULT;
+  reg        [ 4:0] reg_stats_window = REG_STATS_WINDOW_DEFAULT;
+  reg               stats_clear      = 1'b0;
+  reg               reg_tag_enable   = 1'b0;
+  reg        [31:0] reg_tag_id       = 0;
+
+  // Telemetry of the last complete window, from the user logic below
+  reg        [31:0] stats_count      = 0;
+  reg        [31:0] stats_power      = 0;
+  reg        [16:0] stats_peak       = 0;
+  reg        [24:0] stats_clip       = 0;
+
+  always @(posedge clk) begin
+    if (ctrlport_rst) begin
+      reg_shift        <= REG_SHIFT_DEFAULT;
+      reg_stats_window <= REG_STATS_WINDOW_DEFAULT;
+      stats_clear      <= 1'b1;
+      reg_tag_enable   <= 1'b0;
+      reg_tag_id       <= 0;
+    end else begin
+      // Default assignment
+      s_ctrlport_resp_ack <= 0;
+      stats_clear         <= 1'b0;
+
+      // Read user register
+      if (s_ctrlport_req_rd) begin // Read request
+        case (s_ctrlport_req_addr)
+          REG_SHIFT_ADDR: begin
+            s_ctrlport_resp_ack  <= 1;
+            s_ctrlport_resp_data <= { 16'b0, reg_shift };
+          end
+          REG_STATS_WINDOW_ADDR: begin
+            s_ctrlport_resp_ack  <= 1;
+            s_ctrlport_resp_data <= { 27'b0, reg_stats_window };
+          end
+          REG_STATS_COUNT_ADDR: begin
+            s_ctrlport_resp_ack  <= 1;
+            s_ctrlport_resp_data <= stats_count;
+          end
+          REG_STATS_POWER_ADDR: begin
+            s_ctrlport_resp_ack  <= 1;
+            s_ctrlport_resp_data <= stats_power;
+          end
+          REG_STATS_PEAK_ADDR: begin
+            s_ctrlport_resp_ack  <= 1;
+            s_ctrlport_resp_data <= { 15'b0, stats_peak };
+          end
+          REG_STATS_CLIP_ADDR: begin
+            s_ctrlport_resp_ack  <= 1;
+            s_ctrlport_resp_data <= { 7'b0, stats_clip };
+          end
+          REG_TAG_CTRL_ADDR: begin
+            s_ctrlport_resp_ack  <= 1;
+            s_ctrlport_resp_data <= { 31'b0, reg_tag_enable };
+          end
+          REG_TAG_ID_ADDR: begin
+            s_ctrlport_resp_ack  <= 1;
+            s_ctrlport_resp_data <= reg_tag_id;
+          end
+        endcase
+      end
+
+      // Write user register
+      if (s_ctrlport_req_wr) begin // Write requst
+        case (s_ctrlport_req_addr)
+          REG_SHIFT_ADDR: begin
+            s_ctrlport_resp_ack <= 1;
+            reg_shift           <= s_ctrlport_req_data[15:0];
+          end
+          REG_STATS_WINDOW_ADDR: begin
+            s_ctrlport_resp_ack <= 1;
+            reg_stats_window    <= (s_ctrlport_req_data > REG_STATS_WINDOW_MAX) ?
+                                   REG_STATS_WINDOW_MAX[4:0] : s_ctrlport_req_data[4:0];
+            stats_clear         <= 1'b1;
+          end
+          REG_TAG_CTRL_ADDR: begin
+            s_ctrlport_resp_ack <= 1;
+            reg_tag_enable      <= s_ctrlport_req_data[0];
+          end
+          REG_TAG_ID_ADDR: begin
+            s_ctrlport_resp_ack <= 1;
+            reg_tag_id          <= s_ctrlport_req_data;
+          end
+        endcase
+      end
+    end
+  end
+
+  //---------------------------------------------------------------------------
+  // Shift
+  //---------------------------------------------------------------------------
+
+  wire [31:0] pipe_in_tdata;
+  wire pipe_in_tvalid, pipe_in_tlast;
+  wire pipe_in_tready;
+
+  wire [31:0] pipe_out_tdata;
+  wire pipe_out_tvalid, pipe_out_tlast;
+  wire pipe_out_tready;
+
+  generate
+    if (LOW_LATENCY) begin : gen_pipeline0_bypass
+      assign {pipe_in_tlast, pipe_in_tdata} = {m_in_payload_tlast, m_in_payload_tdata};
+      assign pipe_in_tvalid      = m_in_payload_tvalid;
+      assign m_in_payload_tready = pipe_in_tready;
+    end else begin : gen_pipeline0
+      // Adding FIFO to ensure Pipeline
+      axi_fifo #(
+        .WIDTH (32+1),
+        .SIZE  (0)
+      )
+      pipeline0_axi_fifo (
+        .clk      (clk),
+        .reset    (0),
+        .clear    (0),
+        .i_tdata  ({m_in_payload_tlast, m_in_payload_tdata}),
+        .i_tvalid (m_in_payload_tvalid),
+        .i_tready (m_in_payload_tready),
+        .o_tdata  ({pipe_in_tlast, pipe_in_tdata}),
+        .o_tvalid (pipe_in_tvalid),
+        .o_tready (pipe_in_tready),
+        .space    (),
+        .occupied ()
+      );
+    end
+  endgenerate
+
+  // The context side pushes one entry per packet into the tag FIFO when it
+  // accepts the header, also with the tag disabled, which keeps the entries
+  // aligned with the payload packets. The payload of a packet waits for its
+  // entry and pops it at the first sample. The context of a packet comes
+  // before its payload, so the context side never waits for the payload.
+  // With the tag enabled, the shift of the entry is used for the whole
+  // packet, so the tag describes the whole packet.
+  wire [16:0] tag_tdata;
+  wire        tag_tvalid;
+
+  reg               pkt_start      = 1'b1;
+  reg               pkt_tag_enable = 1'b0;
+  reg signed [15:0] pkt_shift      = REG_SHIFT_DEFAULT;
+
+  wire        pkt_ctx_ok = !pkt_start || tag_tvalid;
+  wire        pipe1_in_tready;
+
+  assign pipe_in_tready = pipe1_in_tready && pkt_ctx_ok;
+
+  always @(posedge clk) begin
+    if (axis_data_rst) begin
+      pkt_start <= 1'b1;
+    end else if (pipe_in_tvalid && pipe_in_tready) begin
+      pkt_start <= pipe_in_tlast;
+      if (pkt_start) begin
+        pkt_tag_enable <= tag_tdata[16];
+        pkt_shift      <= tag_tdata[15:0];
+      end
+    end
+  end
+
+  wire               cur_tag_enable = pkt_start ? tag_tdata[16] : pkt_tag_enable;
+  wire signed [15:0] cur_pkt_shift  = pkt_start ? tag_tdata[15:0] : pkt_shift;
+  wire signed [15:0] shift_bits     = cur_tag_enable ? cur_pkt_shift : reg_shift[15:0];
+  wire signed [15:0] i = pipe_in_tdata[31:16];
+  wire signed [15:0] q = pipe_in_tdata[15:0];
+
+  // An arithmetic shift by 16 or more gives the sign in all bits
+  wire signed [15:0] i_sr = i >>> shift_bits;
+  wire signed [15:0] q_sr = q >>> shift_bits;
+
+  wire signed [31:0] sr_data = {i_sr, q_sr};
+
+  generate
+    if (LOW_LATENCY) begin : gen_pipeline1_bypass
+      assign {pipe_out_tlast, pipe_out_tdata} = {pipe_in_tlast, sr_data};
+      assign pipe_out_tvalid = pipe_in_tvalid && pkt_ctx_ok;
+      assign pipe1_in_tready = pipe_out_tready;
+    end else begin : gen_pipeline1
+      axi_fifo #(
+        .WIDTH (32+1),
+        .SIZE  (0)
+      )
+      pipeline1_axi_fifo (
+        .clk(clk),
+        .reset    (0),
+        .clear    (0),
+        .i_tdata  ({pipe_in_tlast, sr_data}),
+        .i_tvalid (pipe_in_tvalid && pkt_ctx_ok),
+        .i_tready (pipe1_in_tready),
+        .o_tdata  ({pipe_out_tlast, pipe_out_tdata}),
+        .o_tvalid (pipe_out_tvalid),
+        .o_tready (pipe_out_tready),
+        .space    (),
+        .occupied ()
+      );
+    end
+  endgenerate
+
+
+  //---------------------------------------------------------------------------
+  // Telemetry
+  //---------------------------------------------------------------------------
+
+  // Stage 0: squares, magnitudes and full scale flags of the input samples
+  reg               st0_valid = 1'b0;
+  reg        [31:0] st0_i_sq, st0_q_sq;
+  reg        [16:0] st0_mag;
+  reg               st0_clip;
+
+  wire       [16:0] i_mag = i[15] ? -{i[15], i} : {1'b0, i};
+  wire       [16:0] q_mag = q[15] ? -{q[15], q} : {1'b0, q};
+  wire signed [31:0] i_ext = {{16{i[15]}}, i};
+  wire signed [31:0] q_ext = {{16{q[15]}}, q};
+
+  always @(posedge clk) begin
+    st0_valid <= pipe_in_tvalid && pipe_in_tready;
+    st0_i_sq  <= i_ext * i_ext;
+    st0_q_sq  <= q_ext * q_ext;
+    st0_mag   <= (i_mag > q_mag) ? i_mag : q_mag;
+    st0_clip  <= (i_mag >= 17'd32767) || (q_mag >= 17'd32767);
+  end
+
+  // Stage 1: accumulate over the window, then hand the results to the
+  // registers.
+  reg        [55:0] acc_power = 0;
+  reg        [16:0] acc_peak  = 0;
+  reg        [24:0] acc_clip  = 0;
+  reg        [23:0] acc_samps = 0;
+
+  wire       [55:0] acc_power_next = acc_power + {24'b0, st0_i_sq} + {24'b0, st0_q_sq};
+  wire       [16:0] acc_peak_next  = (st0_mag > acc_peak) ? st0_mag : acc_peak;
+  wire       [24:0] acc_clip_next  = acc_clip + {24'b0, st0_clip};
+  wire       [24:0] window_len     = 25'd1 << reg_stats_window;
+  wire       [55:0] acc_power_mean = acc_power_next >> reg_stats_window;
+
+  always @(posedge clk) begin
+    if (stats_clear) begin
+      acc_power <= 0;
+      acc_peak  <= 0;
+      acc_clip  <= 0;
+      acc_samps <= 0;
+    end else if (st0_valid) begin
+      if ({1'b0, acc_samps} >= window_len - 25'd1) begin
+        stats_count <= stats_count + 32'd1;
+        stats_power <= acc_power_mean[31:0];
+        stats_peak  <= acc_peak_next;
+        stats_clip  <= acc_clip_next;
+        acc_power   <= 0;
+        acc_peak    <= 0;
+        acc_clip    <= 0;
+        acc_samps   <= 0;
+      end else begin
+        acc_power   <= acc_power_next;
+        acc_peak    <= acc_peak_next;
+        acc_clip    <= acc_clip_next;
+        acc_samps   <= acc_samps + 24'd1;
+      end
+    end
+  end
+
+  // Sample data, pass through unchanged
+  assign s_out_payload_tdata  = pipe_out_tdata;
+  assign s_out_payload_tlast  = pipe_out_tlast;
+  assign s_out_payload_tvalid = pipe_out_tvalid;
+  assign pipe_out_tready      = s_out_payload_tready;
+
+  //---------------------------------------------------------------------------
+  // Channel Tag
+  //---------------------------------------------------------------------------
+
+  wire        tag_in_tvalid;
+  wire        tag_in_tready;
+
+  axi_fifo #(
+    .WIDTH (1+16),
+    .SIZE  (5)
+  )
+  tag_axi_fifo (
+    .clk      (clk),
+    .reset    (axis_data_rst),
+    .clear    (1'b0),
+    .i_tdata  ({reg_tag_enable, reg_shift}),
+    .i_tvalid (tag_in_tvalid),
+    .i_tready (tag_in_tready),
+    .o_tdata  (tag_tdata),
+    .o_tvalid (tag_tvalid),
+    .o_tready (pipe_in_tvalid && pipe_in_tready && pkt_start),
+    .space    (),
+    .occupied ()
+  );
+
+  // Context data, the header is passed through unchanged unless the tag is
+  // enabled for the packet. Then NumMData and Length are increased and the
+  // tag word is appended after the last context word.
+  localparam [1:0] CTX_ST_HDR  = 2'd0; // Header word, push the tag entry
+  localparam [1:0] CTX_ST_PASS = 2'd1; // Timestamp and metadata words
+  localparam [1:0] CTX_ST_TAG  = 2'd2; // Appended tag word
+
+  localparam [15:0] CTX_WORD_BYTES = CHDR_W/8;
+
+  reg  [1:0]        ctx_state = CTX_ST_HDR;
+  reg               ctx_insert = 1'b0;
+  reg  [CHDR_W-1:0] ctx_tag_word = 0;
+  reg  [CHDR_W-1:0] ctx_hdr_tagged;
+
+  wire [4:0]  ctx_num_mdata = chdr_get_num_mdata(m_in_context_tdata[63:0]);
+  wire [15:0] ctx_length    = chdr_get_length(m_in_context_tdata[63:0]);
+  wire        ctx_hdr_insert = reg_tag_enable && (ctx_num_mdata != 5'd31);
+
+  always @(*) begin
+    ctx_hdr_tagged       = m_in_context_tdata;
+    ctx_hdr_tagged[63:0] = chdr_set_length(
+      chdr_set_num_mdata(m_in_context_tdata[63:0], ctx_num_mdata + 5'd1),
+      ctx_length + CTX_WORD_BYTES);
+  end
+
+  always @(*) begin
+    case (ctx_state)
+      CTX_ST_HDR: begin
+        s_out_context_tdata  = ctx_hdr_insert ? ctx_hdr_tagged : m_in_context_tdata;
+        s_out_context_tuser  = m_in_context_tuser;
+        s_out_context_tlast  = m_in_context_tlast && !ctx_hdr_insert;
+        s_out_context_tvalid = m_in_context_tvalid && tag_in_tready;
+        m_in_context_tready  = s_out_context_tready && tag_in_tready;
+      end
+      CTX_ST_TAG: begin
+        s_out_context_tdata  = ctx_tag_word;
+        s_out_context_tuser  = CONTEXT_FIELD_MDATA;
+        s_out_context_tlast  = 1'b1;
+        s_out_context_tvalid = 1'b1;
+        m_in_context_tready  = 1'b0;
+      end
+      default: begin
+        s_out_context_tdata  = m_in_context_tdata;
+        s_out_context_tuser  = m_in_context_tuser;
+        s_out_context_tlast  = m_in_context_tlast && !ctx_insert;
+        s_out_context_tvalid = m_in_context_tvalid;
+        m_in_context_tready  = s_out_context_tready;
+      end
+    endcase
+  end
+
+  assign tag_in_tvalid = (ctx_state == CTX_ST_HDR) && m_in_context_tvalid && s_out_context_tready;
+
+  always @(posedge clk) begin
+    if (axis_data_rst) begin
+      ctx_state  <= CTX_ST_HDR;
+      ctx_insert <= 1'b0;
+    end else begin
+      case (ctx_state)
+        CTX_ST_HDR: begin
+          if (m_in_context_tvalid && m_in_context_tready) begin
+            ctx_insert          <= ctx_hdr_insert;
+            ctx_tag_word        <= 0;
+            ctx_tag_word[63:0]  <= { TAG_MARKER, reg_shift, reg_tag_id };
+            if (m_in_context_tlast) begin
+              ctx_state <= ctx_hdr_insert ? CTX_ST_TAG : CTX_ST_HDR;
+            end else begin
+              ctx_state <= CTX_ST_PASS;
+            end
+          end
+        end
+        CTX_ST_PASS: begin
+          if (m_in_context_tvalid && m_in_context_tready && m_in_context_tlast) begin
+            ctx_state <= ctx_insert ? CTX_ST_TAG : CTX_ST_HDR;
+          end
+        end
+        default: begin
+          if (s_out_context_tready) begin
+            ctx_state <= CTX_ST_HDR;
+          end
+        end
+      endcase
+    end
+  end
+
+endmodule // shiftright_core
+
+
+`default_nettype wire
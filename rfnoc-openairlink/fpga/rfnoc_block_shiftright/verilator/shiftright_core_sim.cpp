@@ -0,0 +1,648 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+// Verilator simulation of shiftright_core, the user logic of the Shiftright
+// block. Streams random sc16 packets with random stalls through the core,
+// changes the shift, the channel tag and the tag enable between and within
+// packets, and compares the output payload, the output context (with the tag
+// metadata) and the telemetry registers against a software reference.
+//
+// The inputs are fed like chdr_to_axis_pyld_ctxt in the NoC shell does: the
+// words of each packet are written in CHDR order, the context before the
+// payload, into a context and a payload FIFO of --fifo-depth entries each.
+// Packets with more context words than the FIFO holds only pass if the core
+// accepts the context of a packet before its payload.
+
+#include "Vshiftright_core.h"
+#include <verilated.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Register addresses, see shiftright_core.v
+const uint32_t REG_SHIFT        = 0;
+const uint32_t REG_STATS_WINDOW = 4;
+const uint32_t REG_STATS_COUNT  = 8;
+const uint32_t REG_STATS_POWER  = 12;
+const uint32_t REG_STATS_PEAK   = 16;
+const uint32_t REG_STATS_CLIP   = 20;
+const uint32_t REG_TAG_CTRL     = 24;
+const uint32_t REG_TAG_ID       = 28;
+const uint64_t TAG_MARKER       = 0x0A1C;
+
+// Context stream tuser values, see rfnoc_chdr_utils.vh
+const uint8_t CONTEXT_FIELD_HDR   = 0;
+const uint8_t CONTEXT_FIELD_TS    = 2;
+const uint8_t CONTEXT_FIELD_MDATA = 3;
+
+const size_t SPP            = 64;
+const uint32_t STATS_WINDOW = 12;
+const size_t MAX_ERRORS     = 10;
+// Cycles without any transfer until the core is reported as stalled
+const uint64_t MAX_IDLE     = 10000;
+
+/****************************************************************************
+ * One packet through the core and the state it is expected to see
+ ***************************************************************************/
+struct packet
+{
+    std::vector<uint32_t> samples;
+    std::vector<uint64_t> context;
+    std::vector<uint8_t> context_user;
+    // Cycle at which each sample is accepted
+    std::vector<uint64_t> in_cycles;
+    // Set when the context header is accepted. Without the tag, the shift is
+    // the register value at the first sample.
+    uint32_t shift  = 0;
+    bool tagged     = false;
+    uint32_t tag_id = 0;
+    // Words written into the input FIFOs
+    size_t wr_context = 0;
+    size_t wr_samps   = 0;
+    // Progress of the input and output streams
+    size_t in_samps   = 0;
+    size_t in_context = 0;
+    size_t out_samps  = 0;
+};
+
+uint64_t make_header(const size_t num_mdata, const bool has_ts, const uint16_t seq,
+    const size_t num_samps)
+{
+    const uint64_t pkt_type = has_ts ? 7 : 6;
+    const uint64_t length   = 8 * (1 + (has_ts ? 1 : 0) + num_mdata) + 4 * num_samps;
+    return (pkt_type << 53) | (uint64_t(num_mdata) << 48) | (uint64_t(seq) << 32)
+           | (length << 16) | 0x0001;
+}
+
+uint32_t shift_sample(const uint32_t sample, const uint32_t shift)
+{
+    // Verilog takes the shift amount as unsigned, 31 or more gives the sign only
+    const uint32_t amount = std::min<uint32_t>(shift & 0xFFFF, 31);
+    const int32_t i       = static_cast<int16_t>(sample >> 16) >> amount;
+    const int32_t q       = static_cast<int16_t>(sample & 0xFFFF) >> amount;
+    return (static_cast<uint32_t>(i & 0xFFFF) << 16) | static_cast<uint32_t>(q & 0xFFFF);
+}
+
+/****************************************************************************
+ * Telemetry reference, one window of 2^STATS_WINDOW samples
+ ***************************************************************************/
+struct stats_ref
+{
+    uint32_t count = 0, power = 0, peak = 0, clip = 0;
+    uint64_t acc_power = 0;
+    uint32_t acc_peak = 0, acc_clip = 0, acc_samps = 0;
+
+    void add(const uint32_t sample)
+    {
+        const int32_t i     = static_cast<int16_t>(sample >> 16);
+        const int32_t q     = static_cast<int16_t>(sample & 0xFFFF);
+        const uint32_t mag  = std::max(std::abs(i), std::abs(q));
+        acc_power += uint64_t(i * i) + uint64_t(q * q);
+        acc_peak = std::max(acc_peak, mag);
+        acc_clip += (std::abs(i) >= 32767 || std::abs(q) >= 32767) ? 1 : 0;
+        if (++acc_samps == (1u << STATS_WINDOW)) {
+            count++;
+            power     = static_cast<uint32_t>(acc_power >> STATS_WINDOW);
+            peak      = acc_peak;
+            clip      = acc_clip;
+            acc_power = 0;
+            acc_peak = acc_clip = acc_samps = 0;
+        }
+    }
+};
+
+/****************************************************************************
+ * Core with stream drivers and checkers
+ ***************************************************************************/
+class core_sim
+{
+public:
+    core_sim(VerilatedContext* context, const uint32_t seed, const double stall_prob,
+        const size_t fifo_depth)
+        : _top(new Vshiftright_core(context))
+        , _rng(seed)
+        , _stall(stall_prob)
+        , _fifo_depth(fifo_depth)
+    {
+        _top->ctrlport_rst  = 1;
+        _top->axis_data_rst = 1;
+        for (int k = 0; k < 16; k++) {
+            _cycle();
+        }
+        _top->ctrlport_rst  = 0;
+        _top->axis_data_rst = 0;
+        _cycle();
+    }
+
+    ~core_sim()
+    {
+        _top->final();
+    }
+
+    void reg_write(const uint32_t addr, const uint32_t data)
+    {
+        _top->s_ctrlport_req_wr   = 1;
+        _top->s_ctrlport_req_addr = addr;
+        _top->s_ctrlport_req_data = data;
+        _wait_ack();
+    }
+
+    uint32_t reg_read(const uint32_t addr)
+    {
+        _top->s_ctrlport_req_rd   = 1;
+        _top->s_ctrlport_req_addr = addr;
+        _wait_ack();
+        return _resp_data;
+    }
+
+    //! Queue a random packet for the input streams
+    void add_packet()
+    {
+        packet pkt;
+        const size_t num_samps = (_rng() % 8 == 0) ? 1 + _rng() % SPP : SPP;
+        for (size_t n = 0; n < num_samps; n++) {
+            // Some full scale values for the clip count
+            uint32_t sample = static_cast<uint32_t>(_rng());
+            if (_rng() % 256 == 0) {
+                sample = (sample & 0xFFFF) | 0x80000000;
+            }
+            pkt.samples.push_back(sample);
+        }
+        const bool has_ts        = _rng() % 2;
+        const size_t num_mdata   = (_rng() % 512 == 0) ? 31 : _rng() % 3;
+        pkt.context.push_back(make_header(num_mdata, has_ts, _seq++, num_samps));
+        pkt.context_user.push_back(CONTEXT_FIELD_HDR);
+        if (has_ts) {
+            pkt.context.push_back((uint64_t(_rng()) << 32) | _rng());
+            pkt.context_user.push_back(CONTEXT_FIELD_TS);
+        }
+        for (size_t n = 0; n < num_mdata; n++) {
+            pkt.context.push_back((uint64_t(_rng()) << 32) | _rng());
+            pkt.context_user.push_back(CONTEXT_FIELD_MDATA);
+        }
+        _packets.push_back(pkt);
+    }
+
+    size_t get_num_queued() const
+    {
+        return _packets.size();
+    }
+
+    //! Samples of the current input packet accepted so far, 0 between packets
+    size_t get_in_packet_samps() const
+    {
+        return (_in_pkt < _packets.size()) ? _packets[_in_pkt].in_samps : 0;
+    }
+
+    //! The current input packet has the tag, i.e. its shift is latched
+    bool get_in_packet_tagged() const
+    {
+        return _in_pkt < _packets.size() && _packets[_in_pkt].tagged;
+    }
+
+    //! No input sample and no context header is offered, i.e. no packet can
+    //! start before the next cycle
+    bool input_idle() const
+    {
+        return !_top->m_in_payload_tvalid && !_header_offered;
+    }
+
+    //! No context header is offered, i.e. no packet latches the registers
+    //! before the next cycle
+    bool header_idle() const
+    {
+        return !_header_offered;
+    }
+
+    //! Do not start new input packets, e.g. to change registers in between
+    void hold_input(const bool hold)
+    {
+        _hold = hold;
+    }
+
+    //! Run until all accepted samples are out
+    void drain()
+    {
+        while (_out_samps < _in_samps && _errors < MAX_ERRORS) {
+            _cycle();
+        }
+    }
+
+    //! Run until all queued packets are out
+    void flush()
+    {
+        while (!_packets.empty() && _errors < MAX_ERRORS) {
+            _cycle();
+        }
+    }
+
+    void run(const size_t num_cycles)
+    {
+        for (size_t k = 0; k < num_cycles; k++) {
+            _cycle();
+        }
+    }
+
+    // State the next packets will see, tracked by the driver
+    uint32_t shift  = 0;
+    bool tag_enable = false;
+    uint32_t tag_id = 0;
+
+    stats_ref stats;
+
+    size_t get_errors() const
+    {
+        return _errors;
+    }
+    uint64_t get_cycles() const
+    {
+        return _cycles;
+    }
+    uint64_t get_samps() const
+    {
+        return _out_samps;
+    }
+    uint64_t get_tags() const
+    {
+        return _num_tags;
+    }
+    //! Fewest cycles from the input to the output of a sample
+    uint64_t get_min_latency() const
+    {
+        return _min_latency;
+    }
+
+private:
+    void _error(const std::string& msg)
+    {
+        if (_errors++ < MAX_ERRORS) {
+            std::cout << "Error at cycle " << _cycles << ": " << msg << std::endl;
+        }
+    }
+
+    void _wait_ack()
+    {
+        _cycle();
+        _top->s_ctrlport_req_wr = 0;
+        _top->s_ctrlport_req_rd = 0;
+        for (int k = 0; k < 100; k++) {
+            if (_top->s_ctrlport_resp_ack) {
+                _resp_data = _top->s_ctrlport_resp_data;
+                _cycle();
+                return;
+            }
+            _cycle();
+        }
+        _error("No CtrlPort ack");
+    }
+
+    bool _stalled()
+    {
+        return _stall_dist(_rng) < _stall;
+    }
+
+    void _cycle()
+    {
+        // Drive the inputs from the FIFOs, valid stays up until the transfer
+        const bool pl_avail = _in_pkt < _packets.size()
+                              && _packets[_in_pkt].in_samps < _packets[_in_pkt].wr_samps
+                              && (_packets[_in_pkt].in_samps > 0 || !_hold);
+        if (!_top->m_in_payload_tvalid) {
+            _top->m_in_payload_tvalid = pl_avail && !_stalled();
+        }
+        if (_top->m_in_payload_tvalid) {
+            const packet& pkt          = _packets[_in_pkt];
+            _top->m_in_payload_tdata  = pkt.samples[pkt.in_samps];
+            _top->m_in_payload_tlast  = pkt.in_samps + 1 == pkt.samples.size();
+        }
+        const bool ctx_avail = _ctx_pkt < _packets.size()
+                               && _packets[_ctx_pkt].in_context < _packets[_ctx_pkt].wr_context
+                               && (_packets[_ctx_pkt].in_context > 0 || !_hold);
+        if (!_top->m_in_context_tvalid) {
+            _top->m_in_context_tvalid = ctx_avail && !_stalled();
+        }
+        _header_offered = false;
+        if (_top->m_in_context_tvalid) {
+            const packet& pkt         = _packets[_ctx_pkt];
+            _top->m_in_context_tdata = pkt.context[pkt.in_context];
+            _top->m_in_context_tuser = pkt.context_user[pkt.in_context];
+            _top->m_in_context_tlast = pkt.in_context + 1 == pkt.context.size();
+            _header_offered          = pkt.in_context == 0;
+        }
+        _top->s_out_payload_tready = !_stalled();
+        _top->s_out_context_tready = !_stalled();
+
+        _top->clk = 0;
+        _top->eval();
+
+        const bool pl_in   = _top->m_in_payload_tvalid && _top->m_in_payload_tready;
+        const bool ctx_in  = _top->m_in_context_tvalid && _top->m_in_context_tready;
+        const bool pl_out  = _top->s_out_payload_tvalid && _top->s_out_payload_tready;
+        const bool ctx_out = _top->s_out_context_tvalid && _top->s_out_context_tready;
+        // The input is booked first, with LOW_LATENCY a sample can leave the
+        // core in the cycle it enters
+        if (ctx_in && _packets[_ctx_pkt].in_context == 0) {
+            packet& pkt = _packets[_ctx_pkt];
+            pkt.shift   = shift;
+            pkt.tagged  = tag_enable;
+            pkt.tag_id  = tag_id;
+        }
+        if (pl_in) {
+            packet& pkt = _packets[_in_pkt];
+            if (pkt.in_samps == 0 && !pkt.tagged) {
+                pkt.shift = shift;
+            }
+            pkt.in_cycles.push_back(_cycles);
+            stats.add(pkt.samples[pkt.in_samps]);
+            _in_samps++;
+            if (++pkt.in_samps == pkt.samples.size()) {
+                _in_pkt++;
+            }
+        }
+        if (pl_out) {
+            _check_payload(_top->s_out_payload_tdata, _top->s_out_payload_tlast);
+        }
+        if (ctx_out) {
+            _check_context(_top->s_out_context_tdata, _top->s_out_context_tuser,
+                _top->s_out_context_tlast);
+        }
+
+        _top->clk = 1;
+        _top->eval();
+        _cycles++;
+
+        if (pl_in) {
+            _pl_queued--;
+            _top->m_in_payload_tvalid = 0;
+        }
+        if (ctx_in) {
+            packet& pkt = _packets[_ctx_pkt];
+            if (++pkt.in_context == pkt.context.size()) {
+                _ctx_pkt++;
+            }
+            _ctx_queued--;
+            _top->m_in_context_tvalid = 0;
+        }
+        _write_fifos();
+
+        if (pl_in || ctx_in || pl_out || ctx_out || _packets.empty()) {
+            _idle_cycles = 0;
+        } else if (++_idle_cycles == MAX_IDLE) {
+            _error("No transfer for " + std::to_string(MAX_IDLE) + " cycles, the core is stalled");
+            _idle_cycles = 0;
+        }
+
+        // Done packets leave the queue
+        while (!_packets.empty() && _out_pkt > 0 && _out_ctx_pkt > 0) {
+            _packets.pop_front();
+            _wr_pkt--;
+            _in_pkt--;
+            _ctx_pkt--;
+            _out_pkt--;
+            _out_ctx_pkt--;
+        }
+    }
+
+    //! Write the next word of the input packets in CHDR order, if its FIFO has space
+    void _write_fifos()
+    {
+        if (_wr_pkt >= _packets.size() || _stalled()) {
+            return;
+        }
+        packet& pkt = _packets[_wr_pkt];
+        if (pkt.wr_context < pkt.context.size()) {
+            if (_ctx_queued < _fifo_depth) {
+                pkt.wr_context++;
+                _ctx_queued++;
+            }
+        } else if (_pl_queued < _fifo_depth) {
+            if (++pkt.wr_samps == pkt.samples.size()) {
+                _wr_pkt++;
+            }
+            _pl_queued++;
+        }
+    }
+
+    void _check_payload(const uint32_t data, const bool last)
+    {
+        if (_out_pkt >= _packets.size() || _out_pkt >= _in_pkt + 1) {
+            _error("Output sample without input");
+            return;
+        }
+        packet& pkt         = _packets[_out_pkt];
+        const uint32_t in   = pkt.samples[pkt.out_samps];
+        const uint32_t exp  = shift_sample(in, pkt.shift);
+        if (data != exp) {
+            char msg[128];
+            std::snprintf(msg, sizeof(msg),
+                "Sample %zu, shift %u, received 0x%08X, expected 0x%08X, input 0x%08X",
+                pkt.out_samps, pkt.shift, data, exp, in);
+            _error(msg);
+        }
+        if (pkt.out_samps < pkt.in_cycles.size()) {
+            _min_latency = std::min(_min_latency, _cycles - pkt.in_cycles[pkt.out_samps]);
+        }
+        const bool exp_last = pkt.out_samps + 1 == pkt.samples.size();
+        if (last != exp_last) {
+            _error("Wrong payload tlast");
+        }
+        _out_samps++;
+        if (++pkt.out_samps == pkt.samples.size()) {
+            _out_pkt++;
+        }
+    }
+
+    void _check_context(const uint64_t data, const uint8_t user, const bool last)
+    {
+        _ctx_words.push_back(data);
+        _ctx_users.push_back(user);
+        if (!last) {
+            return;
+        }
+        if (_out_ctx_pkt >= _packets.size()) {
+            _error("Output context without input");
+            return;
+        }
+        const packet& pkt = _packets[_out_ctx_pkt];
+        std::vector<uint64_t> exp      = pkt.context;
+        std::vector<uint8_t> exp_users = pkt.context_user;
+        const uint64_t num_mdata       = (exp[0] >> 48) & 0x1F;
+        if (pkt.tagged && num_mdata < 31) {
+            const uint64_t length = (exp[0] >> 16) & 0xFFFF;
+            exp[0] = (exp[0] & ~((uint64_t(0x1F) << 48) | (uint64_t(0xFFFF) << 16)))
+                     | ((num_mdata + 1) << 48) | ((length + 8) << 16);
+            exp.push_back((TAG_MARKER << 48) | (uint64_t(pkt.shift & 0xFFFF) << 32) | pkt.tag_id);
+            exp_users.push_back(CONTEXT_FIELD_MDATA);
+            _num_tags++;
+        }
+        if (_ctx_words != exp || _ctx_users != exp_users) {
+            char msg[160];
+            std::snprintf(msg, sizeof(msg),
+                "Context of %zu words (header 0x%016llX), expected %zu words (header 0x%016llX), tagged %d",
+                _ctx_words.size(), static_cast<unsigned long long>(_ctx_words[0]), exp.size(),
+                static_cast<unsigned long long>(exp[0]), pkt.tagged ? 1 : 0);
+            _error(msg);
+        }
+        _ctx_words.clear();
+        _ctx_users.clear();
+        _out_ctx_pkt++;
+    }
+
+    std::unique_ptr<Vshiftright_core> _top;
+    std::mt19937 _rng;
+    std::uniform_real_distribution<double> _stall_dist{0.0, 1.0};
+    double _stall;
+    size_t _fifo_depth;
+    bool _hold           = false;
+    bool _header_offered = false;
+
+    std::deque<packet> _packets;
+    size_t _wr_pkt      = 0;
+    size_t _ctx_queued  = 0;
+    size_t _pl_queued   = 0;
+    size_t _in_pkt      = 0;
+    size_t _ctx_pkt     = 0;
+    size_t _out_pkt     = 0;
+    size_t _out_ctx_pkt = 0;
+    std::vector<uint64_t> _ctx_words;
+    std::vector<uint8_t> _ctx_users;
+    uint16_t _seq = 0;
+
+    uint32_t _resp_data = 0;
+    uint64_t _cycles    = 0;
+    uint64_t _in_samps  = 0;
+    uint64_t _out_samps = 0;
+    uint64_t _num_tags  = 0;
+    size_t _errors      = 0;
+    uint64_t _idle_cycles = 0;
+
+    uint64_t _min_latency = UINT64_MAX;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    uint64_t num_samps = 4000000;
+    uint32_t seed      = 1;
+    double stall_prob  = 0.25;
+    size_t fifo_depth  = 2;
+    for (int k = 1; k + 1 < argc; k += 2) {
+        if (std::strcmp(argv[k], "--nsamps") == 0) {
+            num_samps = std::strtoull(argv[k + 1], nullptr, 0);
+        } else if (std::strcmp(argv[k], "--seed") == 0) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[k + 1], nullptr, 0));
+        } else if (std::strcmp(argv[k], "--stall") == 0) {
+            stall_prob = std::strtod(argv[k + 1], nullptr);
+        } else if (std::strcmp(argv[k], "--fifo-depth") == 0) {
+            fifo_depth = std::max<size_t>(1, std::strtoul(argv[k + 1], nullptr, 0));
+        } else {
+            std::cout << "Usage: " << argv[0]
+                      << " [--nsamps N] [--seed S] [--stall probability] [--fifo-depth N]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::unique_ptr<VerilatedContext> context(new VerilatedContext);
+    core_sim sim(context.get(), seed, stall_prob, fifo_depth);
+    std::mt19937 rng(seed ^ 0x5EED);
+    const auto start = std::chrono::steady_clock::now();
+
+    // Default register values
+    if (sim.reg_read(REG_SHIFT) != 0 || sim.reg_read(REG_TAG_CTRL) != 0) {
+        std::cout << "Error: Wrong register defaults" << std::endl;
+        return EXIT_FAILURE;
+    }
+    sim.reg_write(REG_STATS_WINDOW, STATS_WINDOW);
+
+    size_t num_writes = 0;
+    while (sim.get_samps() < num_samps && sim.get_errors() < MAX_ERRORS) {
+        while (sim.get_num_queued() < 4) {
+            sim.add_packet();
+        }
+        sim.run(1);
+
+        const size_t in_samps = sim.get_in_packet_samps();
+        if (in_samps == 0 && sim.input_idle() && rng() % 16 == 0) {
+            // Between packets: drain, then change the shift and the tag
+            sim.hold_input(true);
+            sim.drain();
+            sim.shift = (rng() % 32 == 0) ? 0xFFFF : rng() % 20;
+            sim.reg_write(REG_SHIFT, sim.shift);
+            if (rng() % 4 == 0) {
+                sim.tag_enable = !sim.tag_enable;
+                sim.reg_write(REG_TAG_CTRL, sim.tag_enable ? 1 : 0);
+            }
+            sim.tag_id++;
+            sim.reg_write(REG_TAG_ID, sim.tag_id);
+            num_writes += 2;
+            sim.hold_input(false);
+        } else if (sim.get_in_packet_tagged() && in_samps >= 2 && sim.header_idle()
+                   && rng() % 64 == 0) {
+            // Within a tagged packet: the change applies from the next packet
+            sim.hold_input(true);
+            sim.shift = rng() % 20;
+            sim.tag_id++;
+            sim.reg_write(REG_SHIFT, sim.shift);
+            sim.reg_write(REG_TAG_ID, sim.tag_id);
+            num_writes += 2;
+            sim.hold_input(false);
+        }
+    }
+    sim.flush();
+    sim.run(8);
+
+    // Telemetry of the last complete window
+    const stats_ref& ref = sim.stats;
+    const uint32_t count = sim.reg_read(REG_STATS_COUNT);
+    const uint32_t power = sim.reg_read(REG_STATS_POWER);
+    const uint32_t peak  = sim.reg_read(REG_STATS_PEAK);
+    const uint32_t clip  = sim.reg_read(REG_STATS_CLIP);
+    bool stats_ok        = count == ref.count && power == ref.power && peak == ref.peak
+                    && clip == ref.clip;
+    if (!stats_ok) {
+        std::cout << "Error: Telemetry count/power/peak/clip " << count << "/" << power << "/"
+                  << peak << "/" << clip << ", expected " << ref.count << "/" << ref.power
+                  << "/" << ref.peak << "/" << ref.clip << std::endl;
+    }
+
+    const double wall_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << sim.get_samps() << " samples, " << num_writes << " register writes, "
+              << sim.get_tags() << " tags, " << count << " telemetry windows in "
+              << sim.get_cycles() << " cycles" << std::endl;
+    std::cout << "Minimum payload latency: " << sim.get_min_latency() << " cycles" << std::endl;
+    std::cout << "Simulated in " << wall_s << " s, " << (sim.get_samps() / wall_s / 1e6)
+              << " Msamples/s" << std::endl;
+
+    if (sim.get_errors() || !stats_ok) {
+        std::cout << "FAILED with " << sim.get_errors() << " errors" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "PASSED" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,365 @@
+//
+// Copyright 2024 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+//
+// Module: rfnoc_block_sum
+//
+// Description:
+//
+//   The Sum Block adds two sc16 streams sample by sample and saturates the
+//   result, e.g., to combine the paths of a MIMO channel matrix that end at
+//   the same receive antenna. The context (header and timestamp) of the
+//   output packets is taken from input 0, the context of input 1 is dropped.
+//
+// Parameters:
+//
+//   THIS_PORTID : Control crossbar port to which this block is connected
+//   CHDR_W      : AXIS-CHDR data bus width
+//   MTU         : Maximum transmission unit (i.e., maximum packet size in
+//                 CHDR words is 2**MTU).
+//
+
+`default_nettype none
+
+
+module rfnoc_block_sum #(
+  parameter [9:0] THIS_PORTID     = 10'd0,
+  parameter       CHDR_W          = 64,
+  parameter [5:0] MTU             = 10
+)(
+  // RFNoC Framework Clocks and Resets
+  input  wire                   rfnoc_chdr_clk,
+  input  wire                   rfnoc_ctrl_clk,
+  input  wire                   ce_clk,
+  // RFNoC Backend Interface
+  input  wire [511:0]           rfnoc_core_config,
+  output wire [511:0]           rfnoc_core_status,
+  // AXIS-CHDR Input Ports (from framework)
+  input  wire [(2)*CHDR_W-1:0] s_rfnoc_chdr_tdata,
+  input  wire [(2)-1:0]        s_rfnoc_chdr_tlast,
+  input  wire [(2)-1:0]        s_rfnoc_chdr_tvalid,
+  output wire [(2)-1:0]        s_rfnoc_chdr_tready,
+  // AXIS-CHDR Output Ports (to framework)
+  output wire [(1)*CHDR_W-1:0] m_rfnoc_chdr_tdata,
+  output wire [(1)-1:0]        m_rfnoc_chdr_tlast,
+  output wire [(1)-1:0]        m_rfnoc_chdr_tvalid,
+  input  wire [(1)-1:0]        m_rfnoc_chdr_tready,
+  // AXIS-Ctrl Input Port (from framework)
+  input  wire [31:0]            s_rfnoc_ctrl_tdata,
+  input  wire                   s_rfnoc_ctrl_tlast,
+  input  wire                   s_rfnoc_ctrl_tvalid,
+  output wire                   s_rfnoc_ctrl_tready,
+  // AXIS-Ctrl Output Port (to framework)
+  output wire [31:0]            m_rfnoc_ctrl_tdata,
+  output wire                   m_rfnoc_ctrl_tlast,
+  output wire                   m_rfnoc_ctrl_tvalid,
+  input  wire                   m_rfnoc_ctrl_tready
+);
+
+  `define RFNOC_CHDR_UTILS_PATH `"`UHD_FPGA_DIR/usrp3/lib/rfnoc/core/rfnoc_chdr_utils.vh`"
+  `include `RFNOC_CHDR_UTILS_PATH
+
+  //---------------------------------------------------------------------------
+  // Signal Declarations
+  //---------------------------------------------------------------------------
+
+  // Clocks and Resets
+  wire               ctrlport_clk;
+  wire               ctrlport_rst;
+  wire               axis_data_clk;
+  wire               axis_data_rst;
+  // CtrlPort Master
+  wire               m_ctrlport_req_wr;
+  wire               m_ctrlport_req_rd;
+  wire [19:0]        m_ctrlport_req_addr;
+  wire [31:0]        m_ctrlport_req_data;
+  reg                m_ctrlport_resp_ack;
+  reg  [31:0]        m_ctrlport_resp_data;
+  // Payload Stream to User Logic: in0
+  wire [32*1-1:0]    m_in0_payload_tdata;
+  wire [1-1:0]       m_in0_payload_tkeep;
+  wire               m_in0_payload_tlast;
+  wire               m_in0_payload_tvalid;
+  wire               m_in0_payload_tready;
+  // Context Stream to User Logic: in0
+  wire [CHDR_W-1:0]  m_in0_context_tdata;
+  wire [3:0]         m_in0_context_tuser;
+  wire               m_in0_context_tlast;
+  wire               m_in0_context_tvalid;
+  wire               m_in0_context_tready;
+  // Payload Stream to User Logic: in1
+  wire [32*1-1:0]    m_in1_payload_tdata;
+  wire [1-1:0]       m_in1_payload_tkeep;
+  wire               m_in1_payload_tlast;
+  wire               m_in1_payload_tvalid;
+  wire               m_in1_payload_tready;
+  // Context Stream to User Logic: in1
+  wire [CHDR_W-1:0]  m_in1_context_tdata;
+  wire [3:0]         m_in1_context_tuser;
+  wire               m_in1_context_tlast;
+  wire               m_in1_context_tvalid;
+  wire               m_in1_context_tready;
+  // Payload Stream from User Logic: out
+  wire [32*1-1:0]    s_out_payload_tdata;
+  wire [0:0]         s_out_payload_tkeep;
+  wire               s_out_payload_tlast;
+  wire               s_out_payload_tvalid;
+  wire               s_out_payload_tready;
+  // Context Stream from User Logic: out
+  wire [CHDR_W-1:0]  s_out_context_tdata;
+  wire [3:0]         s_out_context_tuser;
+  wire               s_out_context_tlast;
+  wire               s_out_context_tvalid;
+  wire               s_out_context_tready;
+
+  //---------------------------------------------------------------------------
+  // NoC Shell
+  //---------------------------------------------------------------------------
+
+  noc_shell_sum #(
+    .CHDR_W              (CHDR_W),
+    .THIS_PORTID         (THIS_PORTID),
+    .MTU                 (MTU)
+  ) noc_shell_sum_i (
+    //---------------------
+    // Framework Interface
+    //---------------------
+
+    // Clock Inputs
+    .rfnoc_chdr_clk      (rfnoc_chdr_clk),
+    .rfnoc_ctrl_clk      (rfnoc_ctrl_clk),
+    .ce_clk              (ce_clk),
+    // Reset Outputs
+    .rfnoc_chdr_rst      (),
+    .rfnoc_ctrl_rst      (),
+    .ce_rst              (),
+    // RFNoC Backend Interface
+    .rfnoc_core_config   (rfnoc_core_config),
+    .rfnoc_core_status   (rfnoc_core_status),
+    // CHDR Input Ports  (from framework)
+    .s_rfnoc_chdr_tdata  (s_rfnoc_chdr_tdata),
+    .s_rfnoc_chdr_tlast  (s_rfnoc_chdr_tlast),
+    .s_rfnoc_chdr_tvalid (s_rfnoc_chdr_tvalid),
+    .s_rfnoc_chdr_tready (s_rfnoc_chdr_tready),
+    // CHDR Output Ports (to framework)
+    .m_rfnoc_chdr_tdata  (m_rfnoc_chdr_tdata),
+    .m_rfnoc_chdr_tlast  (m_rfnoc_chdr_tlast),
+    .m_rfnoc_chdr_tvalid (m_rfnoc_chdr_tvalid),
+    .m_rfnoc_chdr_tready (m_rfnoc_chdr_tready),
+    // AXIS-Ctrl Input Port (from framework)
+    .s_rfnoc_ctrl_tdata  (s_rfnoc_ctrl_tdata),
+    .s_rfnoc_ctrl_tlast  (s_rfnoc_ctrl_tlast),
+    .s_rfnoc_ctrl_tvalid (s_rfnoc_ctrl_tvalid),
+    .s_rfnoc_ctrl_tready (s_rfnoc_ctrl_tready),
+    // AXIS-Ctrl Output Port (to framework)
+    .m_rfnoc_ctrl_tdata  (m_rfnoc_ctrl_tdata),
+    .m_rfnoc_ctrl_tlast  (m_rfnoc_ctrl_tlast),
+    .m_rfnoc_ctrl_tvalid (m_rfnoc_ctrl_tvalid),
+    .m_rfnoc_ctrl_tready (m_rfnoc_ctrl_tready),
+
+    //---------------------
+    // Client Interface
+    //---------------------
+
+    // CtrlPort Clock and Reset
+    .ctrlport_clk              (ctrlport_clk),
+    .ctrlport_rst              (ctrlport_rst),
+    // CtrlPort Master
+    .m_ctrlport_req_wr         (m_ctrlport_req_wr),
+    .m_ctrlport_req_rd         (m_ctrlport_req_rd),
+    .m_ctrlport_req_addr       (m_ctrlport_req_addr),
+    .m_ctrlport_req_data       (m_ctrlport_req_data),
+    .m_ctrlport_resp_ack       (m_ctrlport_resp_ack),
+    .m_ctrlport_resp_data      (m_ctrlport_resp_data),
+
+    // AXI-Stream Payload Context Clock and Reset
+    .axis_data_clk (axis_data_clk),
+    .axis_data_rst (axis_data_rst),
+    // Payload Stream to User Logic: in0
+    .m_in0_payload_tdata  (m_in0_payload_tdata),
+    .m_in0_payload_tkeep  (m_in0_payload_tkeep),
+    .m_in0_payload_tlast  (m_in0_payload_tlast),
+    .m_in0_payload_tvalid (m_in0_payload_tvalid),
+    .m_in0_payload_tready (m_in0_payload_tready),
+    // Context Stream to User Logic: in0
+    .m_in0_context_tdata  (m_in0_context_tdata),
+    .m_in0_context_tuser  (m_in0_context_tuser),
+    .m_in0_context_tlast  (m_in0_context_tlast),
+    .m_in0_context_tvalid (m_in0_context_tvalid),
+    .m_in0_context_tready (m_in0_context_tready),
+    // Payload Stream to User Logic: in1
+    .m_in1_payload_tdata  (m_in1_payload_tdata),
+    .m_in1_payload_tkeep  (m_in1_payload_tkeep),
+    .m_in1_payload_tlast  (m_in1_payload_tlast),
+    .m_in1_payload_tvalid (m_in1_payload_tvalid),
+    .m_in1_payload_tready (m_in1_payload_tready),
+    // Context Stream to User Logic: in1
+    .m_in1_context_tdata  (m_in1_context_tdata),
+    .m_in1_context_tuser  (m_in1_context_tuser),
+    .m_in1_context_tlast  (m_in1_context_tlast),
+    .m_in1_context_tvalid (m_in1_context_tvalid),
+    .m_in1_context_tready (m_in1_context_tready),
+    // Payload Stream from User Logic: out
+    .s_out_payload_tdata  (s_out_payload_tdata),
+    .s_out_payload_tkeep  (s_out_payload_tkeep),
+    .s_out_payload_tlast  (s_out_payload_tlast),
+    .s_out_payload_tvalid (s_out_payload_tvalid),
+    .s_out_payload_tready (s_out_payload_tready),
+    // Context Stream from User Logic: out
+    .s_out_context_tdata  (s_out_context_tdata),
+    .s_out_context_tuser  (s_out_context_tuser),
+    .s_out_context_tlast  (s_out_context_tlast),
+    .s_out_context_tvalid (s_out_context_tvalid),
+    .s_out_context_tready (s_out_context_tready)
+  );
+
+  //---------------------------------------------------------------------------
+  // User Registers
+  //---------------------------------------------------------------------------
+  //
+  // REG_SAT_COUNT : Number of output samples where I or Q saturated since the
+  //                 last clear. Read-only, any write clears the counter.
+  //
+  //---------------------------------------------------------------------------
+
+  localparam REG_SAT_COUNT_ADDR = 0; // Address saturation counter register
+
+  reg  [31:0] reg_sat_count = 0;
+  wire        sat_event;
+
+  always @(posedge ctrlport_clk) begin
+    if (ctrlport_rst) begin
+      reg_sat_count <= 0;
+    end else begin
+      // Default assignment
+      m_ctrlport_resp_ack <= 0;
+
+      // Count saturated samples, stop at the maximum
+      if (sat_event && reg_sat_count != 32'hFFFF_FFFF) begin
+        reg_sat_count <= reg_sat_count + 1;
+      end
+
+      // Read user register
+      if (m_ctrlport_req_rd) begin // Read request
+        case (m_ctrlport_req_addr)
+          REG_SAT_COUNT_ADDR: begin
+            m_ctrlport_resp_ack  <= 1;
+            m_ctrlport_resp_data <= reg_sat_count;
+          end
+        endcase
+      end
+
+      // Write user register
+      if (m_ctrlport_req_wr) begin // Write requst
+        case (m_ctrlport_req_addr)
+          REG_SAT_COUNT_ADDR: begin
+            m_ctrlport_resp_ack <= 1;
+            reg_sat_count       <= 0;
+          end
+        endcase
+      end
+    end
+  end
+
+  //---------------------------------------------------------------------------
+  // User Logic
+  //---------------------------------------------------------------------------
+  //
+  // User logic uses the axis_data_clk clock, which is the same as the
+  // ctrlport_clk clock (both are ce_clk), so no clock crossing is needed.
+  //
+  // Both inputs are joined: a sample is only consumed when both inputs have
+  // one, so the streams stay aligned sample by sample.
+  //
+  //---------------------------------------------------------------------------
+
+  wire join_tvalid = m_in0_payload_tvalid && m_in1_payload_tvalid;
+  wire join_tready;
+
+  assign m_in0_payload_tready = join_tready && m_in1_payload_tvalid;
+  assign m_in1_payload_tready = join_tready && m_in0_payload_tvalid;
+
+  wire [31:0] pipe_in0_tdata, pipe_in1_tdata;
+  wire pipe_in_tvalid, pipe_in_tlast;
+  wire pipe_in_tready;
+
+  wire [31:0] pipe_out_tdata;
+  wire pipe_out_tvalid, pipe_out_tlast;
+  wire pipe_out_tready;
+
+  // Adding FIFO to ensure Pipeline
+  axi_fifo #(
+    .WIDTH (32+32+1),
+    .SIZE  (0)
+  )
+  pipeline0_axi_fifo (
+    .clk      (ce_clk),
+    .reset    (0),
+    .clear    (0),
+    .i_tdata  ({m_in0_payload_tlast, m_in0_payload_tdata, m_in1_payload_tdata}),
+    .i_tvalid (join_tvalid),
+    .i_tready (join_tready),
+    .o_tdata  ({pipe_in_tlast, pipe_in0_tdata, pipe_in1_tdata}),
+    .o_tvalid (pipe_in_tvalid),
+    .o_tready (pipe_in_tready)
+  );
+
+  wire signed [15:0] i0 = pipe_in0_tdata[31:16];
+  wire signed [15:0] q0 = pipe_in0_tdata[15:0];
+  wire signed [15:0] i1 = pipe_in1_tdata[31:16];
+  wire signed [15:0] q1 = pipe_in1_tdata[15:0];
+
+  wire signed [16:0] i_sum = i0 + i1;
+  wire signed [16:0] q_sum = q0 + q1;
+
+  // Saturate to sc16, the sum overflowed if the two MSBs differ
+  wire i_sat = i_sum[16] ^ i_sum[15];
+  wire q_sat = q_sum[16] ^ q_sum[15];
+
+  wire [15:0] i_out = i_sat ? {i_sum[16], {15{~i_sum[16]}}} : i_sum[15:0];
+  wire [15:0] q_out = q_sat ? {q_sum[16], {15{~q_sum[16]}}} : q_sum[15:0];
+
+  wire [31:0] sum_data = {i_out, q_out};
+
+  assign sat_event = pipe_in_tvalid && pipe_in_tready && (i_sat || q_sat);
+
+  axi_fifo #(
+    .WIDTH (32+1),
+    .SIZE  (0)
+  )
+  pipeline1_axi_fifo (
+    .clk(ce_clk),
+    .reset    (0),
+    .clear    (0),
+    .i_tdata  ({pipe_in_tlast, sum_data}),
+    .i_tvalid (pipe_in_tvalid),
+    .i_tready (pipe_in_tready),
+    .o_tdata  ({pipe_out_tlast, pipe_out_tdata}),
+    .o_tvalid (pipe_out_tvalid),
+    .o_tready (pipe_out_tready)
+  );
+
+
+  // Summed sample data
+  assign s_out_payload_tdata  = pipe_out_tdata;
+  assign s_out_payload_tlast  = pipe_out_tlast;
+  assign s_out_payload_tvalid = pipe_out_tvalid;
+  assign pipe_out_tready      = s_out_payload_tready;
+
+  // Context data, the output packets use the header and timestamp of input 0.
+  // The context of input 1 is consumed and dropped.
+  assign s_out_context_tdata  = m_in0_context_tdata;
+  assign s_out_context_tuser  = m_in0_context_tuser;
+  assign s_out_context_tlast  = m_in0_context_tlast;
+  assign s_out_context_tvalid = m_in0_context_tvalid;
+  assign m_in0_context_tready = s_out_context_tready;
+  assign m_in1_context_tready = 1'b1;
+
+  // Only 1-sample per clock, so tkeep should always be asserted
+  assign s_out_payload_tkeep = 1'b1;
+
+endmodule // rfnoc_block_sum
+
+
+`default_nettype wire
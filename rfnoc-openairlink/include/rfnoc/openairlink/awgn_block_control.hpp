@@ -0,0 +1,73 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_AWGN_BLOCK_CONTROL_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_AWGN_BLOCK_CONTROL_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/rfnoc/noc_block_base.hpp>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Block controller for the AWGN block: adds Gaussian noise to the signal
+ *
+ * The noise level is controlled by a scale register, the noise standard
+ * deviation per component is scale/4 LSBs. Noise powers are given in dBFS,
+ * relative to a full scale complex sinusoid.
+ */
+class UHD_API awgn_block_control : public uhd::rfnoc::noc_block_base
+{
+public:
+    RFNOC_DECLARE_BLOCK(awgn_block_control)
+
+    //! The register address of the noise scale
+    static const uint32_t REG_NOISE_SCALE;
+    //! The register address of the noise seed
+    static const uint32_t REG_NOISE_SEED;
+
+    /*! Set the noise scale register, 0 disables the noise
+     */
+    virtual void set_noise_scale(const uint32_t noise_scale) = 0;
+
+    /*! Get the current noise scale (read it from the device)
+     */
+    virtual uint32_t get_noise_scale() = 0;
+
+    /*! Set the noise power in dBFS
+     *
+     * \returns the actual noise power after quantization of the scale
+     */
+    virtual double set_noise_power(const double noise_dbfs) = 0;
+
+    /*! Get the current noise power in dBFS (read it from the device)
+     */
+    virtual double get_noise_power() = 0;
+
+    /*! Set the noise power for a given SNR
+     *
+     * \param snr_db SNR in dB, an infinite SNR disables the noise
+     * \param signal_dbfs Power of the signal at the block input in dBFS
+     * \returns the actual SNR after quantization of the scale
+     */
+    virtual double set_snr(const double snr_db, const double signal_dbfs) = 0;
+
+    /*! Reload the noise generator with a seed
+     */
+    virtual void set_seed(const uint32_t seed) = 0;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_AWGN_BLOCK_CONTROL_HPP */
@@ -0,0 +1,92 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_AWGN_MODEL_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_AWGN_MODEL_HPP
+
+#include <uhd/config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Bit-exact software model of the AWGN block datapath
+ *
+ * Mirrors awgn_gen.v and the saturating adder in rfnoc_block_awgn.v, so that
+ * the output of the block can be reproduced on the host for a given seed,
+ * noise scale and input sequence. Samples are sc16 packed as {I, Q} in one
+ * 32-bit word, like on the FPGA.
+ */
+class UHD_API awgn_model
+{
+public:
+    //! Number of uniform generators summed per noise value
+    static const size_t NUM_URNG;
+    //! Right shift applied after scaling, noise sigma is scale / 2^(SCALE_SHIFT-16)
+    static const int SCALE_SHIFT;
+    //! Largest value of the noise scale register
+    static const uint32_t MAX_NOISE_SCALE;
+
+    awgn_model(const uint32_t seed = 0, const uint32_t noise_scale = 0);
+
+    /*! Reload the generator, like a write to the seed register does
+     */
+    void set_seed(const uint32_t seed);
+
+    /*! Set the noise scale register value
+     */
+    void set_noise_scale(const uint32_t noise_scale);
+
+    uint32_t get_noise_scale() const;
+
+    /*! Get the next noise value and advance the generator by one sample
+     */
+    void next_noise(int32_t& noise_i, int32_t& noise_q);
+
+    /*! Add noise to one sc16 sample and advance the generator
+     */
+    uint32_t process(const uint32_t sample);
+
+    /*! Add noise to a block of sc16 samples
+     */
+    void process(const std::vector<uint32_t>& in, std::vector<uint32_t>& out);
+
+    /*! Noise scale register value for a complex noise power in dBFS
+     *
+     * The power is relative to a full scale complex sinusoid (|x| = 32767).
+     * Values that would exceed the register range are clipped. An infinite
+     * negative power returns 0, i.e., noise off.
+     */
+    static uint32_t noise_scale_from_dbfs(const double noise_dbfs);
+
+    /*! Complex noise power in dBFS for a noise scale register value
+     */
+    static double dbfs_from_noise_scale(const uint32_t noise_scale);
+
+private:
+    void _step();
+
+    std::vector<uint32_t> _state;
+    uint32_t _psum_i[3];
+    uint32_t _psum_q[3];
+    int32_t _g_i, _g_q;
+    int32_t _n_i, _n_q;
+    uint32_t _noise_scale;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_AWGN_MODEL_HPP */
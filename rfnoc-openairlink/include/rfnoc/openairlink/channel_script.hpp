@@ -0,0 +1,60 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_CHANNEL_SCRIPT_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_CHANNEL_SCRIPT_HPP
+
+#include <uhd/config.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rfnoc { namespace openairlink {
+
+/*! One step of a single link channel script
+ *
+ * The CSV format is "time, taps, shift[, snr, ...]" with space separated
+ * taps, the same as the script lines of oal_single.
+ */
+struct UHD_API channel_step
+{
+    //! Time of the step in seconds, relative to the start of the script
+    double time;
+    std::vector<int16_t> coeffs;
+    uint32_t shiftright;
+    //! Optional SNR per link in dB, empty to keep the noise setting
+    std::vector<double> snr_db;
+
+    //! Pass-through channel: a single tap of 32767 and no shift
+    channel_step();
+
+    /*! Parse a step from a CSV line
+     *
+     * \throws uhd::value_error if a field is missing or out of range
+     */
+    static channel_step from_csv(const std::string& line);
+};
+
+/*! Read all steps of a script file up to the "eos" line
+ *
+ * \throws uhd::value_error if the file can't be read, a line is invalid or the
+ *         step times don't strictly ascend
+ */
+UHD_API std::vector<channel_step> load_channel_script(const std::string& path);
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_CHANNEL_SCRIPT_HPP */
@@ -0,0 +1,194 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_CHANNEL_TRACE_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_CHANNEL_TRACE_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/rfnoc/fir_filter_block_control.hpp>
+#include <uhd/rfnoc/mb_controller.hpp>
+#include <rfnoc/openairlink/awgn_block_control.hpp>
+#include <rfnoc/openairlink/shiftright_block_control.hpp>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Blocks of one emulated link, stored in the trace header
+ */
+struct UHD_API channel_trace_link
+{
+    std::string fir_id;
+    std::string shiftright_id;
+};
+
+/*! One applied channel state of a link
+ */
+struct UHD_API channel_record
+{
+    //! Device time in ticks of the timekeeper, read after the state was written
+    uint64_t device_ticks;
+    //! Host time in ns since the epoch (system clock)
+    int64_t host_ns;
+    //! Index into the links of the trace header
+    uint16_t link;
+    uint32_t shiftright;
+    uint32_t shiftright_readback;
+    //! Noise scale of the AWGN block, NO_NOISE_SCALE without AWGN block
+    uint32_t noise_scale;
+    std::vector<int16_t> coeffs;
+    std::vector<int16_t> coeffs_readback;
+
+    static const uint32_t NO_NOISE_SCALE;
+
+    channel_record();
+
+    /*! True if the readback matches the written state
+     *
+     * The FIR reads back all its taps, taps beyond the written ones must be
+     * zero.
+     */
+    bool readback_ok() const;
+};
+
+/*! Binary recorder of applied channel states
+ *
+ * The file starts with the magic "OALTRACE", a format version, the tick rate
+ * and the block IDs of the links, followed by one variable length record per
+ * applied state. All values are little endian. Records are buffered, so
+ * writing one costs a copy into memory.
+ */
+class UHD_API channel_trace_writer
+{
+public:
+    /*!
+     * \throws uhd::runtime_error if the file can't be created
+     */
+    channel_trace_writer(const std::string& path,
+        const double tick_rate,
+        const std::vector<channel_trace_link>& links);
+
+    void write(const channel_record& record);
+
+    void flush();
+
+private:
+    std::vector<char> _buffer;
+    std::ofstream _file;
+};
+
+/*! Reader for files of channel_trace_writer
+ */
+class UHD_API channel_trace_reader
+{
+public:
+    /*!
+     * \throws uhd::runtime_error if the file can't be read or has no valid header
+     */
+    channel_trace_reader(const std::string& path);
+
+    double get_tick_rate() const;
+
+    const std::vector<channel_trace_link>& get_links() const;
+
+    /*! Read the next record
+     *
+     * \returns false at the end of the file
+     * \throws uhd::runtime_error if the file ends within a record
+     */
+    bool read(channel_record& record);
+
+    //! Read all remaining records
+    std::vector<channel_record> read_all();
+
+private:
+    std::ifstream _file;
+    double _tick_rate;
+    std::vector<channel_trace_link> _links;
+};
+
+/*! Blocks of one emulated link, the AWGN block is optional
+ */
+struct UHD_API link_blocks
+{
+    uhd::rfnoc::fir_filter_block_control::sptr fir;
+    shiftright_block_control::sptr sr;
+    awgn_block_control::sptr awgn;
+};
+
+/*! Records the applied channel states of the links into a channel trace
+ *
+ * A record is written when the written or read back state of a link
+ * changes. The readback comes from the device: the recorder enables the
+ * readback verification of the Shiftright blocks.
+ */
+class UHD_API state_recorder
+{
+public:
+    /*!
+     * \param ids Block IDs of the links, stored in the trace header
+     * \param links Blocks of the links, in the same order as \p ids
+     * \throws uhd::runtime_error if the file can't be created
+     */
+    state_recorder(const std::string& path,
+        uhd::rfnoc::mb_controller::timekeeper::sptr tk,
+        const std::vector<channel_trace_link>& ids,
+        const std::vector<link_blocks>& links);
+
+    ~state_recorder();
+
+    /*! Read back the state of a link and record it if it changed
+     *
+     * \param link_idx Index into the links
+     * \param coeffs Written taps
+     * \param shift Written shift
+     */
+    void record(const size_t link_idx, const std::vector<int16_t>& coeffs, const uint32_t shift);
+
+    size_t get_num_records() const;
+
+private:
+    channel_trace_writer _trace;
+    uhd::rfnoc::mb_controller::timekeeper::sptr _tk;
+    std::vector<link_blocks> _links;
+    std::vector<channel_record> _last;
+    size_t _num_records = 0;
+};
+
+/*! Replay a channel trace with the timing of the recording
+ *
+ * The records are written at the same device time offsets from the first
+ * record. Records of links that don't exist are skipped.
+ *
+ * \param ids Block IDs of the links, compared with the trace header
+ * \param links Blocks to write the records to, in the same order as \p ids
+ * \param recorder Records the replayed states, may be nullptr
+ * \param stop Stops the replay when it becomes true, e.g., set by a signal handler
+ * \throws uhd::runtime_error if the trace can't be read
+ */
+UHD_API void replay_trace(const std::string& path,
+    uhd::rfnoc::mb_controller::timekeeper::sptr tk,
+    const std::vector<channel_trace_link>& ids,
+    const std::vector<link_blocks>& links,
+    state_recorder* recorder,
+    const std::atomic<bool>& stop);
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_CHANNEL_TRACE_HPP */
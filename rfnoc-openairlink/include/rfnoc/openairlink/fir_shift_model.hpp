@@ -0,0 +1,77 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_FIR_SHIFT_MODEL_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_FIR_SHIFT_MODEL_HPP
+
+#include <uhd/config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Bit-exact software model of one FIR -> Shiftright path
+ *
+ * The FIR part follows the UHD FIR filter block: 16-bit coefficients, full
+ * precision accumulation, then rounding (half up) by 2^15 and clipping to
+ * 16 bits, so a tap of 32767 is (almost) unity gain. The Shiftright part is
+ * an arithmetic right shift of I and Q like rfnoc_block_shiftright.v.
+ *
+ * Samples are sc16 packed as {I, Q} in one 32-bit word, like on the FPGA.
+ * The delay line starts with zeros and is kept across calls to process().
+ */
+class UHD_API fir_shift_model
+{
+public:
+    //! Right shift of the FIR accumulator (coefficients are Q1.15)
+    static const int FIR_SHIFT;
+
+    fir_shift_model(const std::vector<int16_t>& coeffs = std::vector<int16_t>(1, 32767),
+        const uint32_t shiftright = 0);
+
+    void set_coefficients(const std::vector<int16_t>& coeffs);
+
+    const std::vector<int16_t>& get_coefficients() const;
+
+    void set_shiftright_value(const uint32_t shiftright);
+
+    uint32_t get_shiftright_value() const;
+
+    /*! Clear the delay line
+     */
+    void reset();
+
+    /*! Filter and shift one sc16 sample
+     */
+    uint32_t process(const uint32_t sample);
+
+    /*! Filter and shift a block of sc16 samples, in and out may be equal
+     */
+    void process(const uint32_t* in, uint32_t* out, const size_t nsamps);
+
+private:
+    void _resize_history();
+
+    std::vector<int16_t> _coeffs;
+    uint32_t _shiftright;
+    //! Input history (at least num_taps - 1 samples), then the current block
+    std::vector<int32_t> _buf_i;
+    std::vector<int32_t> _buf_q;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_FIR_SHIFT_MODEL_HPP */
@@ -0,0 +1,161 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_METRICS_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_METRICS_HPP
+
+#include <uhd/config.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Monotonic counter, e.g. number of channel updates
+ */
+class UHD_API metric_counter
+{
+public:
+    void inc(const uint64_t n = 1);
+    uint64_t get() const;
+
+private:
+    std::atomic<uint64_t> _value{0};
+};
+
+/*! Value that goes up and down, e.g. the current shift
+ */
+class UHD_API metric_gauge
+{
+public:
+    void set(const double value);
+    void add(const double delta);
+    double get() const;
+
+private:
+    std::atomic<double> _value{0.0};
+};
+
+/*! Histogram with fixed buckets, e.g. of the control call latency
+ *
+ * A value falls into the first bucket with an upper bound >= the value,
+ * values above the last bound into the +Inf bucket.
+ */
+class UHD_API metric_histogram
+{
+public:
+    /*!
+     * \param bounds Upper bounds of the buckets in ascending order
+     * \throws uhd::value_error if the bounds are empty or not ascending
+     */
+    explicit metric_histogram(const std::vector<double>& bounds);
+
+    void observe(const double value);
+
+    const std::vector<double>& get_bounds() const;
+
+    /*! Count of one bucket (not cumulative), idx == number of bounds is +Inf
+     */
+    uint64_t get_bucket(const size_t idx) const;
+
+    uint64_t get_count() const;
+    double get_sum() const;
+
+private:
+    const std::vector<double> _bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> _buckets;
+    std::atomic<uint64_t> _count{0};
+    std::atomic<double> _sum{0.0};
+};
+
+/*! Metrics of a running emulator, exported in the Prometheus text format
+ *
+ * The metrics are created once at setup. Their updates are single atomic
+ * operations without locks or allocation, so the control loop can update
+ * them on every step. Only creating metrics and render() take the lock of
+ * the registry.
+ *
+ * Metrics with the same name form a family and differ by their labels,
+ * given as Prometheus label pairs, e.g. `link="link0"`. The returned
+ * references stay valid for the lifetime of the registry.
+ */
+class UHD_API metrics_registry
+{
+public:
+    /*! Get or create a counter
+     *
+     * \throws uhd::value_error if the name has metrics of another type
+     */
+    metric_counter& add_counter(
+        const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /*! Get or create a gauge
+     *
+     * \throws uhd::value_error if the name has metrics of another type
+     */
+    metric_gauge& add_gauge(
+        const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /*! Get or create a histogram, an existing one keeps its bounds
+     *
+     * \throws uhd::value_error if the name has metrics of another type
+     */
+    metric_histogram& add_histogram(const std::string& name,
+        const std::string& help,
+        const std::vector<double>& bounds,
+        const std::string& labels = "");
+
+    /*! All metrics in the Prometheus text exposition format
+     */
+    std::string render() const;
+
+    /*! Bucket bounds start, start*factor, ... with count bounds
+     */
+    static std::vector<double> exponential_buckets(
+        const double start, const double factor, const size_t count);
+
+private:
+    struct series_t
+    {
+        std::string labels;
+        std::unique_ptr<metric_counter> counter;
+        std::unique_ptr<metric_gauge> gauge;
+        std::unique_ptr<metric_histogram> histogram;
+    };
+
+    struct family_t
+    {
+        std::string name;
+        std::string help;
+        std::string type;
+        std::vector<series_t> series;
+    };
+
+    series_t& _get_series(const std::string& name,
+        const std::string& help,
+        const std::string& type,
+        const std::string& labels);
+
+    mutable std::mutex _mutex;
+    std::vector<family_t> _families;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_METRICS_HPP */
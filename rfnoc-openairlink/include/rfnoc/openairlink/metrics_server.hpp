@@ -0,0 +1,73 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_METRICS_SERVER_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_METRICS_SERVER_HPP
+
+#include <uhd/config.hpp>
+#include <rfnoc/openairlink/metrics.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Serves a metrics registry to Prometheus over HTTP
+ *
+ * Every request gets the rendered registry as the response, whatever its
+ * path. The server listens on a TCP port of the loopback interface only, or
+ * on a Unix socket (e.g. for `curl --unix-socket`). It runs in its own
+ * thread and handles one request at a time, the metrics are rendered per
+ * request.
+ */
+class UHD_API metrics_server
+{
+public:
+    /*! Listen on 127.0.0.1:port
+     *
+     * \throws uhd::runtime_error if the port cannot be bound
+     */
+    metrics_server(const metrics_registry& registry, const uint16_t port);
+
+    /*! Listen on a Unix socket, an existing socket file is replaced
+     *
+     * \throws uhd::runtime_error if the socket cannot be bound or the path is
+     *         another kind of file
+     */
+    metrics_server(const metrics_registry& registry, const std::string& socket_path);
+
+    ~metrics_server();
+
+    //! Where the server listens, for the log
+    std::string get_endpoint() const;
+
+private:
+    void _start();
+    void _serve();
+    void _respond(const int conn);
+
+    const metrics_registry& _registry;
+    std::string _endpoint;
+    std::string _socket_path;
+    int _fd;
+    std::atomic<bool> _running;
+    std::thread _thread;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_METRICS_SERVER_HPP */
@@ -0,0 +1,88 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_MIMO_MODEL_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_MIMO_MODEL_HPP
+
+#include <uhd/config.hpp>
+#include <rfnoc/openairlink/fir_shift_model.hpp>
+#include <string>
+#include <vector>
+
+namespace rfnoc { namespace openairlink {
+
+/*! One 2x2 channel matrix: taps and shift of each path
+ *
+ * Paths are indexed [rx][tx]: path [r][t] goes from emulator input (DUT TX
+ * antenna) t to emulator output (DUT RX antenna) r. On the FPGA, path
+ * [r][t] is FIR#(2r+t) followed by Shiftright#(2r+t).
+ */
+struct UHD_API mimo_config
+{
+    static const size_t NUM_CHANS = 2;
+
+    std::vector<int16_t> coeffs[NUM_CHANS][NUM_CHANS];
+    uint32_t shiftright[NUM_CHANS][NUM_CHANS];
+
+    mimo_config();
+
+    /*! Parse a matrix from its CSV fields
+     *
+     * The format is "taps00, shift00, taps01, shift01, taps10, shift10,
+     * taps11, shift11" with space separated taps, i.e., the per link format
+     * of the SISO scripts repeated for each path in row major order.
+     */
+    static mimo_config from_csv(const std::string& fields);
+
+    bool operator==(const mimo_config& rhs) const;
+    bool operator!=(const mimo_config& rhs) const;
+};
+
+/*! Bit-exact software model of the 2x2 MIMO datapath
+ *
+ * Each output is the saturated sum (like rfnoc_block_sum.v) of the two
+ * FIR -> Shiftright paths ending at it.
+ */
+class UHD_API mimo_model
+{
+public:
+    mimo_model(const mimo_config& config = mimo_config());
+
+    void set_config(const mimo_config& config);
+
+    const mimo_config& get_config() const;
+
+    /*! Clear the delay lines of all paths
+     */
+    void reset();
+
+    /*! Run a block of sc16 samples through the matrix
+     *
+     * \param in Input samples per emulator input (DUT TX antenna)
+     * \param out Output samples per emulator output (DUT RX antenna)
+     */
+    void process(const uint32_t* const in[mimo_config::NUM_CHANS],
+        uint32_t* const out[mimo_config::NUM_CHANS],
+        const size_t nsamps);
+
+private:
+    mimo_config _config;
+    std::vector<fir_shift_model> _paths;
+    std::vector<uint32_t> _path_out;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_MIMO_MODEL_HPP */
@@ -0,0 +1,70 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_MULTIRATE_TAPS_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_MULTIRATE_TAPS_HPP
+
+#include <uhd/config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Redesigns full rate FIR taps for a FIR running at a decimated rate
+ *
+ * With the DDC -> FIR -> DUC chain the FIR runs at radio rate / decim, so
+ * each of its taps spans decim radio samples. The full rate channel is band
+ * limited to the decimated Nyquist band (windowed sinc) and sampled every
+ * decim samples, which keeps the channel gain and delays for signals inside
+ * that band.
+ */
+class UHD_API multirate_taps
+{
+public:
+    //! Zero crossings of the band limiting windowed sinc on each side
+    static const size_t LOWPASS_HALF_SPAN;
+
+    multirate_taps(const size_t decim = 1);
+
+    size_t get_decim() const;
+
+    /*! Redesign one FIR -> Shiftright setting
+     *
+     * The taps are requantized to use the full 16 bit range, the change of
+     * scale is moved into the shift value. The scale is limited so that the
+     * sum of |taps| stays within the FIR full scale, i.e., a full scale
+     * input does not clip the FIR output.
+     *
+     * \param coeffs Taps at the radio rate
+     * \param shiftright Shift value used with the full rate taps
+     * \param max_taps Number of taps of the FIR, later taps are dropped
+     * \param out_coeffs Taps at the decimated rate
+     * \param out_shiftright Shift value to use with out_coeffs
+     */
+    void redesign(const std::vector<int16_t>& coeffs,
+        const uint32_t shiftright,
+        const size_t max_taps,
+        std::vector<int16_t>& out_coeffs,
+        uint32_t& out_shiftright) const;
+
+private:
+    size_t _decim;
+    std::vector<double> _lowpass;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_MULTIRATE_TAPS_HPP */
@@ -0,0 +1,96 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_SHIFTRIGHT_AGC_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_SHIFTRIGHT_AGC_HPP
+
+#include <uhd/config.hpp>
+#include <rfnoc/openairlink/shiftright_block_control.hpp>
+#include <vector>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Automatic gain control of one FIR -> Shiftright path
+ *
+ * The channel taps only give the shape of the channel, the AGC chooses the
+ * level from the shiftright block telemetry:
+ * - The taps are scaled by powers of two so that the FIR output peak stays
+ *   just below full scale, i.e., the FIR neither clips nor loses bits where
+ *   the taps allow it. The shift value compensates, so this does not change
+ *   the gain.
+ * - The shift value then keeps the output peak below the headroom target,
+ *   but not more than one shift step plus the hysteresis below it.
+ *
+ * Both bands are wider than one step (6 dB), so the AGC does not toggle
+ * between two settings with a constant input level.
+ */
+class UHD_API shiftright_agc
+{
+public:
+    //! Largest shift value the AGC uses
+    static const uint32_t MAX_SHIFT;
+    //! Bits the taps are reduced by when the FIR output clips
+    static const int CLIP_STEP;
+
+    /*!
+     * \param headroom_db Distance of the output peak target below full scale
+     * \param hysteresis_db Extra dead band below the targets, on top of one
+     *                      shift step
+     */
+    shiftright_agc(const double headroom_db = 6.0, const double hysteresis_db = 1.0);
+
+    /*! Set the channel taps, the current AGC scaling is kept if they fit
+     */
+    void set_coefficients(const std::vector<int16_t>& coeffs);
+
+    /*! Get the taps to write to the FIR, i.e., the scaled channel taps
+     */
+    const std::vector<int16_t>& get_coefficients() const;
+
+    /*! Set the shift value to start from
+     */
+    void set_shiftright_value(const uint32_t shiftright);
+
+    /*! Get the shift value to write to the shiftright block
+     */
+    uint32_t get_shiftright_value() const;
+
+    /*! Run one AGC step
+     *
+     * \param stats Telemetry of a window taken completely with the current
+     *              taps and shift value
+     * \returns true if taps or shift value changed and must be written
+     */
+    bool update(const shiftright_stats& stats);
+
+private:
+    int _max_tap_exp() const;
+    int _min_tap_exp() const;
+    void _scale_coefficients();
+
+    double _fir_hi;
+    double _fir_lo;
+    double _out_hi;
+    double _out_lo;
+    std::vector<int16_t> _channel_coeffs;
+    std::vector<int16_t> _coeffs;
+    //! The taps written are the channel taps times 2^_tap_exp
+    int _tap_exp;
+    int _shiftright;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_SHIFTRIGHT_AGC_HPP */
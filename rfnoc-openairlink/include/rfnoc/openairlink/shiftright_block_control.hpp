@@ -18,13 +18,73 @@
 
 #include <uhd/config.hpp>
 #include <uhd/rfnoc/noc_block_base.hpp>
+#include <uhd/types/metadata.hpp>
 #include <uhd/types/stream_cmd.hpp>
+#include <chrono>
+#include <vector>
 
 namespace rfnoc { namespace openairlink {
 
+/*! Telemetry of one window, measured at the input of the shiftright block
+ */
+struct shiftright_stats
+{
+    //! Number of completed windows, changes when a new window is available
+    uint32_t count = 0;
+    //! Mean I^2+Q^2 in LSB^2
+    uint32_t power = 0;
+    //! Max of |I| and |Q| in LSB
+    uint32_t peak = 0;
+    //! Number of samples with I or Q at full scale
+    uint32_t clip_count = 0;
+};
+
+/*! Channel tag carried as a metadata word in the output packets
+ */
+struct shiftright_tag
+{
+    //! Channel step ID, see set_channel_tag()
+    uint32_t step_id = 0;
+    //! Shift applied to all samples of the packet
+    uint32_t shiftright = 0;
+};
+
+/*! Error of the RX radio upstream of a shiftright block
+ */
+struct shiftright_rx_event
+{
+    //! Overflow, late command, ... as reported by the radio
+    uhd::rx_metadata_t::error_code_t error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+    //! Host time when the block controller received the event
+    std::chrono::steady_clock::time_point time;
+};
+
+/*! Control port traffic of a shiftright block controller
+ */
+struct shiftright_ctrl_stats
+{
+    //! Register writes sent to the device
+    uint64_t pokes = 0;
+    //! Register writes skipped, the register already had the value
+    uint64_t skipped_pokes = 0;
+    //! Bursts sent by write_registers()
+    uint64_t bursts = 0;
+    //! Register reads sent to the device
+    uint64_t peeks = 0;
+    //! Register reads served from the register cache
+    uint64_t cached_reads = 0;
+    //! get_stats() results whose values may span two windows
+    uint64_t mixed_stats = 0;
+};
+
 /*! Block controller for the shiftright block: right shifts signal by given bits
  *
  * This block right shifts the signal input with fixed bits.
+ *
+ * The writable registers (shift, telemetry window, tag control and step ID)
+ * are cached: a write of the value the register already has is not sent,
+ * and the getters return the cached value without a device read once the
+ * value is known. The telemetry counters are always read from the device.
  */
 class UHD_API shiftright_block_control : public uhd::rfnoc::noc_block_base
 {
@@ -33,6 +93,28 @@ public:
 
     //! The register address of the shiftright bits
     static const uint32_t REG_SHIFTRIGHT_VALUE;
+    //! The register address of the log2 telemetry window length
+    static const uint32_t REG_STATS_WINDOW;
+    //! The register address of the completed window count
+    static const uint32_t REG_STATS_COUNT;
+    //! The register address of the mean power
+    static const uint32_t REG_STATS_POWER;
+    //! The register address of the peak magnitude
+    static const uint32_t REG_STATS_PEAK;
+    //! The register address of the clip count
+    static const uint32_t REG_STATS_CLIP;
+    //! The register address of the channel tag control
+    static const uint32_t REG_TAG_CTRL;
+    //! The register address of the channel tag step ID
+    static const uint32_t REG_TAG_ID;
+    //! The marker in the upper 16 bits of the tag metadata word
+    static const uint16_t TAG_MARKER;
+    //! Number of RX events queued for get_rx_event()
+    static const size_t MAX_RX_EVENTS;
+    //! Largest log2 telemetry window, larger values are clipped by the block
+    static const uint32_t MAX_STATS_WINDOW;
+    //! Tries of get_stats() to read all values from the same window
+    static const size_t MAX_STATS_READS;
 
     /*! Set the shiftright bits
      */
@@ -41,6 +123,86 @@ public:
     /*! Get the current shiftright bits (read it from the device)
      */
     virtual uint32_t get_shiftright_value() = 0;
+
+    /*! Set the telemetry window to 2^log2_len samples, restarts the window
+     */
+    virtual void set_stats_window(const uint32_t log2_len) = 0;
+
+    /*! Get the log2 of the telemetry window length (read it from the device)
+     */
+    virtual uint32_t get_stats_window() = 0;
+
+    /*! Get the telemetry of the last complete window (read it from the device)
+     *
+     * The values are read again while a window completes during the reads,
+     * at most MAX_STATS_READS times. If the window is shorter than the reads,
+     * the last set is returned and counted in shiftright_ctrl_stats::mixed_stats.
+     */
+    virtual shiftright_stats get_stats() = 0;
+
+    /*! Enable or disable the channel tag
+     *
+     * With the tag enabled every output packet carries one extra metadata
+     * word with the channel step ID and the shift of the packet. The shift
+     * only changes at packet boundaries then.
+     */
+    virtual void set_tagging_enabled(const bool enable) = 0;
+
+    /*! Get if the channel tag is enabled (read it from the device)
+     */
+    virtual bool get_tagging_enabled() = 0;
+
+    /*! Set the channel step ID put into the tag of the following packets
+     */
+    virtual void set_channel_tag(const uint32_t step_id) = 0;
+
+    /*! Get the current channel step ID (read it from the device)
+     */
+    virtual uint32_t get_channel_tag() = 0;
+
+    /*! Write several registers in one control port burst
+     *
+     * The writes are sent back to back without waiting for acknowledgments.
+     * Writes that do not change a cached register are dropped, a write to
+     * REG_STATS_WINDOW is always sent since it restarts the window.
+     *
+     * \throws uhd::value_error if addrs and values differ in size
+     */
+    virtual void write_registers(
+        const std::vector<uint32_t>& addrs, const std::vector<uint32_t>& values) = 0;
+
+    /*! Read the cached registers from the device on every get
+     *
+     * A readback that differs from the cached value is logged as a warning
+     * and replaces the cached value.
+     */
+    virtual void set_verify_readback(const bool verify) = 0;
+
+    /*! Forget the cached register values, e.g. after a reset of the block
+     */
+    virtual void clear_register_cache() = 0;
+
+    /*! Get the control port traffic since the block controller was created
+     */
+    virtual shiftright_ctrl_stats get_ctrl_stats() = 0;
+
+    /*! Get the next error of the RX radio upstream of the block
+     *
+     * The radio posts its overflows and late commands downstream as RX event
+     * actions. Without an RX streamer at the end of the chain nothing would
+     * see them, so the block controller queues them (the last
+     * MAX_RX_EVENTS) before it passes them on.
+     *
+     * \returns false if no event arrived within the timeout
+     */
+    virtual bool get_rx_event(shiftright_rx_event& event, const double timeout = 0.1) = 0;
+
+    /*! Find the channel tag in the metadata words of a received packet
+     *
+     * \returns true if a tag was found
+     */
+    static bool parse_channel_tag(
+        const uint64_t* mdata, const size_t num_mdata, shiftright_tag& tag);
 };
 
 }} // namespace rfnoc::airlink
@@ -0,0 +1,172 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_STREAM_HEALTH_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_STREAM_HEALTH_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/rfnoc/radio_control.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <rfnoc/openairlink/metrics.hpp>
+#include <rfnoc/openairlink/shiftright_block_control.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rfnoc { namespace openairlink {
+
+//! Event types counted by the stream health monitor
+enum stream_event_t {
+    //! RX overflow, the radio dropped samples
+    STREAM_EVENT_OVERFLOW = 0,
+    //! TX underflow, the radio ran out of samples
+    STREAM_EVENT_UNDERFLOW,
+    //! A timed RX or TX command arrived after its time
+    STREAM_EVENT_LATE_COMMAND,
+    //! TX packet sequence error
+    STREAM_EVENT_SEQ_ERROR,
+    //! Any other RX or TX error
+    STREAM_EVENT_OTHER,
+    NUM_STREAM_EVENTS
+};
+
+/*! Counter and timestamps of one event type
+ */
+struct UHD_API stream_event_stats
+{
+    uint64_t count = 0;
+    //! Host time of the first and the last event in seconds since start()
+    double first_s = 0.0;
+    double last_s  = 0.0;
+    //! Device time of the last event, if the radio reported one
+    bool has_device_time = false;
+    uhd::time_spec_t device_time;
+};
+
+//! Stats of all event types, indexed by stream_event_t
+typedef std::array<stream_event_stats, NUM_STREAM_EVENTS> stream_health;
+
+/*! Background monitor of the radio errors of the emulated links
+ *
+ * The links stream radio to radio, so no streamer sees the errors of the
+ * radios. The monitor collects them from two places:
+ * - RX overflows and late commands from the shiftright block of the link,
+ *   which queues the RX events the radio posts downstream.
+ * - TX underflows, sequence errors and late commands from the async
+ *   messages of the TX radio.
+ *
+ * Every event type can have a limit on its total count over all links. The
+ * first time a count exceeds its limit the monitor trips: it logs an error
+ * and calls the trip callback, e.g. to stop the run.
+ */
+class UHD_API stream_health_monitor
+{
+public:
+    typedef std::function<void(const std::string& reason)> trip_callback_t;
+
+    stream_health_monitor();
+    ~stream_health_monitor();
+
+    /*! Monitor a link, must be called before start()
+     *
+     * Links can share a TX radio, its messages are assigned by channel.
+     */
+    void add_link(const std::string& name,
+        shiftright_block_control::sptr sr,
+        uhd::rfnoc::radio_control::sptr tx_radio,
+        const size_t tx_chan);
+
+    /*! Trip when the total count of an event type exceeds max_count
+     */
+    void set_limit(const stream_event_t event, const uint64_t max_count);
+
+    /*! Call this from the monitor thread when the monitor trips
+     */
+    void set_trip_callback(trip_callback_t callback);
+
+    /*! Count the events also in oal_stream_errors_total{link,type} of a
+     * registry, must be called after add_link() and before start()
+     */
+    void set_metrics(metrics_registry& registry);
+
+    /*! Start the monitor threads, the event timestamps count from here
+     */
+    void start();
+
+    /*! Stop and join the monitor threads, the stats are kept
+     */
+    void stop();
+
+    /*! Get the stats of one link
+     *
+     * \throws uhd::key_error if there is no link with this name
+     */
+    stream_health get_health(const std::string& name) const;
+
+    /*! Get the stats summed over all links
+     */
+    stream_health get_total_health() const;
+
+    //! True once a limit was exceeded
+    bool tripped() const;
+
+    //! Which limit was exceeded, empty if not tripped
+    std::string get_trip_reason() const;
+
+    /*! Table of the counts and timestamps per link and event type
+     */
+    std::string get_summary() const;
+
+    //! Name of an event type, e.g. "overflow"
+    static std::string event_name(const stream_event_t event);
+
+private:
+    struct link_t
+    {
+        std::string name;
+        shiftright_block_control::sptr sr;
+        uhd::rfnoc::radio_control::sptr tx_radio;
+        size_t tx_chan;
+        stream_health health;
+        std::array<metric_counter*, NUM_STREAM_EVENTS> metrics;
+    };
+
+    void _rx_loop(const size_t link_idx);
+    void _tx_loop(const uhd::rfnoc::radio_control::sptr radio);
+    void _count(const size_t link_idx,
+        const stream_event_t event,
+        const std::chrono::steady_clock::time_point time,
+        const bool has_device_time,
+        const uhd::time_spec_t& device_time);
+
+    std::vector<link_t> _links;
+    std::array<uint64_t, NUM_STREAM_EVENTS> _limits;
+    trip_callback_t _trip_callback;
+    std::chrono::steady_clock::time_point _start;
+    std::string _trip_reason;
+    mutable std::mutex _mutex;
+    std::atomic<bool> _running;
+    std::vector<std::thread> _threads;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_STREAM_HEALTH_HPP */
@@ -0,0 +1,48 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_SUM_BLOCK_CONTROL_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_SUM_BLOCK_CONTROL_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/rfnoc/noc_block_base.hpp>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Block controller for the sum block: adds two signals with saturation
+ *
+ * This block adds the samples of its two inputs, e.g., to combine the paths
+ * of a 2x2 MIMO channel that end at the same receive antenna.
+ */
+class UHD_API sum_block_control : public uhd::rfnoc::noc_block_base
+{
+public:
+    RFNOC_DECLARE_BLOCK(sum_block_control)
+
+    //! The register address of the saturation counter
+    static const uint32_t REG_SAT_COUNT;
+
+    /*! Get the number of saturated output samples since the last clear
+     */
+    virtual uint32_t get_saturation_count() = 0;
+
+    /*! Clear the saturation counter
+     */
+    virtual void clear_saturation_count() = 0;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_SUM_BLOCK_CONTROL_HPP */
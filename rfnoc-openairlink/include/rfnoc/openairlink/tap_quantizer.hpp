@@ -0,0 +1,92 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef INCLUDED_RFNOC_OPENAIRLINK_TAP_QUANTIZER_HPP
+#define INCLUDED_RFNOC_OPENAIRLINK_TAP_QUANTIZER_HPP
+
+#include <uhd/config.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace rfnoc { namespace openairlink {
+
+/*! Chooses int16 taps and shift value for floating point channel taps
+ *
+ * The FIR -> Shiftright path realizes the taps c[n] / 2^(15 + shift). For a
+ * given shift, rounding each tap is optimal, and a larger shift gives a finer
+ * tap resolution. The quantizer therefore uses the largest shift for which
+ * - all taps fit into int16, and
+ * - the FIR output cannot clip, i.e., sum |c[n]| times the input peak stays
+ *   within full scale (the FIR saturates its output before the shift).
+ * Targets beyond these bounds at shift 0 are realized with a reduced gain.
+ *
+ * The FIR has real taps, which it applies to I and Q alike. Complex taps are
+ * rotated by the common phase that leaves the most energy in the real part,
+ * the remaining imaginary part can not be realized.
+ *
+ * All arrays are row major with one row of num_taps values per step, so
+ * large batches are processed with plain loops over contiguous memory.
+ */
+class UHD_API tap_quantizer
+{
+public:
+    //! Largest shift value used
+    static const uint32_t MAX_SHIFT;
+
+    /*!
+     * \param num_taps Number of taps per step
+     * \param input_peak_dbfs Largest input magnitude of I or Q relative to
+     *                        full scale, sets the FIR overflow bound
+     */
+    tap_quantizer(const size_t num_taps, const double input_peak_dbfs = 0.0);
+
+    size_t get_num_taps() const;
+
+    /*! Quantize a batch of steps
+     *
+     * \param taps_re Real part of the taps, 1.0 is unity gain
+     * \param taps_im Imaginary part of the taps, nullptr for real taps
+     * \param gains_db Target gain per step applied to the taps, nullptr for 0 dB
+     * \param num_steps Number of steps
+     * \param coeffs Output int16 taps
+     * \param shifts Output shift value per step
+     * \param sqnr_db Output ratio of realized tap energy to quantization
+     *                error energy per step, nullptr if not needed
+     * \param gain_loss_db Output gain reduction per step for targets the
+     *                     bounds do not allow even with shift 0, nullptr if
+     *                     not needed
+     * \param real_loss_db Output ratio of tap energy to the energy of the
+     *                     discarded imaginary part per step, nullptr if not
+     *                     needed
+     */
+    void quantize(const double* taps_re,
+        const double* taps_im,
+        const double* gains_db,
+        const size_t num_steps,
+        int16_t* coeffs,
+        uint32_t* shifts,
+        double* sqnr_db      = nullptr,
+        double* gain_loss_db = nullptr,
+        double* real_loss_db = nullptr) const;
+
+private:
+    size_t _num_taps;
+    //! Bound of sum |c[n]| so that the FIR output does not clip
+    double _l1_bound;
+};
+
+}} // namespace rfnoc::openairlink
+
+#endif /* INCLUDED_RFNOC_OPENAIRLINK_TAP_QUANTIZER_HPP */
@@ -0,0 +1,70 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <rfnoc/openairlink/awgn_block_control.hpp>
+#include <rfnoc/openairlink/awgn_model.hpp>
+
+#include <uhd/rfnoc/defaults.hpp>
+#include <uhd/rfnoc/registry.hpp>
+#include <algorithm>
+
+using namespace rfnoc::openairlink;
+using namespace uhd::rfnoc;
+
+const uint32_t awgn_block_control::REG_NOISE_SCALE = 0x00;
+const uint32_t awgn_block_control::REG_NOISE_SEED  = 0x04;
+
+class awgn_block_control_impl : public awgn_block_control
+{
+public:
+    RFNOC_BLOCK_CONSTRUCTOR(awgn_block_control) {}
+
+    void set_noise_scale(const uint32_t noise_scale)
+    {
+        regs().poke32(REG_NOISE_SCALE, std::min(noise_scale, awgn_model::MAX_NOISE_SCALE));
+    }
+
+    uint32_t get_noise_scale()
+    {
+        return regs().peek32(REG_NOISE_SCALE);
+    }
+
+    double set_noise_power(const double noise_dbfs)
+    {
+        const uint32_t noise_scale = awgn_model::noise_scale_from_dbfs(noise_dbfs);
+        set_noise_scale(noise_scale);
+        return awgn_model::dbfs_from_noise_scale(noise_scale);
+    }
+
+    double get_noise_power()
+    {
+        return awgn_model::dbfs_from_noise_scale(get_noise_scale());
+    }
+
+    double set_snr(const double snr_db, const double signal_dbfs)
+    {
+        return signal_dbfs - set_noise_power(signal_dbfs - snr_db);
+    }
+
+    void set_seed(const uint32_t seed)
+    {
+        regs().poke32(REG_NOISE_SEED, seed);
+    }
+
+private:
+};
+
+UHD_RFNOC_BLOCK_REGISTER_DIRECT(
+    awgn_block_control, 0x02d025, "AWGN", CLOCK_KEY_GRAPH, "bus_clk")
@@ -0,0 +1,143 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <rfnoc/openairlink/awgn_model.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace rfnoc::openairlink;
+
+const size_t awgn_model::NUM_URNG          = 12;
+const int awgn_model::SCALE_SHIFT          = 18;
+const uint32_t awgn_model::MAX_NOISE_SCALE = 0xFFFF;
+
+namespace {
+
+const uint32_t SEED_MIX   = 0x9E3779B9;
+const int32_t CLT_OFFSET  = 393210; // Mean of twelve uniform values in [0, 65535]
+const uint32_t PSUM_INIT  = 131070; // A third of CLT_OFFSET, gives zero noise
+const double FULL_SCALE   = 32767.0;
+
+int16_t saturate16(const int32_t x)
+{
+    return static_cast<int16_t>(std::min<int32_t>(std::max<int32_t>(x, -32768), 32767));
+}
+
+} // namespace
+
+awgn_model::awgn_model(const uint32_t seed, const uint32_t noise_scale)
+    : _state(NUM_URNG), _noise_scale(std::min(noise_scale, MAX_NOISE_SCALE))
+{
+    set_seed(seed);
+}
+
+void awgn_model::set_seed(const uint32_t seed)
+{
+    for (size_t k = 0; k < NUM_URNG; k++) {
+        const uint32_t s = seed ^ static_cast<uint32_t>(SEED_MIX * (k + 1));
+        _state[k]        = (s == 0) ? 1 : s;
+    }
+    for (size_t j = 0; j < 3; j++) {
+        _psum_i[j] = PSUM_INIT;
+        _psum_q[j] = PSUM_INIT;
+    }
+    _g_i = _g_q = 0;
+    _n_i = _n_q = 0;
+}
+
+void awgn_model::set_noise_scale(const uint32_t noise_scale)
+{
+    _noise_scale = std::min(noise_scale, MAX_NOISE_SCALE);
+}
+
+uint32_t awgn_model::get_noise_scale() const
+{
+    return _noise_scale;
+}
+
+void awgn_model::next_noise(int32_t& noise_i, int32_t& noise_q)
+{
+    noise_i = _n_i;
+    noise_q = _n_q;
+    _step();
+}
+
+uint32_t awgn_model::process(const uint32_t sample)
+{
+    const int16_t i = static_cast<int16_t>(sample >> 16);
+    const int16_t q = static_cast<int16_t>(sample & 0xFFFF);
+    int32_t noise_i, noise_q;
+    next_noise(noise_i, noise_q);
+    const uint16_t i_sat = static_cast<uint16_t>(saturate16(i + noise_i));
+    const uint16_t q_sat = static_cast<uint16_t>(saturate16(q + noise_q));
+    return (static_cast<uint32_t>(i_sat) << 16) | q_sat;
+}
+
+void awgn_model::process(const std::vector<uint32_t>& in, std::vector<uint32_t>& out)
+{
+    out.resize(in.size());
+    std::transform(in.begin(), in.end(), out.begin(), [this](const uint32_t sample) {
+        return process(sample);
+    });
+}
+
+uint32_t awgn_model::noise_scale_from_dbfs(const double noise_dbfs)
+{
+    if (std::isnan(noise_dbfs) || noise_dbfs == -std::numeric_limits<double>::infinity()) {
+        return 0;
+    }
+    // Complex noise power is 2*sigma^2, one register LSB is 1/4 LSB of sigma
+    const double sigma = FULL_SCALE * std::sqrt(std::pow(10.0, noise_dbfs / 10.0) / 2.0);
+    const double scale = std::round(sigma * (1 << (SCALE_SHIFT - 16)));
+    return static_cast<uint32_t>(std::min(scale, static_cast<double>(MAX_NOISE_SCALE)));
+}
+
+double awgn_model::dbfs_from_noise_scale(const uint32_t noise_scale)
+{
+    const double sigma = static_cast<double>(noise_scale) / (1 << (SCALE_SHIFT - 16));
+    return 10.0 * std::log10(2.0 * sigma * sigma / (FULL_SCALE * FULL_SCALE));
+}
+
+void awgn_model::_step()
+{
+    // Update in reverse pipeline order, so every stage sees the old value of
+    // its predecessor like the registers in awgn_gen.v do.
+    const int64_t prod_i = static_cast<int64_t>(_g_i) * _noise_scale;
+    const int64_t prod_q = static_cast<int64_t>(_g_q) * _noise_scale;
+    const int64_t round  = int64_t(1) << (SCALE_SHIFT - 1);
+    // Arithmetic shift, like >>> in Verilog
+    _n_i = static_cast<int32_t>((prod_i + round) >> SCALE_SHIFT);
+    _n_q = static_cast<int32_t>((prod_q + round) >> SCALE_SHIFT);
+
+    _g_i = static_cast<int32_t>(_psum_i[0] + _psum_i[1] + _psum_i[2]) - CLT_OFFSET;
+    _g_q = static_cast<int32_t>(_psum_q[0] + _psum_q[1] + _psum_q[2]) - CLT_OFFSET;
+
+    for (size_t j = 0; j < 3; j++) {
+        _psum_i[j] = 0;
+        _psum_q[j] = 0;
+        for (size_t k = 4 * j; k < 4 * j + 4; k++) {
+            _psum_i[j] += _state[k] >> 16;
+            _psum_q[j] += _state[k] & 0xFFFF;
+        }
+    }
+
+    for (auto& x : _state) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+}
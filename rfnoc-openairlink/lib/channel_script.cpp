@@ -0,0 +1,111 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#include <rfnoc/openairlink/channel_script.hpp>
+
+#include <uhd/exception.hpp>
+#include <fstream>
+#include <sstream>
+
+using namespace rfnoc::openairlink;
+
+namespace {
+
+const uint32_t MAX_SHIFT = 31;
+
+std::string space_trim(const std::string& str)
+{
+    const size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    return str.substr(first, str.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+} // namespace
+
+channel_step::channel_step() : time(0.0), coeffs{32767}, shiftright(0) {}
+
+channel_step channel_step::from_csv(const std::string& line)
+{
+    channel_step step;
+    std::istringstream iss(line);
+    std::string time, taps, shift, snr;
+
+    if (!std::getline(iss, time, ',') || !std::getline(iss, taps, ',')
+        || !std::getline(iss, shift, ',')) {
+        throw uhd::value_error("Channel step needs time, taps and shift: '" + line + "'");
+    }
+    try {
+        step.time       = std::stod(time);
+        const int value = std::stoi(shift);
+        if (value < 0 || static_cast<uint32_t>(value) > MAX_SHIFT) {
+            throw uhd::value_error("Shift out of range: " + space_trim(shift));
+        }
+        step.shiftright = static_cast<uint32_t>(value);
+        while (std::getline(iss, snr, ',')) {
+            if (!space_trim(snr).empty()) {
+                step.snr_db.push_back(std::stod(snr));
+            }
+        }
+    } catch (const std::logic_error&) {
+        throw uhd::value_error("Invalid number in channel step: '" + line + "'");
+    }
+
+    std::istringstream tap_ss(taps);
+    int tap;
+    step.coeffs.clear();
+    while (tap_ss >> tap) {
+        if (tap < -32768 || tap > 32767) {
+            throw uhd::value_error("Tap out of int16 range: " + std::to_string(tap));
+        }
+        step.coeffs.push_back(static_cast<int16_t>(tap));
+    }
+    if (step.coeffs.empty() || !tap_ss.eof()) {
+        throw uhd::value_error("Invalid taps in channel step: '" + line + "'");
+    }
+
+    return step;
+}
+
+std::vector<channel_step> rfnoc::openairlink::load_channel_script(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw uhd::value_error("Could not open channel script '" + path + "'");
+    }
+
+    std::vector<channel_step> steps;
+    std::string line;
+    while (std::getline(file, line)) {
+        const std::string trimmed = space_trim(line);
+        if (trimmed.rfind("eos", 0) == 0) {
+            break;
+        }
+        if (trimmed.empty()) {
+            continue;
+        }
+        const channel_step step = channel_step::from_csv(trimmed);
+        // The steps are applied in file order, an earlier time would be late
+        if (!steps.empty() && !(step.time > steps.back().time)) {
+            throw uhd::value_error(
+                "Channel step times must ascend: '" + trimmed + "' is not after the step before");
+        }
+        steps.push_back(step);
+    }
+
+    return steps;
+}
@@ -0,0 +1,330 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#include <rfnoc/openairlink/channel_trace.hpp>
+
+#include <uhd/exception.hpp>
+#include <uhd/utils/log.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+using namespace rfnoc::openairlink;
+
+const uint32_t channel_record::NO_NOISE_SCALE = 0xFFFFFFFF;
+
+namespace {
+
+const char MAGIC[8]       = {'O', 'A', 'L', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t VERSION    = 1;
+const size_t WRITE_BUFFER = 1 << 20;
+const std::string LOG_ID  = "channel_trace";
+
+// Values are written in host byte order, all supported hosts are little endian
+template <typename T>
+void put(std::ostream& os, const T value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool get(std::istream& is, T& value)
+{
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void put_string(std::ostream& os, const std::string& str)
+{
+    put<uint16_t>(os, static_cast<uint16_t>(str.size()));
+    os.write(str.data(), str.size());
+}
+
+bool get_string(std::istream& is, std::string& str)
+{
+    uint16_t len;
+    if (!get(is, len)) {
+        return false;
+    }
+    str.resize(len);
+    return static_cast<bool>(is.read(&str[0], len));
+}
+
+void put_taps(std::ostream& os, const std::vector<int16_t>& taps)
+{
+    os.write(reinterpret_cast<const char*>(taps.data()), taps.size() * sizeof(int16_t));
+}
+
+bool get_taps(std::istream& is, std::vector<int16_t>& taps, const uint16_t num_taps)
+{
+    taps.resize(num_taps);
+    return static_cast<bool>(
+        is.read(reinterpret_cast<char*>(taps.data()), num_taps * sizeof(int16_t)));
+}
+
+} // namespace
+
+channel_record::channel_record()
+    : device_ticks(0)
+    , host_ns(0)
+    , link(0)
+    , shiftright(0)
+    , shiftright_readback(0)
+    , noise_scale(NO_NOISE_SCALE)
+{
+}
+
+bool channel_record::readback_ok() const
+{
+    if (shiftright != shiftright_readback || coeffs_readback.size() < coeffs.size()) {
+        return false;
+    }
+    return std::equal(coeffs.begin(), coeffs.end(), coeffs_readback.begin())
+           && std::all_of(coeffs_readback.begin() + coeffs.size(),
+               coeffs_readback.end(),
+               [](const int16_t tap) { return tap == 0; });
+}
+
+channel_trace_writer::channel_trace_writer(const std::string& path,
+    const double tick_rate,
+    const std::vector<channel_trace_link>& links)
+    : _buffer(WRITE_BUFFER)
+{
+    // The buffer must be set before the file is opened
+    _file.rdbuf()->pubsetbuf(_buffer.data(), _buffer.size());
+    _file.open(path, std::ios::binary | std::ios::trunc);
+    if (!_file) {
+        throw uhd::runtime_error("Could not create channel trace '" + path + "'");
+    }
+
+    _file.write(MAGIC, sizeof(MAGIC));
+    put<uint32_t>(_file, VERSION);
+    put<double>(_file, tick_rate);
+    put<uint32_t>(_file, static_cast<uint32_t>(links.size()));
+    for (const auto& link : links) {
+        put_string(_file, link.fir_id);
+        put_string(_file, link.shiftright_id);
+    }
+}
+
+void channel_trace_writer::write(const channel_record& record)
+{
+    put<uint64_t>(_file, record.device_ticks);
+    put<int64_t>(_file, record.host_ns);
+    put<uint16_t>(_file, record.link);
+    put<uint16_t>(_file, static_cast<uint16_t>(record.coeffs.size()));
+    put<uint16_t>(_file, static_cast<uint16_t>(record.coeffs_readback.size()));
+    put<uint32_t>(_file, record.shiftright);
+    put<uint32_t>(_file, record.shiftright_readback);
+    put<uint32_t>(_file, record.noise_scale);
+    put_taps(_file, record.coeffs);
+    put_taps(_file, record.coeffs_readback);
+}
+
+void channel_trace_writer::flush()
+{
+    _file.flush();
+}
+
+channel_trace_reader::channel_trace_reader(const std::string& path)
+    : _file(path, std::ios::binary)
+{
+    char magic[sizeof(MAGIC)];
+    uint32_t version, num_links;
+    if (!_file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+        || !get(_file, version) || version != VERSION || !get(_file, _tick_rate)
+        || !get(_file, num_links)) {
+        throw uhd::runtime_error("No valid channel trace: '" + path + "'");
+    }
+    _links.resize(num_links);
+    for (auto& link : _links) {
+        if (!get_string(_file, link.fir_id) || !get_string(_file, link.shiftright_id)) {
+            throw uhd::runtime_error("Truncated channel trace header: '" + path + "'");
+        }
+    }
+}
+
+double channel_trace_reader::get_tick_rate() const
+{
+    return _tick_rate;
+}
+
+const std::vector<channel_trace_link>& channel_trace_reader::get_links() const
+{
+    return _links;
+}
+
+bool channel_trace_reader::read(channel_record& record)
+{
+    uint16_t num_taps, num_readback;
+    if (!get(_file, record.device_ticks)) {
+        return false;
+    }
+    if (!get(_file, record.host_ns) || !get(_file, record.link) || !get(_file, num_taps)
+        || !get(_file, num_readback) || !get(_file, record.shiftright)
+        || !get(_file, record.shiftright_readback) || !get(_file, record.noise_scale)
+        || !get_taps(_file, record.coeffs, num_taps)
+        || !get_taps(_file, record.coeffs_readback, num_readback)) {
+        throw uhd::runtime_error("Channel trace ends within a record");
+    }
+    if (record.link >= _links.size()) {
+        throw uhd::runtime_error("Channel trace record of unknown link");
+    }
+    return true;
+}
+
+std::vector<channel_record> channel_trace_reader::read_all()
+{
+    std::vector<channel_record> records;
+    channel_record record;
+    while (read(record)) {
+        records.push_back(record);
+    }
+    return records;
+}
+
+state_recorder::state_recorder(const std::string& path,
+    uhd::rfnoc::mb_controller::timekeeper::sptr tk,
+    const std::vector<channel_trace_link>& ids,
+    const std::vector<link_blocks>& links)
+    : _trace(path, tk->get_tick_rate(), ids), _tk(tk), _links(links), _last(links.size())
+{
+    // The readback has to come from the device, not the register cache
+    for (const link_blocks& link : _links) {
+        link.sr->set_verify_readback(true);
+    }
+}
+
+state_recorder::~state_recorder()
+{
+    _trace.flush();
+}
+
+void state_recorder::record(
+    const size_t link_idx, const std::vector<int16_t>& coeffs, const uint32_t shift)
+{
+    const link_blocks& link = _links[link_idx];
+    channel_record record;
+    record.device_ticks = _tk->get_ticks_now();
+    record.host_ns      = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    record.link                = static_cast<uint16_t>(link_idx);
+    record.coeffs              = coeffs;
+    record.shiftright          = shift;
+    record.coeffs_readback     = link.fir->get_coefficients();
+    record.shiftright_readback = link.sr->get_shiftright_value();
+    if (link.awgn) {
+        record.noise_scale = link.awgn->get_noise_scale();
+    }
+
+    channel_record& last = _last[link_idx];
+    if (!last.coeffs.empty() && record.coeffs == last.coeffs && record.shiftright == last.shiftright
+        && record.coeffs_readback == last.coeffs_readback
+        && record.shiftright_readback == last.shiftright_readback
+        && record.noise_scale == last.noise_scale) {
+        return;
+    }
+    if (!record.readback_ok()) {
+        UHD_LOG_WARNING(LOG_ID, "Readback of link " << link_idx << " differs from the written state");
+    }
+    _trace.write(record);
+    last = record;
+    _num_records++;
+}
+
+size_t state_recorder::get_num_records() const
+{
+    return _num_records;
+}
+
+void rfnoc::openairlink::replay_trace(const std::string& path,
+    uhd::rfnoc::mb_controller::timekeeper::sptr tk,
+    const std::vector<channel_trace_link>& ids,
+    const std::vector<link_blocks>& links,
+    state_recorder* recorder,
+    const std::atomic<bool>& stop)
+{
+    channel_trace_reader trace(path);
+    const std::vector<channel_record> records = trace.read_all();
+    for (size_t i = 0; i < trace.get_links().size() && i < ids.size(); i++) {
+        if (trace.get_links()[i].fir_id != ids[i].fir_id
+            || trace.get_links()[i].shiftright_id != ids[i].shiftright_id) {
+            UHD_LOG_WARNING(LOG_ID,
+                "Link " << i << " was recorded with " << trace.get_links()[i].fir_id << "/"
+                        << trace.get_links()[i].shiftright_id << ", replaying on "
+                        << ids[i].fir_id << "/" << ids[i].shiftright_id);
+        }
+    }
+    if (records.empty()) {
+        std::cout << "The trace has no records." << std::endl;
+        return;
+    }
+    std::cout << boost::format("Replaying %d records over %.3fs...") % records.size()
+                     % ((records.back().device_ticks - records.front().device_ticks)
+                         / trace.get_tick_rate())
+              << std::endl;
+
+    // Start a moment after now, so the first record is not late already
+    const double tick_rate = tk->get_tick_rate();
+    const double start_s   = tk->get_ticks_now() / tick_rate + 0.1;
+    double max_late_s = 0.0, sum_late_s = 0.0;
+    size_t num_replayed = 0;
+    for (const channel_record& record : records) {
+        if (stop) {
+            break;
+        }
+        if (record.link >= links.size()) {
+            UHD_LOG_WARNING(LOG_ID, "No link " << record.link << ", record skipped");
+            continue;
+        }
+        // Wait on the host clock, re-aligned to the device time for every record
+        const double due_s =
+            start_s
+            + (record.device_ticks - records.front().device_ticks) / trace.get_tick_rate();
+        const double wait_s = due_s - tk->get_ticks_now() / tick_rate;
+        if (wait_s > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(wait_s));
+        }
+
+        const link_blocks& link = links[record.link];
+        if (link.awgn && record.noise_scale != channel_record::NO_NOISE_SCALE) {
+            link.awgn->set_noise_scale(record.noise_scale);
+        }
+        link.fir->set_coefficients(record.coeffs, 0);
+        link.sr->set_shiftright_value(record.shiftright);
+        const double late_s = tk->get_ticks_now() / tick_rate - due_s;
+        if (recorder) {
+            recorder->record(record.link, record.coeffs, record.shiftright);
+        }
+
+        max_late_s = std::max(max_late_s, late_s);
+        sum_late_s += late_s;
+        num_replayed++;
+        std::cout << boost::format("Replay step %d: link %d, shift %d, %.3fs, late %.1f us")
+                         % num_replayed % record.link % record.shiftright
+                         % (due_s - start_s) % (late_s * 1e6)
+                  << std::endl;
+    }
+    if (num_replayed) {
+        std::cout << boost::format("Replayed %d records, mean late %.1f us, max late %.1f us")
+                         % num_replayed % (sum_late_s / num_replayed * 1e6) % (max_late_s * 1e6)
+                  << std::endl;
+    }
+    std::cout << "Reached end of the trace, keep the current config..." << std::endl << std::endl;
+}
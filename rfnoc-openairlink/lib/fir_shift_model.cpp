@@ -0,0 +1,121 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <rfnoc/openairlink/fir_shift_model.hpp>
+
+#include <algorithm>
+
+using namespace rfnoc::openairlink;
+
+const int fir_shift_model::FIR_SHIFT = 15;
+
+namespace {
+
+int32_t round_and_clip(const int64_t acc)
+{
+    const int64_t rounded = (acc + (int64_t(1) << (fir_shift_model::FIR_SHIFT - 1)))
+                            >> fir_shift_model::FIR_SHIFT;
+    return static_cast<int32_t>(std::min<int64_t>(std::max<int64_t>(rounded, -32768), 32767));
+}
+
+} // namespace
+
+fir_shift_model::fir_shift_model(const std::vector<int16_t>& coeffs, const uint32_t shiftright)
+    : _shiftright(0)
+{
+    set_coefficients(coeffs);
+    set_shiftright_value(shiftright);
+}
+
+void fir_shift_model::set_coefficients(const std::vector<int16_t>& coeffs)
+{
+    _coeffs = coeffs;
+    if (_coeffs.empty()) {
+        _coeffs.push_back(0);
+    }
+    _resize_history();
+}
+
+const std::vector<int16_t>& fir_shift_model::get_coefficients() const
+{
+    return _coeffs;
+}
+
+void fir_shift_model::set_shiftright_value(const uint32_t shiftright)
+{
+    // The register is 16 bits wide, shifting by 31 or more gives the sign only
+    _shiftright = std::min<uint32_t>(shiftright & 0xFFFF, 31);
+}
+
+uint32_t fir_shift_model::get_shiftright_value() const
+{
+    return _shiftright;
+}
+
+void fir_shift_model::reset()
+{
+    std::fill(_buf_i.begin(), _buf_i.end(), 0);
+    std::fill(_buf_q.begin(), _buf_q.end(), 0);
+}
+
+uint32_t fir_shift_model::process(const uint32_t sample)
+{
+    uint32_t out;
+    process(&sample, &out, 1);
+    return out;
+}
+
+void fir_shift_model::process(const uint32_t* in, uint32_t* out, const size_t nsamps)
+{
+    const size_t num_hist = _buf_i.size();
+    _buf_i.resize(num_hist + nsamps);
+    _buf_q.resize(num_hist + nsamps);
+    for (size_t n = 0; n < nsamps; n++) {
+        _buf_i[num_hist + n] = static_cast<int16_t>(in[n] >> 16);
+        _buf_q[num_hist + n] = static_cast<int16_t>(in[n] & 0xFFFF);
+    }
+
+    for (size_t n = 0; n < nsamps; n++) {
+        // y[n] = sum_k c[k] * x[n-k], the newest sample is at num_hist + n
+        const int32_t* xi = &_buf_i[num_hist + n];
+        const int32_t* xq = &_buf_q[num_hist + n];
+        int64_t acc_i = 0, acc_q = 0;
+        for (size_t k = 0; k < _coeffs.size(); k++) {
+            acc_i += static_cast<int64_t>(_coeffs[k]) * xi[-static_cast<ptrdiff_t>(k)];
+            acc_q += static_cast<int64_t>(_coeffs[k]) * xq[-static_cast<ptrdiff_t>(k)];
+        }
+        const int32_t i = round_and_clip(acc_i) >> _shiftright;
+        const int32_t q = round_and_clip(acc_q) >> _shiftright;
+        out[n] = (static_cast<uint32_t>(static_cast<uint16_t>(i)) << 16)
+                 | static_cast<uint16_t>(q);
+    }
+
+    // Keep the last num_hist inputs for the next call
+    std::copy(_buf_i.end() - num_hist, _buf_i.end(), _buf_i.begin());
+    std::copy(_buf_q.end() - num_hist, _buf_q.end(), _buf_q.begin());
+    _buf_i.resize(num_hist);
+    _buf_q.resize(num_hist);
+}
+
+void fir_shift_model::_resize_history()
+{
+    // The history only grows, so the most recent inputs are still there when
+    // more taps are loaded later, like in the delay line of the FIR block.
+    const size_t num_hist = _coeffs.size() - 1;
+    if (_buf_i.size() < num_hist) {
+        _buf_i.insert(_buf_i.begin(), num_hist - _buf_i.size(), 0);
+        _buf_q.insert(_buf_q.begin(), num_hist - _buf_q.size(), 0);
+    }
+}
@@ -0,0 +1,228 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#include <rfnoc/openairlink/metrics.hpp>
+
+#include <uhd/exception.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <sstream>
+
+using namespace rfnoc::openairlink;
+
+namespace {
+
+void atomic_add(std::atomic<double>& value, const double delta)
+{
+    double old = value.load(std::memory_order_relaxed);
+    while (!value.compare_exchange_weak(old, old + delta, std::memory_order_relaxed)) {
+    }
+}
+
+std::string format_value(const double value)
+{
+    return (boost::format("%.9g") % value).str();
+}
+
+//! Name with the labels and an extra label pair, e.g. name{link="link0",le="0.1"}
+std::string series_name(
+    const std::string& name, const std::string& labels, const std::string& extra = "")
+{
+    if (labels.empty() && extra.empty()) {
+        return name;
+    }
+    return name + "{" + labels + ((labels.empty() || extra.empty()) ? "" : ",") + extra + "}";
+}
+
+} // namespace
+
+void metric_counter::inc(const uint64_t n)
+{
+    _value.fetch_add(n, std::memory_order_relaxed);
+}
+
+uint64_t metric_counter::get() const
+{
+    return _value.load(std::memory_order_relaxed);
+}
+
+void metric_gauge::set(const double value)
+{
+    _value.store(value, std::memory_order_relaxed);
+}
+
+void metric_gauge::add(const double delta)
+{
+    atomic_add(_value, delta);
+}
+
+double metric_gauge::get() const
+{
+    return _value.load(std::memory_order_relaxed);
+}
+
+metric_histogram::metric_histogram(const std::vector<double>& bounds)
+    : _bounds(bounds), _buckets(new std::atomic<uint64_t>[bounds.size() + 1])
+{
+    if (_bounds.empty() || !std::is_sorted(_bounds.begin(), _bounds.end())
+        || std::adjacent_find(_bounds.begin(), _bounds.end()) != _bounds.end()) {
+        throw uhd::value_error("Histogram bounds must be ascending");
+    }
+    for (size_t k = 0; k <= _bounds.size(); k++) {
+        _buckets[k].store(0, std::memory_order_relaxed);
+    }
+}
+
+void metric_histogram::observe(const double value)
+{
+    const size_t idx =
+        std::lower_bound(_bounds.begin(), _bounds.end(), value) - _bounds.begin();
+    _buckets[idx].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    atomic_add(_sum, value);
+}
+
+const std::vector<double>& metric_histogram::get_bounds() const
+{
+    return _bounds;
+}
+
+uint64_t metric_histogram::get_bucket(const size_t idx) const
+{
+    return _buckets[std::min(idx, _bounds.size())].load(std::memory_order_relaxed);
+}
+
+uint64_t metric_histogram::get_count() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+double metric_histogram::get_sum() const
+{
+    return _sum.load(std::memory_order_relaxed);
+}
+
+metric_counter& metrics_registry::add_counter(
+    const std::string& name, const std::string& help, const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    series_t& series = _get_series(name, help, "counter", labels);
+    if (!series.counter) {
+        series.counter.reset(new metric_counter());
+    }
+    return *series.counter;
+}
+
+metric_gauge& metrics_registry::add_gauge(
+    const std::string& name, const std::string& help, const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    series_t& series = _get_series(name, help, "gauge", labels);
+    if (!series.gauge) {
+        series.gauge.reset(new metric_gauge());
+    }
+    return *series.gauge;
+}
+
+metric_histogram& metrics_registry::add_histogram(const std::string& name,
+    const std::string& help,
+    const std::vector<double>& bounds,
+    const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    series_t& series = _get_series(name, help, "histogram", labels);
+    if (!series.histogram) {
+        series.histogram.reset(new metric_histogram(bounds));
+    }
+    return *series.histogram;
+}
+
+std::string metrics_registry::render() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::ostringstream out;
+    for (const family_t& family : _families) {
+        out << "# HELP " << family.name << " " << family.help << "\n";
+        out << "# TYPE " << family.name << " " << family.type << "\n";
+        for (const series_t& series : family.series) {
+            if (series.counter) {
+                out << series_name(family.name, series.labels) << " "
+                    << series.counter->get() << "\n";
+            } else if (series.gauge) {
+                out << series_name(family.name, series.labels) << " "
+                    << format_value(series.gauge->get()) << "\n";
+            } else if (series.histogram) {
+                // Prometheus buckets are cumulative
+                const metric_histogram& hist = *series.histogram;
+                uint64_t cumulative          = 0;
+                for (size_t k = 0; k < hist.get_bounds().size(); k++) {
+                    cumulative += hist.get_bucket(k);
+                    out << series_name(family.name + "_bucket",
+                               series.labels,
+                               "le=\"" + format_value(hist.get_bounds()[k]) + "\"")
+                        << " " << cumulative << "\n";
+                }
+                cumulative += hist.get_bucket(hist.get_bounds().size());
+                out << series_name(family.name + "_bucket", series.labels, "le=\"+Inf\"")
+                    << " " << cumulative << "\n";
+                out << series_name(family.name + "_sum", series.labels) << " "
+                    << format_value(hist.get_sum()) << "\n";
+                out << series_name(family.name + "_count", series.labels) << " "
+                    << hist.get_count() << "\n";
+            }
+        }
+    }
+    return out.str();
+}
+
+std::vector<double> metrics_registry::exponential_buckets(
+    const double start, const double factor, const size_t count)
+{
+    if (start <= 0.0 || factor <= 1.0 || count == 0) {
+        throw uhd::value_error("Exponential buckets need start > 0, factor > 1, count > 0");
+    }
+    std::vector<double> bounds(count);
+    bounds[0] = start;
+    for (size_t k = 1; k < count; k++) {
+        bounds[k] = bounds[k - 1] * factor;
+    }
+    return bounds;
+}
+
+metrics_registry::series_t& metrics_registry::_get_series(const std::string& name,
+    const std::string& help,
+    const std::string& type,
+    const std::string& labels)
+{
+    auto family = std::find_if(_families.begin(), _families.end(), [&name](const family_t& f) {
+        return f.name == name;
+    });
+    if (family == _families.end()) {
+        _families.push_back({name, help, type, {}});
+        family = _families.end() - 1;
+    } else if (family->type != type) {
+        throw uhd::value_error(
+            "Metric " + name + " is a " + family->type + ", not a " + type);
+    }
+    for (series_t& series : family->series) {
+        if (series.labels == labels) {
+            return series;
+        }
+    }
+    family->series.emplace_back();
+    family->series.back().labels = labels;
+    return family->series.back();
+}
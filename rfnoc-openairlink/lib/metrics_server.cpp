@@ -0,0 +1,196 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#include <rfnoc/openairlink/metrics_server.hpp>
+
+#include <uhd/exception.hpp>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace rfnoc::openairlink;
+
+namespace {
+
+//! Period to check for the end of the server thread
+const int POLL_MS = 100;
+//! Largest request read, the request itself is not parsed
+const size_t MAX_REQUEST = 4096;
+//! Longest a send to a client may block, e.g. for a client that doesn't read
+const int SEND_TIMEOUT_MS = 1000;
+
+std::string last_error()
+{
+    return std::strerror(errno);
+}
+
+void send_all(const int fd, const std::string& data)
+{
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        sent += n;
+    }
+}
+
+} // namespace
+
+metrics_server::metrics_server(const metrics_registry& registry, const uint16_t port)
+    : _registry(registry), _fd(-1), _running(false)
+{
+    _fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (_fd < 0) {
+        throw uhd::runtime_error("Cannot create the metrics socket: " + last_error());
+    }
+    const int reuse = 1;
+    ::setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        const std::string error = last_error();
+        ::close(_fd);
+        throw uhd::runtime_error(
+            "Cannot bind the metrics server to port " + std::to_string(port) + ": " + error);
+    }
+    _endpoint = "http://127.0.0.1:" + std::to_string(port) + "/metrics";
+    _start();
+}
+
+metrics_server::metrics_server(const metrics_registry& registry, const std::string& socket_path)
+    : _registry(registry), _socket_path(socket_path), _fd(-1), _running(false)
+{
+    sockaddr_un addr{};
+    if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) {
+        throw uhd::runtime_error("Invalid metrics socket path " + socket_path);
+    }
+    _fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_fd < 0) {
+        throw uhd::runtime_error("Cannot create the metrics socket: " + last_error());
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    // Only a stale socket is replaced, never another kind of file
+    struct stat st;
+    if (::lstat(socket_path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            ::close(_fd);
+            throw uhd::runtime_error(
+                "Cannot bind the metrics server to " + socket_path + ": not a socket");
+        }
+        ::unlink(socket_path.c_str());
+    }
+    if (::bind(_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        const std::string error = last_error();
+        ::close(_fd);
+        throw uhd::runtime_error(
+            "Cannot bind the metrics server to " + socket_path + ": " + error);
+    }
+    _endpoint = "unix:" + socket_path;
+    _start();
+}
+
+metrics_server::~metrics_server()
+{
+    _running = false;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    ::close(_fd);
+    if (!_socket_path.empty()) {
+        ::unlink(_socket_path.c_str());
+    }
+}
+
+std::string metrics_server::get_endpoint() const
+{
+    return _endpoint;
+}
+
+void metrics_server::_start()
+{
+    if (::listen(_fd, 4) < 0) {
+        const std::string error = last_error();
+        ::close(_fd);
+        throw uhd::runtime_error("Cannot listen on the metrics socket: " + error);
+    }
+    _running = true;
+    _thread  = std::thread(&metrics_server::_serve, this);
+}
+
+void metrics_server::_serve()
+{
+    while (_running) {
+        pollfd pfd{};
+        pfd.fd     = _fd;
+        pfd.events = POLLIN;
+        if (::poll(&pfd, 1, POLL_MS) <= 0) {
+            continue;
+        }
+        const int conn = ::accept(_fd, nullptr, nullptr);
+        if (conn < 0) {
+            continue;
+        }
+        // A stuck client must not block the thread, and with it the destructor
+        timeval timeout{};
+        timeout.tv_sec  = SEND_TIMEOUT_MS / 1000;
+        timeout.tv_usec = (SEND_TIMEOUT_MS % 1000) * 1000;
+        ::setsockopt(conn, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        _respond(conn);
+        ::close(conn);
+    }
+}
+
+void metrics_server::_respond(const int conn)
+{
+    // Read until the end of the request head, or give up after a poll period
+    std::string request;
+    char buf[512];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST) {
+        pollfd pfd{};
+        pfd.fd     = conn;
+        pfd.events = POLLIN;
+        if (::poll(&pfd, 1, POLL_MS) <= 0) {
+            return;
+        }
+        const ssize_t n = ::recv(conn, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return;
+        }
+        request.append(buf, n);
+    }
+
+    const std::string body = _registry.render();
+    send_all(conn,
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: "
+            + std::to_string(body.size())
+            + "\r\n"
+              "Connection: close\r\n\r\n"
+            + body);
+}
@@ -0,0 +1,135 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <rfnoc/openairlink/mimo_model.hpp>
+
+#include <uhd/exception.hpp>
+#include <algorithm>
+#include <sstream>
+
+using namespace rfnoc::openairlink;
+
+const size_t mimo_config::NUM_CHANS;
+
+namespace {
+
+uint16_t saturating_add16(const uint16_t a, const uint16_t b)
+{
+    const int32_t sum = static_cast<int16_t>(a) + static_cast<int16_t>(b);
+    return static_cast<uint16_t>(std::min(std::max(sum, -32768), 32767));
+}
+
+} // namespace
+
+mimo_config::mimo_config()
+{
+    // Identity matrix: each output only gets the input with the same index
+    for (size_t r = 0; r < NUM_CHANS; r++) {
+        for (size_t t = 0; t < NUM_CHANS; t++) {
+            coeffs[r][t]     = std::vector<int16_t>(1, (r == t) ? 32767 : 0);
+            shiftright[r][t] = 0;
+        }
+    }
+}
+
+mimo_config mimo_config::from_csv(const std::string& fields)
+{
+    mimo_config config;
+    std::istringstream iss(fields);
+    std::string taps, shift;
+
+    for (size_t r = 0; r < NUM_CHANS; r++) {
+        for (size_t t = 0; t < NUM_CHANS; t++) {
+            if (!std::getline(iss, taps, ',') || !std::getline(iss, shift, ',')) {
+                throw uhd::value_error("MIMO config needs taps and shift for all 4 paths");
+            }
+            std::istringstream tap_ss(taps);
+            int tap;
+            config.coeffs[r][t].clear();
+            while (tap_ss >> tap) {
+                config.coeffs[r][t].push_back(static_cast<int16_t>(tap));
+            }
+            config.shiftright[r][t] = static_cast<uint32_t>(std::stoi(shift));
+        }
+    }
+
+    return config;
+}
+
+bool mimo_config::operator==(const mimo_config& rhs) const
+{
+    for (size_t r = 0; r < NUM_CHANS; r++) {
+        for (size_t t = 0; t < NUM_CHANS; t++) {
+            if (coeffs[r][t] != rhs.coeffs[r][t] || shiftright[r][t] != rhs.shiftright[r][t]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool mimo_config::operator!=(const mimo_config& rhs) const
+{
+    return !(*this == rhs);
+}
+
+mimo_model::mimo_model(const mimo_config& config)
+    : _paths(mimo_config::NUM_CHANS * mimo_config::NUM_CHANS)
+{
+    set_config(config);
+}
+
+void mimo_model::set_config(const mimo_config& config)
+{
+    _config = config;
+    for (size_t r = 0; r < mimo_config::NUM_CHANS; r++) {
+        for (size_t t = 0; t < mimo_config::NUM_CHANS; t++) {
+            fir_shift_model& path = _paths[r * mimo_config::NUM_CHANS + t];
+            path.set_coefficients(config.coeffs[r][t]);
+            path.set_shiftright_value(config.shiftright[r][t]);
+        }
+    }
+}
+
+const mimo_config& mimo_model::get_config() const
+{
+    return _config;
+}
+
+void mimo_model::reset()
+{
+    for (auto& path : _paths) {
+        path.reset();
+    }
+}
+
+void mimo_model::process(const uint32_t* const in[mimo_config::NUM_CHANS],
+    uint32_t* const out[mimo_config::NUM_CHANS],
+    const size_t nsamps)
+{
+    _path_out.resize(nsamps);
+    for (size_t r = 0; r < mimo_config::NUM_CHANS; r++) {
+        std::fill(out[r], out[r] + nsamps, 0);
+        for (size_t t = 0; t < mimo_config::NUM_CHANS; t++) {
+            _paths[r * mimo_config::NUM_CHANS + t].process(in[t], _path_out.data(), nsamps);
+            // The sum block adds I and Q separately, each with saturation
+            for (size_t n = 0; n < nsamps; n++) {
+                const uint16_t i = saturating_add16(out[r][n] >> 16, _path_out[n] >> 16);
+                const uint16_t q = saturating_add16(out[r][n] & 0xFFFF, _path_out[n] & 0xFFFF);
+                out[r][n] = (static_cast<uint32_t>(i) << 16) | q;
+            }
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <rfnoc/openairlink/multirate_taps.hpp>
+
+#include <uhd/exception.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace rfnoc::openairlink;
+
+const size_t multirate_taps::LOWPASS_HALF_SPAN = 8;
+
+namespace {
+
+const double TAP_MAX       = 32767.0;
+const uint32_t SHIFT_MAX   = 31;
+// |y| <= full scale * sum |c| / 2^15 <= full scale, see tap_quantizer
+const double L1_BOUND      = 32768.0;
+
+} // namespace
+
+multirate_taps::multirate_taps(const size_t decim) : _decim(decim)
+{
+    if (decim == 0) {
+        throw uhd::value_error("Decimation must be at least 1");
+    }
+
+    // Blackman windowed sinc with cutoff at the decimated Nyquist frequency
+    const size_t half = LOWPASS_HALF_SPAN * decim;
+    _lowpass.resize(2 * half + 1);
+    double sum = 0.0;
+    for (size_t n = 0; n < _lowpass.size(); n++) {
+        const double x   = (static_cast<double>(n) - half) / decim;
+        const double w   = 0.42 - 0.5 * std::cos(M_PI * n / half)
+                         + 0.08 * std::cos(2.0 * M_PI * n / half);
+        const double sinc = (x == 0.0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+        _lowpass[n] = sinc * w;
+        sum += _lowpass[n];
+    }
+    // Unity DC gain
+    for (auto& tap : _lowpass) {
+        tap /= sum;
+    }
+}
+
+size_t multirate_taps::get_decim() const
+{
+    return _decim;
+}
+
+void multirate_taps::redesign(const std::vector<int16_t>& coeffs,
+    const uint32_t shiftright,
+    const size_t max_taps,
+    std::vector<int16_t>& out_coeffs,
+    uint32_t& out_shiftright) const
+{
+    const size_t half = LOWPASS_HALF_SPAN * _decim;
+    const size_t num_taps =
+        std::max<size_t>(1, std::min(max_taps, (coeffs.size() + _decim - 1) / _decim));
+
+    // g[k] = decim * (h * lowpass)[k * decim], the lowpass is centered, so
+    // the delays of the channel are kept
+    std::vector<double> taps(num_taps, 0.0);
+    double peak = 0.0, l1 = 0.0;
+    for (size_t k = 0; k < num_taps; k++) {
+        for (size_t n = 0; n < coeffs.size(); n++) {
+            const long idx = static_cast<long>(k * _decim + half) - static_cast<long>(n);
+            if (idx >= 0 && idx < static_cast<long>(_lowpass.size())) {
+                taps[k] += coeffs[n] * _lowpass[idx];
+            }
+        }
+        taps[k] *= _decim;
+        peak = std::max(peak, std::abs(taps[k]));
+        l1 += std::abs(taps[k]);
+    }
+
+    // Use the full tap range: the taps are scaled by 2^-s, so the shift
+    // is reduced by s to keep the gain. Neither the largest tap nor the sum
+    // of |taps| may exceed its bound, otherwise the FIR clips before the
+    // shift. s is limited to a shift in [0, 31].
+    int s = 0;
+    if (peak > 0.0) {
+        s = std::max(static_cast<int>(std::ceil(std::log2(peak / TAP_MAX))),
+            static_cast<int>(std::ceil(std::log2(l1 / L1_BOUND))));
+    }
+    s = std::max(s, static_cast<int>(shiftright) - static_cast<int>(SHIFT_MAX));
+    s = std::min(s, static_cast<int>(shiftright));
+
+    // Rounding can push the sum over the bound, then scale down one more step
+    out_coeffs.resize(num_taps);
+    while (true) {
+        double out_l1 = 0.0;
+        for (size_t k = 0; k < num_taps; k++) {
+            const double tap = std::round(std::ldexp(taps[k], -s));
+            out_coeffs[k] =
+                static_cast<int16_t>(std::min(std::max(tap, -TAP_MAX - 1.0), TAP_MAX));
+            out_l1 += std::abs(out_coeffs[k]);
+        }
+        if (out_l1 <= L1_BOUND || s >= static_cast<int>(shiftright)) {
+            break;
+        }
+        s++;
+    }
+    out_shiftright = static_cast<uint32_t>(static_cast<int>(shiftright) - s);
+}
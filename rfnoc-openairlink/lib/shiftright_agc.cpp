@@ -0,0 +1,144 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <rfnoc/openairlink/shiftright_agc.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace rfnoc::openairlink;
+
+const uint32_t shiftright_agc::MAX_SHIFT = 15;
+const int shiftright_agc::CLIP_STEP      = 2;
+
+namespace {
+
+const double FULL_SCALE      = 32767.0;
+const double FIR_HEADROOM_DB = 1.0; // Peak target of the FIR output below full scale
+const int NO_LIMIT      = 16;
+
+} // namespace
+
+shiftright_agc::shiftright_agc(const double headroom_db, const double hysteresis_db)
+    : _fir_hi(FULL_SCALE * std::pow(10.0, -FIR_HEADROOM_DB / 20.0))
+    , _fir_lo(_fir_hi / 2.0 * std::pow(10.0, -hysteresis_db / 20.0))
+    , _out_hi(FULL_SCALE * std::pow(10.0, -headroom_db / 20.0))
+    , _out_lo(_out_hi / 2.0 * std::pow(10.0, -hysteresis_db / 20.0))
+    , _channel_coeffs(1, 32767)
+    , _tap_exp(0)
+    , _shiftright(0)
+{
+    _scale_coefficients();
+}
+
+void shiftright_agc::set_coefficients(const std::vector<int16_t>& coeffs)
+{
+    _channel_coeffs = coeffs.empty() ? std::vector<int16_t>(1, 0) : coeffs;
+
+    // Taps that do not fit with the current scaling keep the gain with a
+    // smaller shift value where possible
+    const int tap_exp = std::min(_tap_exp, _max_tap_exp());
+    _shiftright       = std::max(0, _shiftright - (_tap_exp - tap_exp));
+    _tap_exp          = tap_exp;
+    _scale_coefficients();
+}
+
+const std::vector<int16_t>& shiftright_agc::get_coefficients() const
+{
+    return _coeffs;
+}
+
+void shiftright_agc::set_shiftright_value(const uint32_t shiftright)
+{
+    _shiftright = static_cast<int>(std::min(shiftright, MAX_SHIFT));
+}
+
+uint32_t shiftright_agc::get_shiftright_value() const
+{
+    return static_cast<uint32_t>(_shiftright);
+}
+
+bool shiftright_agc::update(const shiftright_stats& stats)
+{
+    if (stats.peak == 0) {
+        // No signal, nothing to adjust to
+        return false;
+    }
+    const bool clipped = stats.clip_count > 0;
+    const double peak  = static_cast<double>(stats.peak);
+
+    // FIR output: scale the taps, the shift value keeps the gain
+    int k = 0;
+    if (clipped) {
+        k = -CLIP_STEP;
+    } else if (peak > _fir_hi) {
+        k = -static_cast<int>(std::ceil(std::log2(peak / _fir_hi)));
+    } else if (peak < _fir_lo) {
+        k = static_cast<int>(std::floor(std::log2(_fir_hi / peak)));
+    }
+    k         = std::min(std::max(k, _min_tap_exp() - _tap_exp), _max_tap_exp() - _tap_exp);
+    int shift = _shiftright + k;
+
+    // Output: a clipped peak is only a lower bound, use full scale
+    const double fir_peak = std::ldexp(clipped ? FULL_SCALE : peak, k);
+    const double out_peak = std::ldexp(fir_peak, -shift);
+    if (out_peak > _out_hi) {
+        shift += static_cast<int>(std::ceil(std::log2(out_peak / _out_hi)));
+    } else if (out_peak < _out_lo) {
+        shift -= static_cast<int>(std::floor(std::log2(_out_hi / out_peak)));
+    }
+    shift = std::min(std::max(shift, 0), static_cast<int>(MAX_SHIFT));
+
+    const bool changed = (k != 0) || (shift != _shiftright);
+    _shiftright        = shift;
+    if (k != 0) {
+        _tap_exp += k;
+        _scale_coefficients();
+    }
+    return changed;
+}
+
+int shiftright_agc::_max_tap_exp() const
+{
+    // Largest e with all taps times 2^e in the int16 range
+    int max_exp = NO_LIMIT;
+    for (const int16_t tap : _channel_coeffs) {
+        if (tap > 0) {
+            max_exp = std::min(max_exp, static_cast<int>(std::floor(std::log2(32767.0 / tap))));
+        } else if (tap < 0) {
+            max_exp = std::min(max_exp, static_cast<int>(std::floor(std::log2(32768.0 / -tap))));
+        }
+    }
+    return max_exp;
+}
+
+int shiftright_agc::_min_tap_exp() const
+{
+    // Smallest e that keeps the largest tap nonzero
+    int peak = 0;
+    for (const int16_t tap : _channel_coeffs) {
+        peak = std::max(peak, std::abs(static_cast<int>(tap)));
+    }
+    return (peak == 0) ? -NO_LIMIT : -static_cast<int>(std::floor(std::log2(peak)));
+}
+
+void shiftright_agc::_scale_coefficients()
+{
+    _coeffs.resize(_channel_coeffs.size());
+    for (size_t n = 0; n < _channel_coeffs.size(); n++) {
+        const double tap = std::round(std::ldexp(static_cast<double>(_channel_coeffs[n]), _tap_exp));
+        _coeffs[n]       = static_cast<int16_t>(std::min(std::max(tap, -32768.0), 32767.0));
+    }
+}
@@ -15,30 +15,266 @@
 
 #include <rfnoc/openairlink/shiftright_block_control.hpp>
 
+#include <uhd/exception.hpp>
+#include <uhd/rfnoc/actions.hpp>
 #include <uhd/rfnoc/defaults.hpp>
 #include <uhd/rfnoc/registry.hpp>
+#include <uhd/utils/log.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
 
 using namespace rfnoc::openairlink;
 using namespace uhd::rfnoc;
 
 const uint32_t shiftright_block_control::REG_SHIFTRIGHT_VALUE = 0x00;
+const uint32_t shiftright_block_control::REG_STATS_WINDOW     = 0x04;
+const uint32_t shiftright_block_control::REG_STATS_COUNT      = 0x08;
+const uint32_t shiftright_block_control::REG_STATS_POWER      = 0x0C;
+const uint32_t shiftright_block_control::REG_STATS_PEAK       = 0x10;
+const uint32_t shiftright_block_control::REG_STATS_CLIP       = 0x14;
+const uint32_t shiftright_block_control::REG_TAG_CTRL         = 0x18;
+const uint32_t shiftright_block_control::REG_TAG_ID           = 0x1C;
+const uint16_t shiftright_block_control::TAG_MARKER           = 0x0A1C;
+const size_t shiftright_block_control::MAX_RX_EVENTS          = 1000;
+const uint32_t shiftright_block_control::MAX_STATS_WINDOW     = 24;
+const size_t shiftright_block_control::MAX_STATS_READS        = 4;
+
+bool shiftright_block_control::parse_channel_tag(
+    const uint64_t* mdata, const size_t num_mdata, shiftright_tag& tag)
+{
+    // The block appends the tag, so search from the end
+    for (size_t k = num_mdata; k > 0; k--) {
+        const uint64_t word = mdata[k - 1];
+        if ((word >> 48) == TAG_MARKER) {
+            tag.step_id    = static_cast<uint32_t>(word & 0xFFFFFFFF);
+            tag.shiftright = static_cast<uint32_t>((word >> 32) & 0xFFFF);
+            return true;
+        }
+    }
+    return false;
+}
 
 class shiftright_block_control_impl : public shiftright_block_control
 {
 public:
-    RFNOC_BLOCK_CONSTRUCTOR(shiftright_block_control) {}
+    RFNOC_BLOCK_CONSTRUCTOR(shiftright_block_control)
+    {
+        register_action_handler(ACTION_KEY_RX_EVENT,
+            [this](const res_source_info& src, action_info::sptr action) {
+                _handle_rx_event(src, action);
+            });
+    }
 
     void set_shiftright_value(const uint32_t shiftright)
     {
-        regs().poke32(REG_SHIFTRIGHT_VALUE, shiftright);
+        write_registers({REG_SHIFTRIGHT_VALUE}, {shiftright});
     }
 
     uint32_t get_shiftright_value()
     {
-        return regs().peek32(REG_SHIFTRIGHT_VALUE);
+        return _read(REG_SHIFTRIGHT_VALUE);
+    }
+
+    void set_stats_window(const uint32_t log2_len)
+    {
+        write_registers({REG_STATS_WINDOW}, {log2_len});
+    }
+
+    uint32_t get_stats_window()
+    {
+        return _read(REG_STATS_WINDOW);
+    }
+
+    shiftright_stats get_stats()
+    {
+        // Read again if a window completed during the reads, so all values
+        // belong to the same window. Windows shorter than the reads never
+        // hold still, so give up after MAX_STATS_READS and return the last set.
+        shiftright_stats stats;
+        uint32_t count   = regs().peek32(REG_STATS_COUNT);
+        size_t num_peeks = 1;
+        for (size_t i = 0; i < MAX_STATS_READS; i++) {
+            stats.count      = count;
+            stats.power      = regs().peek32(REG_STATS_POWER);
+            stats.peak       = regs().peek32(REG_STATS_PEAK);
+            stats.clip_count = regs().peek32(REG_STATS_CLIP);
+            count            = regs().peek32(REG_STATS_COUNT);
+            num_peeks += 4;
+            if (count == stats.count) {
+                break;
+            }
+        }
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        _ctrl_stats.peeks += num_peeks;
+        if (count != stats.count) {
+            _ctrl_stats.mixed_stats++;
+        }
+        return stats;
+    }
+
+    void set_tagging_enabled(const bool enable)
+    {
+        write_registers({REG_TAG_CTRL}, {enable ? 1u : 0u});
+    }
+
+    bool get_tagging_enabled()
+    {
+        return (_read(REG_TAG_CTRL) & 0x1) != 0;
+    }
+
+    void set_channel_tag(const uint32_t step_id)
+    {
+        write_registers({REG_TAG_ID}, {step_id});
+    }
+
+    uint32_t get_channel_tag()
+    {
+        return _read(REG_TAG_ID);
+    }
+
+    void write_registers(const std::vector<uint32_t>& addrs, const std::vector<uint32_t>& values)
+    {
+        if (addrs.size() != values.size()) {
+            throw uhd::value_error("Number of register addresses and values differ");
+        }
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        std::vector<uint32_t> burst_addrs, burst_values, burst_readbacks;
+        for (size_t i = 0; i < addrs.size(); i++) {
+            const uint32_t readback = _readback_value(addrs[i], values[i]);
+            const auto cached       = _cache.find(addrs[i]);
+            if (addrs[i] != REG_STATS_WINDOW && cached != _cache.end()
+                && cached->second == readback) {
+                _ctrl_stats.skipped_pokes++;
+                continue;
+            }
+            burst_addrs.push_back(addrs[i]);
+            burst_values.push_back(values[i]);
+            burst_readbacks.push_back(readback);
+        }
+        if (burst_addrs.empty()) {
+            return;
+        }
+        if (burst_addrs.size() == 1) {
+            regs().poke32(burst_addrs[0], burst_values[0]);
+        } else {
+            regs().multi_poke32(burst_addrs, burst_values);
+            _ctrl_stats.bursts++;
+        }
+        _ctrl_stats.pokes += burst_addrs.size();
+        // Only cache what reached the device, a failed write throws above and
+        // leaves the cache as it was
+        for (size_t i = 0; i < burst_addrs.size(); i++) {
+            if (_is_cached(burst_addrs[i])) {
+                _cache[burst_addrs[i]] = burst_readbacks[i];
+            }
+        }
+    }
+
+    void set_verify_readback(const bool verify)
+    {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        _verify = verify;
+    }
+
+    void clear_register_cache()
+    {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        _cache.clear();
+    }
+
+    shiftright_ctrl_stats get_ctrl_stats()
+    {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        return _ctrl_stats;
+    }
+
+    bool get_rx_event(shiftright_rx_event& event, const double timeout)
+    {
+        std::unique_lock<std::mutex> lock(_event_mutex);
+        if (!_event_cond.wait_for(lock,
+                std::chrono::duration<double>(timeout),
+                [this] { return !_rx_events.empty(); })) {
+            return false;
+        }
+        event = _rx_events.front();
+        _rx_events.pop_front();
+        return true;
     }
 
 private:
+    void _handle_rx_event(const res_source_info& src, action_info::sptr action)
+    {
+        if (src.type != res_source_info::INPUT_EDGE) {
+            return;
+        }
+        auto rx_event = std::dynamic_pointer_cast<rx_event_action_info>(action);
+        if (rx_event) {
+            shiftright_rx_event event;
+            event.error_code = rx_event->error_code;
+            event.time       = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(_event_mutex);
+            if (_rx_events.size() == MAX_RX_EVENTS) {
+                _rx_events.pop_front();
+            }
+            _rx_events.push_back(event);
+            _event_cond.notify_one();
+        }
+        // Pass it on like the default forwarding would
+        post_action({res_source_info::OUTPUT_EDGE, src.instance}, action);
+    }
+
+    static bool _is_cached(const uint32_t addr)
+    {
+        return addr == REG_SHIFTRIGHT_VALUE || addr == REG_STATS_WINDOW
+               || addr == REG_TAG_CTRL || addr == REG_TAG_ID;
+    }
+
+    //! The value a register reads back after a write, see shiftright_core.v
+    static uint32_t _readback_value(const uint32_t addr, const uint32_t value)
+    {
+        if (addr == REG_SHIFTRIGHT_VALUE) {
+            return value & 0xFFFF;
+        }
+        if (addr == REG_STATS_WINDOW) {
+            return std::min<uint32_t>(value, MAX_STATS_WINDOW);
+        }
+        if (addr == REG_TAG_CTRL) {
+            return value & 0x1;
+        }
+        return value;
+    }
+
+    uint32_t _read(const uint32_t addr)
+    {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        const auto cached = _cache.find(addr);
+        if (cached != _cache.end() && !_verify) {
+            _ctrl_stats.cached_reads++;
+            return cached->second;
+        }
+        const uint32_t value = regs().peek32(addr);
+        _ctrl_stats.peeks++;
+        if (cached != _cache.end() && cached->second != value) {
+            UHD_LOG_WARNING(get_unique_id(),
+                boost::format("Register 0x%02x reads 0x%08x, expected 0x%08x") % addr % value
+                    % cached->second);
+        }
+        _cache[addr] = value;
+        return value;
+    }
+
+    std::mutex _cache_mutex;
+    std::map<uint32_t, uint32_t> _cache;
+    bool _verify = false;
+    shiftright_ctrl_stats _ctrl_stats;
+
+    std::mutex _event_mutex;
+    std::condition_variable _event_cond;
+    std::deque<shiftright_rx_event> _rx_events;
 };
 
 UHD_RFNOC_BLOCK_REGISTER_DIRECT(
@@ -0,0 +1,320 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#include <rfnoc/openairlink/stream_health.hpp>
+
+#include <uhd/exception.hpp>
+#include <uhd/utils/log.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+using namespace rfnoc::openairlink;
+
+namespace {
+
+const char* LOG_ID = "STREAM_HEALTH";
+
+} // namespace
+
+stream_health_monitor::stream_health_monitor() : _running(false)
+{
+    _limits.fill(std::numeric_limits<uint64_t>::max());
+}
+
+stream_health_monitor::~stream_health_monitor()
+{
+    stop();
+}
+
+void stream_health_monitor::add_link(const std::string& name,
+    shiftright_block_control::sptr sr,
+    uhd::rfnoc::radio_control::sptr tx_radio,
+    const size_t tx_chan)
+{
+    if (_running) {
+        throw uhd::runtime_error("Cannot add a link to a running stream health monitor");
+    }
+    link_t link;
+    link.name     = name;
+    link.sr       = sr;
+    link.tx_radio = tx_radio;
+    link.tx_chan  = tx_chan;
+    link.metrics.fill(nullptr);
+    _links.push_back(link);
+}
+
+void stream_health_monitor::set_limit(const stream_event_t event, const uint64_t max_count)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _limits.at(event) = max_count;
+}
+
+void stream_health_monitor::set_trip_callback(trip_callback_t callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _trip_callback = callback;
+}
+
+void stream_health_monitor::set_metrics(metrics_registry& registry)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& link : _links) {
+        for (size_t k = 0; k < NUM_STREAM_EVENTS; k++) {
+            std::string type = event_name(static_cast<stream_event_t>(k));
+            std::replace(type.begin(), type.end(), ' ', '_');
+            link.metrics[k] = &registry.add_counter("oal_stream_errors_total",
+                "Radio errors of the link by type",
+                (boost::format("link=\"%s\",type=\"%s\"") % link.name % type).str());
+        }
+    }
+}
+
+void stream_health_monitor::start()
+{
+    if (_running) {
+        return;
+    }
+    _start   = std::chrono::steady_clock::now();
+    _running = true;
+    std::vector<uhd::rfnoc::radio_control::sptr> tx_radios;
+    for (size_t i = 0; i < _links.size(); i++) {
+        if (_links[i].sr) {
+            _threads.emplace_back(&stream_health_monitor::_rx_loop, this, i);
+        }
+        // One thread per radio, it gets the messages of all its channels
+        const auto& radio = _links[i].tx_radio;
+        if (radio && std::find(tx_radios.begin(), tx_radios.end(), radio) == tx_radios.end()) {
+            tx_radios.push_back(radio);
+            _threads.emplace_back(&stream_health_monitor::_tx_loop, this, radio);
+        }
+    }
+}
+
+void stream_health_monitor::stop()
+{
+    _running = false;
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+    _threads.clear();
+}
+
+stream_health stream_health_monitor::get_health(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& link : _links) {
+        if (link.name == name) {
+            return link.health;
+        }
+    }
+    throw uhd::key_error("No stream health of link " + name);
+}
+
+stream_health stream_health_monitor::get_total_health() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    stream_health total;
+    for (const auto& link : _links) {
+        for (size_t k = 0; k < NUM_STREAM_EVENTS; k++) {
+            const stream_event_stats& stats = link.health[k];
+            if (stats.count == 0) {
+                continue;
+            }
+            stream_event_stats& sum = total[k];
+            sum.first_s = (sum.count == 0) ? stats.first_s : std::min(sum.first_s, stats.first_s);
+            if (sum.count == 0 || stats.last_s >= sum.last_s) {
+                sum.last_s          = stats.last_s;
+                sum.has_device_time = stats.has_device_time;
+                sum.device_time     = stats.device_time;
+            }
+            sum.count += stats.count;
+        }
+    }
+    return total;
+}
+
+bool stream_health_monitor::tripped() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return !_trip_reason.empty();
+}
+
+std::string stream_health_monitor::get_trip_reason() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _trip_reason;
+}
+
+std::string stream_health_monitor::get_summary() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::ostringstream out;
+    bool any = false;
+    for (const auto& link : _links) {
+        for (size_t k = 0; k < NUM_STREAM_EVENTS; k++) {
+            const stream_event_stats& stats = link.health[k];
+            if (stats.count == 0) {
+                continue;
+            }
+            any = true;
+            out << boost::format("%-8s %-13s %8d  first %.3fs  last %.3fs") % link.name
+                       % event_name(static_cast<stream_event_t>(k)) % stats.count
+                       % stats.first_s % stats.last_s;
+            if (stats.has_device_time) {
+                out << boost::format("  device %.6fs") % stats.device_time.get_real_secs();
+            }
+            out << std::endl;
+        }
+    }
+    if (!any) {
+        out << "No stream errors" << std::endl;
+    }
+    if (!_trip_reason.empty()) {
+        out << "Limit exceeded: " << _trip_reason << std::endl;
+    }
+    return out.str();
+}
+
+std::string stream_health_monitor::event_name(const stream_event_t event)
+{
+    switch (event) {
+        case STREAM_EVENT_OVERFLOW:
+            return "overflow";
+        case STREAM_EVENT_UNDERFLOW:
+            return "underflow";
+        case STREAM_EVENT_LATE_COMMAND:
+            return "late command";
+        case STREAM_EVENT_SEQ_ERROR:
+            return "seq error";
+        default:
+            return "other";
+    }
+}
+
+void stream_health_monitor::_rx_loop(const size_t link_idx)
+{
+    const shiftright_block_control::sptr sr = _links[link_idx].sr;
+    shiftright_rx_event event;
+    while (_running) {
+        if (!sr->get_rx_event(event, 0.1)) {
+            continue;
+        }
+        switch (event.error_code) {
+            case uhd::rx_metadata_t::ERROR_CODE_NONE:
+            case uhd::rx_metadata_t::ERROR_CODE_TIMEOUT:
+                break;
+            case uhd::rx_metadata_t::ERROR_CODE_OVERFLOW:
+                _count(link_idx, STREAM_EVENT_OVERFLOW, event.time, false, {});
+                break;
+            case uhd::rx_metadata_t::ERROR_CODE_LATE_COMMAND:
+                _count(link_idx, STREAM_EVENT_LATE_COMMAND, event.time, false, {});
+                break;
+            default:
+                _count(link_idx, STREAM_EVENT_OTHER, event.time, false, {});
+                break;
+        }
+    }
+}
+
+void stream_health_monitor::_tx_loop(const uhd::rfnoc::radio_control::sptr radio)
+{
+    uhd::async_metadata_t md;
+    while (_running) {
+        if (!radio->get_async_metadata(md, 0.1)) {
+            continue;
+        }
+        const auto time = std::chrono::steady_clock::now();
+        // The link on this channel, else the first link on this radio
+        size_t link_idx = _links.size();
+        for (size_t i = 0; i < _links.size(); i++) {
+            if (_links[i].tx_radio != radio) {
+                continue;
+            }
+            if (link_idx == _links.size() || _links[i].tx_chan == md.channel) {
+                link_idx = i;
+            }
+        }
+        switch (md.event_code) {
+            case uhd::async_metadata_t::EVENT_CODE_BURST_ACK:
+            case uhd::async_metadata_t::EVENT_CODE_USER_PAYLOAD:
+                break;
+            case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
+            case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET:
+                _count(link_idx, STREAM_EVENT_UNDERFLOW, time, md.has_time_spec, md.time_spec);
+                break;
+            case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR:
+            case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST:
+                _count(link_idx, STREAM_EVENT_SEQ_ERROR, time, md.has_time_spec, md.time_spec);
+                break;
+            case uhd::async_metadata_t::EVENT_CODE_TIME_ERROR:
+                _count(
+                    link_idx, STREAM_EVENT_LATE_COMMAND, time, md.has_time_spec, md.time_spec);
+                break;
+            default:
+                _count(link_idx, STREAM_EVENT_OTHER, time, md.has_time_spec, md.time_spec);
+                break;
+        }
+    }
+}
+
+void stream_health_monitor::_count(const size_t link_idx,
+    const stream_event_t event,
+    const std::chrono::steady_clock::time_point time,
+    const bool has_device_time,
+    const uhd::time_spec_t& device_time)
+{
+    trip_callback_t callback;
+    std::string reason;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        link_t& link              = _links[link_idx];
+        stream_event_stats& stats = link.health[event];
+        const double time_s = std::chrono::duration<double>(time - _start).count();
+        if (stats.count == 0) {
+            stats.first_s = time_s;
+            UHD_LOG_WARNING(LOG_ID,
+                boost::format("First %s on %s at %.3fs") % event_name(event) % link.name
+                    % time_s);
+        }
+        stats.count++;
+        stats.last_s = time_s;
+        if (link.metrics[event]) {
+            link.metrics[event]->inc();
+        }
+        if (has_device_time) {
+            stats.has_device_time = true;
+            stats.device_time     = device_time;
+        }
+
+        uint64_t total = 0;
+        for (const auto& l : _links) {
+            total += l.health[event].count;
+        }
+        if (_trip_reason.empty() && total > _limits[event]) {
+            _trip_reason = (boost::format("%d %s events, limit %d") % total
+                            % event_name(event) % _limits[event])
+                               .str();
+            UHD_LOG_ERROR(LOG_ID, "Stream health limit exceeded: " << _trip_reason);
+            callback = _trip_callback;
+            reason   = _trip_reason;
+        }
+    }
+    if (callback) {
+        callback(reason);
+    }
+}
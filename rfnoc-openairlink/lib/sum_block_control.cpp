@@ -0,0 +1,51 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <rfnoc/openairlink/sum_block_control.hpp>
+
+#include <uhd/rfnoc/defaults.hpp>
+#include <uhd/rfnoc/registry.hpp>
+
+using namespace rfnoc::openairlink;
+using namespace uhd::rfnoc;
+
+const uint32_t sum_block_control::REG_SAT_COUNT = 0x00;
+
+class sum_block_control_impl : public sum_block_control
+{
+public:
+    RFNOC_BLOCK_CONSTRUCTOR(sum_block_control)
+    {
+        // Two inputs and one output: properties (rate, type, ...) and actions
+        // (stream commands, events) must reach all ports on the other side.
+        set_prop_forwarding_policy(forwarding_policy_t::ONE_TO_FAN);
+        set_action_forwarding_policy(forwarding_policy_t::ONE_TO_FAN);
+    }
+
+    uint32_t get_saturation_count()
+    {
+        return regs().peek32(REG_SAT_COUNT);
+    }
+
+    void clear_saturation_count()
+    {
+        regs().poke32(REG_SAT_COUNT, 0);
+    }
+
+private:
+};
+
+UHD_RFNOC_BLOCK_REGISTER_DIRECT(
+    sum_block_control, 0x02d026, "Sum", CLOCK_KEY_GRAPH, "bus_clk")
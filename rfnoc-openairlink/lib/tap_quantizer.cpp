@@ -0,0 +1,161 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <rfnoc/openairlink/tap_quantizer.hpp>
+
+#include <uhd/exception.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace rfnoc::openairlink;
+
+const uint32_t tap_quantizer::MAX_SHIFT = 15;
+
+namespace {
+
+const double TAP_MAX   = 32767.0;
+const double TAP_MIN   = -32768.0;
+const double FIR_SCALE = 32768.0; // Taps are Q1.15
+
+double to_db(const double num, const double den)
+{
+    if (den <= 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * std::log10(num / den);
+}
+
+} // namespace
+
+tap_quantizer::tap_quantizer(const size_t num_taps, const double input_peak_dbfs)
+    : _num_taps(num_taps)
+{
+    if (num_taps == 0) {
+        throw uhd::value_error("Need at least one tap");
+    }
+    // |y| <= peak * sum |c| / 2^15 <= full scale
+    const double input_peak = TAP_MAX * std::pow(10.0, input_peak_dbfs / 20.0);
+    _l1_bound               = TAP_MAX * FIR_SCALE / input_peak;
+}
+
+size_t tap_quantizer::get_num_taps() const
+{
+    return _num_taps;
+}
+
+void tap_quantizer::quantize(const double* taps_re,
+    const double* taps_im,
+    const double* gains_db,
+    const size_t num_steps,
+    int16_t* coeffs,
+    uint32_t* shifts,
+    double* sqnr_db,
+    double* gain_loss_db,
+    double* real_loss_db) const
+{
+    const size_t n_taps = _num_taps;
+    std::vector<double> desired(n_taps);
+
+    for (size_t step = 0; step < num_steps; step++) {
+        const double* re = taps_re + step * n_taps;
+        const double* im = taps_im ? taps_im + step * n_taps : nullptr;
+        const double gain = gains_db ? std::pow(10.0, gains_db[step] / 20.0) : 1.0;
+        int16_t* c        = coeffs + step * n_taps;
+
+        // Common phase that maximizes the real energy: half the angle of
+        // sum h[n]^2, then desired = gain * Re(h * exp(-j phase))
+        double energy = 0.0;
+        if (im) {
+            double s_re = 0.0, s_im = 0.0;
+            for (size_t n = 0; n < n_taps; n++) {
+                s_re += re[n] * re[n] - im[n] * im[n];
+                s_im += 2.0 * re[n] * im[n];
+                energy += re[n] * re[n] + im[n] * im[n];
+            }
+            const double phase = 0.5 * std::atan2(s_im, s_re);
+            const double cos_p = std::cos(phase), sin_p = std::sin(phase);
+            for (size_t n = 0; n < n_taps; n++) {
+                desired[n] = gain * (re[n] * cos_p + im[n] * sin_p);
+            }
+        } else {
+            for (size_t n = 0; n < n_taps; n++) {
+                desired[n] = gain * re[n];
+                energy += re[n] * re[n];
+            }
+        }
+        energy *= gain * gain;
+
+        double peak = 0.0, l1 = 0.0, real_energy = 0.0;
+        for (size_t n = 0; n < n_taps; n++) {
+            peak = std::max(peak, std::abs(desired[n]));
+            l1 += std::abs(desired[n]);
+            real_energy += desired[n] * desired[n];
+        }
+
+        // Largest shift within both bounds, taps scale by 2^(15 + shift). If
+        // even shift 0 exceeds a bound, the gain is reduced until it fits.
+        int shift          = static_cast<int>(MAX_SHIFT);
+        double gain_factor = 1.0;
+        if (peak > 0.0) {
+            const double limit = std::min(
+                TAP_MAX / (peak * FIR_SCALE), _l1_bound / (l1 * FIR_SCALE));
+            shift = static_cast<int>(std::floor(std::log2(limit)));
+            shift = std::min(shift, static_cast<int>(MAX_SHIFT));
+            if (shift < 0) {
+                shift       = 0;
+                gain_factor = limit;
+            }
+        }
+
+        // Rounding may still cross the L1 bound, then use the next smaller
+        // shift, or a slightly smaller gain at shift 0
+        double err = 0.0;
+        for (;;) {
+            const double scale = std::ldexp(FIR_SCALE, shift);
+            double c_l1        = 0.0;
+            err                = 0.0;
+            for (size_t n = 0; n < n_taps; n++) {
+                const double target = gain_factor * desired[n];
+                const double q = std::min(std::max(std::round(target * scale), TAP_MIN), TAP_MAX);
+                c[n]           = static_cast<int16_t>(q);
+                c_l1 += std::abs(q);
+                const double e = q / scale - target;
+                err += e * e;
+            }
+            if (c_l1 <= _l1_bound) {
+                break;
+            } else if (shift > 0) {
+                shift--;
+            } else {
+                gain_factor *= (_l1_bound - 0.5) / c_l1;
+            }
+        }
+        real_energy *= gain_factor * gain_factor;
+        energy *= gain_factor * gain_factor;
+
+        shifts[step] = static_cast<uint32_t>(shift);
+        if (sqnr_db) {
+            sqnr_db[step] = to_db(real_energy, err);
+        }
+        if (gain_loss_db) {
+            gain_loss_db[step] = (gain_factor < 1.0) ? -20.0 * std::log10(gain_factor) : 0.0;
+        }
+        if (real_loss_db) {
+            real_loss_db[step] = to_db(energy, energy - real_energy);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+/**
+    This file is part of OpenAirLink.
+
+    OpenAirLink is free software: you can redistribute it and/or modify it under the terms of
+    the GNU General Public License as published by the Free Software Foundation, either
+    version 3 of the License, or (at your option) any later version.
+
+    OpenAirLink is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with OpenAirLink.
+    If not, see <https://www.gnu.org/licenses/>.
+**/
+
+// Checks that multirate_taps keeps the gain of a FIR -> Shiftright setting:
+// the full rate taps and the redesigned taps are run through fir_shift_model,
+// at the radio rate and at the decimated rate, and the DC and passband gains
+// of the outputs are compared.
+
+#include <rfnoc/openairlink/fir_shift_model.hpp>
+#include <rfnoc/openairlink/multirate_taps.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using rfnoc::openairlink::fir_shift_model;
+using rfnoc::openairlink::multirate_taps;
+
+namespace {
+
+const double AMPLITUDE    = 32767.0; // Full scale, so clipping of the FIR shows
+const size_t NUM_SAMPS    = 4096;
+const double MAX_DC_ERROR = 0.02; // Relative
+const double MAX_DB_ERROR = 0.3;
+
+struct test_case
+{
+    std::vector<int16_t> coeffs;
+    uint32_t shiftright;
+};
+
+uint32_t pack(const double i, const double q)
+{
+    const uint16_t i16 = static_cast<uint16_t>(static_cast<int16_t>(std::lround(i)));
+    const uint16_t q16 = static_cast<uint16_t>(static_cast<int16_t>(std::lround(q)));
+    return (static_cast<uint32_t>(i16) << 16) | q16;
+}
+
+/*! Run a complex tone (freq in cycles per radio sample, 0 for DC) through the
+ * model at the radio rate / decim. Returns the mean I of the settled output
+ * and its mean power.
+ */
+void run_tone(const std::vector<int16_t>& coeffs, const uint32_t shiftright,
+    const size_t decim, const double freq, double& mean_i, double& power)
+{
+    fir_shift_model model(coeffs, shiftright);
+    const size_t settle = 2 * coeffs.size();
+    double sum_i = 0.0, sum_p = 0.0;
+    for (size_t n = 0; n < NUM_SAMPS + settle; n++) {
+        const double phase = 2.0 * M_PI * freq * n * decim;
+        const double in_i  = (freq == 0.0) ? AMPLITUDE : AMPLITUDE * std::cos(phase);
+        const double in_q  = (freq == 0.0) ? -AMPLITUDE / 2 : AMPLITUDE * std::sin(phase);
+        const uint32_t out = model.process(pack(in_i, in_q));
+        if (n >= settle) {
+            const double i = static_cast<int16_t>(out >> 16);
+            const double q = static_cast<int16_t>(out & 0xFFFF);
+            sum_i += i;
+            sum_p += i * i + q * q;
+        }
+    }
+    mean_i = sum_i / NUM_SAMPS;
+    power  = sum_p / NUM_SAMPS;
+}
+
+} // namespace
+
+int main()
+{
+    // The delays are multiples of 4, so they are on the grid of every tested
+    // decimation. Delays between the decimated samples are spread by the
+    // lowpass and cut to the redesigned tap count, their gain is not exact.
+    // The sum of |taps| of each case is below 2^15, so the full rate FIR
+    // does not clip a full scale input either.
+    const std::vector<test_case> cases = {
+        // Half scale tap, the redesign scales the taps up
+        {{16384, 0, 0, 0}, 4},
+        // Multipath channel
+        {{18000, 0, 0, 0, 8000, 0, 0, 0, -4000, 0, 0, 0, 2000}, 2},
+        // Full scale tap
+        {{32767, 0, 0, 0, 0, 0, 0, 0}, 6},
+        // Small taps without a shift
+        {{400, 0, 0, 0, 300, 0, 0, 0}, 0},
+    };
+
+    size_t num_failed = 0;
+    for (const size_t decim : {1, 2, 4}) {
+        const multirate_taps redesigner(decim);
+        for (const test_case& tc : cases) {
+            std::vector<int16_t> coeffs;
+            uint32_t shiftright;
+            redesigner.redesign(tc.coeffs, tc.shiftright, 1024, coeffs, shiftright);
+
+            // DC gain
+            double full_i, full_p, red_i, red_p;
+            run_tone(tc.coeffs, tc.shiftright, 1, 0.0, full_i, full_p);
+            run_tone(coeffs, shiftright, decim, 0.0, red_i, red_p);
+            const bool dc_ok = std::abs(red_i - full_i) <= MAX_DC_ERROR * std::abs(full_i) + 2.0;
+
+            // Passband gain, a tone at a tenth of the decimated rate
+            const double freq = 0.1 / decim;
+            run_tone(tc.coeffs, tc.shiftright, 1, freq, full_i, full_p);
+            run_tone(coeffs, shiftright, decim, freq, red_i, red_p);
+            const double db_error = 10.0 * std::log10(red_p / full_p);
+            const bool tone_ok    = std::abs(db_error) <= MAX_DB_ERROR;
+
+            std::printf("M=%zu taps=%zu shift %u -> taps=%zu shift %u: DC %s, tone %+.3f dB %s\n",
+                decim, tc.coeffs.size(), tc.shiftright, coeffs.size(), shiftright,
+                dc_ok ? "ok" : "FAILED", db_error, tone_ok ? "ok" : "FAILED");
+            num_failed += (dc_ok && tone_ok) ? 0 : 1;
+        }
+    }
+
+    if (num_failed) {
+        std::printf("FAILED %zu cases\n", num_failed);
+        return EXIT_FAILURE;
+    }
+    std::printf("PASSED\n");
+    return EXIT_SUCCESS;
+}